@@ -39,7 +39,7 @@ execute_process(
         "${BLOCKS_JSON}" "${BLOCK_PROPERTIES_JSON}" "${BLOCK_OUT_CC}"
     COMMAND_ERROR_IS_FATAL ANY
 )
-target_sources(mccpp
+target_sources(mccpp_core
     PRIVATE
         "${BLOCK_OUT_CC}"
 )
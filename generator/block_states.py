@@ -2,9 +2,10 @@
 
 import sys
 import json
-from typing import Dict, List, Union
+from typing import Dict, List, Tuple, Union
 from io import TextIOBase
 import os
+import re
 
 class Property:
     id: int
@@ -18,6 +19,11 @@ class BlockState:
     id: int
     air: bool
     renderShape: str
+    # index into the deduplicated shapes, 0 is empty and 1 a full cube
+    collisionShape: int
+    lightEmission: int
+    # levels light loses going through it, 15 blocks it
+    opacity: int
 
 class Block:
     name: str
@@ -63,7 +69,17 @@ def parse_props(data) -> Dict[str, Property]:
     assert(total_enum_values < 256)
     return props
 
-def parse_blocks(data, props: Dict[str, Property]) -> List[Block]:
+EMPTY_SHAPE = ()
+FULL_SHAPE = ((0.0, 0.0, 0.0, 1.0, 1.0, 1.0),)
+NUMBER = re.compile(r'-?\d+(?:\.\d+)?(?:[eE]-?\d+)?')
+
+# "[AABB[0.0, 0.0, 0.0] -> [1.0, 0.5, 1.0], ...]", six numbers per box
+def parse_shape(text: str) -> Tuple[Tuple[float, ...], ...]:
+    numbers = [float(n) for n in NUMBER.findall(text)]
+    assert(len(numbers) % 6 == 0)
+    return tuple(tuple(numbers[i:i + 6]) for i in range(0, len(numbers), 6))
+
+def parse_blocks(data, props: Dict[str, Property], shapes: Dict[tuple, int]) -> List[Block]:
     blocks = []
     for key, value in data.items():
         block = Block()
@@ -80,11 +96,25 @@ def parse_blocks(data, props: Dict[str, Property]) -> List[Block]:
             state.id = value['stateId']
             state.air = value['air']
             state.renderShape = value['renderShape']
+            if 'collisionShape' in value:
+                shape = parse_shape(value['collisionShape'])
+            else:
+                shape = EMPTY_SHAPE if state.air else FULL_SHAPE
+            state.collisionShape = shapes.setdefault(shape, len(shapes))
+            state.lightEmission = value.get('lightEmission', 0)
+            if 'opacity' in value:
+                state.opacity = value['opacity']
+            else:
+                # without it full opaque cubes stop light and the rest lets
+                # it through
+                occludes = value.get('occludes', shape == FULL_SHAPE and state.renderShape == 'MODEL')
+                state.opacity = 15 if occludes else 0
+            assert(0 <= state.lightEmission <= 15 and 0 <= state.opacity <= 15)
             block.states.append(state)
         blocks.append(block)
     return blocks
 
-def write_cpp(w: TextIOBase, props: Dict[str, Property], blocks: List[Block]) -> None:
+def write_cpp(w: TextIOBase, props: Dict[str, Property], blocks: List[Block], shapes: Dict[tuple, int]) -> None:
     w.write('#include "data/block_impl.hh"\n')
     w.write('\n')
     w.write('namespace mccpp::data::impl {\n')
@@ -168,6 +198,32 @@ def write_cpp(w: TextIOBase, props: Dict[str, Property], blocks: List[Block]) ->
         for state in block.states:
             w.write(f'{block.id},')
     w.write('};\n')
+    w.write('  const uint16_t collision_shape[] = {')
+    for block in blocks:
+        for state in block.states:
+            w.write(f'{state.collisionShape},')
+    w.write('};\n')
+    w.write('  const uint8_t light[] = {')
+    for block in blocks:
+        for state in block.states:
+            w.write(f'0x{state.lightEmission << 4 | state.opacity:02x},')
+    w.write('};\n')
+    w.write(' }\n')
+    w.write(' namespace shape {\n')
+    w.write(f'  const size_t count = {len(shapes)};\n')
+    w.write('  const uint16_t box_offset[] = {')
+    offset = 0
+    for shape in shapes.keys():
+        w.write(f'{offset},')
+        offset += len(shape)
+    w.write(f'{offset},')
+    w.write('};\n')
+    w.write('  const double boxes[] = {')
+    for shape in shapes.keys():
+        for box in shape:
+            for value in box:
+                w.write(f'{value!r},')
+    w.write('};\n')
     w.write(' }\n')
     w.write('}\n')
 
@@ -184,12 +240,13 @@ def main(argv) -> None:
         props = parse_props(json.load(file))
 
     with open(blocks_path, "r") as file:
-        blocks = parse_blocks(json.load(file), props)
+        shapes = { EMPTY_SHAPE: 0, FULL_SHAPE: 1 }
+        blocks = parse_blocks(json.load(file), props, shapes)
 
     os.makedirs(os.path.dirname(out_path), exist_ok=True)
 
     with open(out_path, "w") as file:
-        write_cpp(file, props, blocks)
+        write_cpp(file, props, blocks, shapes)
 
 if __name__ == '__main__':
     main(sys.argv)
@@ -127,6 +127,34 @@ class Context:
             stream.write(f" \\\n{_INDENT}_MCCPP_ITER_STATE_END({state.upper})")
         stream.write("\n")
 
+    def write_tables(self, stream: TextIO, direction: Direction, indent = 0) -> None:
+        indent0 = _INDENT * indent
+        indent1 = indent0 + _INDENT
+        indent2 = indent1 + _INDENT
+        states = sorted(self.states, key = lambda state: state.id)
+        assert [state.id for state in states] == list(range(len(states)))
+
+        for state in states:
+            by_id = {packet.id: packet for packet in state.packets[direction]}
+            count = max(by_id.keys(), default = -1) + 1
+            stream.write("\n")
+            stream.write(f"{indent0}template<typename Table>\n")
+            stream.write(f"{indent0}inline constexpr std::array<typename Table::value_type, {count}> {state.lower}_table {{")
+            for id in range(count):
+                packet = by_id.get(id)
+                if packet is None:
+                    stream.write(f"\n{indent1}Table::missing(),")
+                else:
+                    stream.write(f"\n{indent1}Table::template entry<{state.lower}::{packet.name_class}>(),")
+            stream.write(f"\n{indent0}}};\n" if count else "};\n")
+
+        stream.write("\n")
+        stream.write(f"{indent0}template<typename Table>\n")
+        stream.write(f"{indent0}inline constexpr std::array<std::span<const typename Table::value_type>, {len(states)}> state_tables {{\n")
+        for state in states:
+            stream.write(f"{indent1}{state.lower}_table<Table>,\n")
+        stream.write(f"{indent0}}};\n")
+
 def write_header(argv0: str, stream: TextIO) -> None:
     stream.write(f"// Automatically generated by {argv0}\n")
     stream.write("#pragma once\n")
@@ -191,6 +219,21 @@ def main(argv: List[str]) -> int:
         stream.write('#include "types.hh"\n')
         ctx.write_iterators(stream, direction)
 
+    def _write_tables_hh(direction: Direction, stream: TextIO) -> None:
+        write_header(argv0, stream)
+        stream.write("\n")
+        stream.write("#include <array>\n")
+        stream.write("#include <span>\n")
+        stream.write("\n")
+        stream.write('#include "types.hh"\n')
+        stream.write("\n")
+        stream.write("// Every state has a table indexed by packet id built from Table::entry<Packet>(),\n")
+        stream.write("// ids without a packet are filled with Table::missing(). state_tables is\n")
+        stream.write("// indexed by connection_state.\n")
+        stream.write(f"\nnamespace mccpp::proto::generated::{direction.lower} {{\n")
+        ctx.write_tables(stream, direction)
+        write_namespace_end(stream)
+
     files: Dict[str, Callable[None, [TextIO]]] = {
         "misc.hh": _write_misc_hh,
         "format.hh": _write_format_hh,
@@ -201,6 +244,7 @@ def main(argv: List[str]) -> int:
         files[d / "types.hh"] = partial(_write_types_hh, direction)
         files[d / "traits.hh"] = partial(_write_traits_hh, direction)
         files[d / "iterators.hh"] = partial(_write_iterators_hh, direction)
+        files[d / "tables.hh"] = partial(_write_tables_hh, direction)
 
     for (path, writer) in files.items():
         full_path = out_path / path
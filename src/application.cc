@@ -1,6 +1,7 @@
 #include "application.hh"
 
 #include <chrono>
+#include <thread>
 
 #include <asio.hpp>
 #include <SDL.h>
@@ -180,7 +181,20 @@ int main(int argc, char **argv) {
     app.m_input_manager = input::manager::create(app);
     app.m_renderer = renderer::renderer::create(app);
     app.m_game = game::create(app);
-    app.m_client = std::make_unique<client::client>(app);
+    app.m_client = std::make_unique<client::client>(*app.m_game);
+
+    // Network I/O and packet framing runs on its own thread so that receiving
+    // isn't tied to the frame rate, packets are handled in client::poll()
+    auto io_work = asio::make_work_guard(io);
+    std::thread io_thread([&io] {
+        logger::set_thread_name("network");
+        io.run();
+    });
+    MCCPP_SCOPE_EXIT {
+        io_work.reset();
+        io.stop();
+        io_thread.join();
+    };
 
     //app.m_client->connect(io, "127.0.0.1", 25564);
 
@@ -194,7 +208,7 @@ int main(int argc, char **argv) {
     MCCPP_I("Total {}.{:06} ms", sc_ns / 1'000'000, sc_ns % 1'000'000);
 
     while (!app.should_exit()) {
-        io.poll();
+        app.m_client->poll();
 
         app.m_input_manager->pre_events();
         poll_events(app);
@@ -218,6 +232,8 @@ int main(int argc, char **argv) {
         app.m_frame_count++;
     }
 
+    client::log_packet_stats(app.m_client->packet_stats());
+
     return 0;
 }
 
@@ -23,8 +23,9 @@ void client::on_connect() {
         .next_state = proto::packet<handshaking::client_intention_packet>::LOGIN,
     });
     m_state = connection_state::LOGIN;
+    begin_login();
     queue_send<login::hello_packet>({
-        .name = "Foobar",
+        .name = m_options.username,
         .uuid = {},
     });
 }
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
+#include <vector>
 
 #include "../game.hh"
 #include "../proto/client.hh"
@@ -9,16 +11,69 @@
 
 namespace mccpp::client {
 
+struct client_options {
+    std::string username = "Foobar";
+    proto::dispatch_mode dispatch = proto::dispatch_mode::QUEUED;
+    // Decode received chunks without keeping them in the world
+    bool store_chunks = true;
+};
+
+struct packet_type_stats {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+    std::chrono::nanoseconds decode_time {};
+};
+
+// Entry of the minecraft:chat_type registry sent on login
+struct chat_type {
+    std::string name;
+    std::string translation_key;
+    // Filled into the translation in order: sender, target or content
+    std::vector<std::string> parameters;
+};
+
+// Indexed by connection state and then packet id
+using packet_stats_table = std::vector<std::vector<packet_type_stats>>;
+
+// Name of a clientbound packet, empty for ids without a packet
+std::string_view packet_name(proto::generated::connection_state, int32_t packet_id);
+
+// Logs every packet type that was received, slowest to decode first
+void log_packet_stats(const packet_stats_table &);
+
 class client final : public proto::client {
     using connection_state = proto::generated::connection_state;
 
 public:
-    client(application &app)
-    : m_game(app.game())
+    client(game &game, client_options options = {})
+    : proto::client(options.dispatch)
+    , m_game(game)
+    , m_options(std::move(options))
+    , m_packet_stats(empty_packet_stats())
     {}
 
     void connect(asio::io_context &, std::string_view address, uint16_t port);
 
+    const std::string &username() const { return m_options.username; }
+
+    uint64_t chunks_received() const {
+        return m_chunks_received.load(std::memory_order_relaxed);
+    }
+
+    // Only safe to read from the thread handling packets, that is the thread
+    // calling poll() or while no packets are handled
+    const packet_stats_table &packet_stats() const {
+        return m_packet_stats;
+    }
+
+    // Indexed by registry id
+    const std::vector<chat_type> &chat_types() const {
+        return m_chat_types;
+    }
+
+    // Sized for every clientbound packet with all counters zero
+    static packet_stats_table empty_packet_stats();
+
 private:
     void on_error() override final;
     void on_connect() override final;
@@ -30,9 +85,20 @@ private:
     template<class PacketInfo>
     void handle_packet(proto::packet_reader &);
 
+    // NOTE: implemented in handlers.cc
+    template<class PacketInfo>
+    void dispatch_packet(proto::packet_reader &);
+
+    // NOTE: defined in handlers.cc
+    struct handler_table;
+
     game &m_game;
+    const client_options m_options;
 
     connection_state m_state = connection_state::HANDSHAKING;
+    std::atomic<uint64_t> m_chunks_received = 0;
+    packet_stats_table m_packet_stats;
+    std::vector<chat_type> m_chat_types;
 
     std::string m_server_name;
     uint16_t m_server_port;
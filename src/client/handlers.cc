@@ -1,8 +1,10 @@
 #include "generated/client/handlers.hh"
 
+#include <algorithm>
+
 #include "logger.hh"
 #include "proto/exceptions.hh"
-#include "generated/proto/clientbound/iterators.hh"
+#include "generated/proto/clientbound/tables.hh"
 #include "generated/proto/clientbound/traits.hh"
 #include "generated/proto/format.hh"
 #include "client.hh"
@@ -16,47 +18,101 @@ void client::handle_packet(proto::packet_reader &s) {
     s.discard(s.remaining());
 }
 
+template<class PacketInfo>
+void client::dispatch_packet(proto::packet_reader &s) {
+    using traits = proto::generated::packet_traits<PacketInfo>;
+    size_t bytes = s.remaining();
+    auto start = std::chrono::steady_clock::now();
+    handle_packet<PacketInfo>(s);
+    auto finish = std::chrono::steady_clock::now();
+
+    packet_type_stats &stats = m_packet_stats[static_cast<size_t>(traits::state)][PacketInfo::id];
+    stats.count++;
+    stats.bytes += bytes;
+    stats.decode_time += finish - start;
+}
+
 #define SILENCE_PACKET(name) \
         template<> \
         void client::handle_packet<proto::generated::clientbound::play::name>(proto::packet_reader &s) { \
             s.discard(s.remaining()); \
         }
 
-SILENCE_PACKET(add_entity_packet)
 SILENCE_PACKET(entity_event_packet)
-SILENCE_PACKET(pos_rot)
-SILENCE_PACKET(pos)
-SILENCE_PACKET(remove_entities_packet)
-SILENCE_PACKET(rot)
-SILENCE_PACKET(rotate_head_packet)
 SILENCE_PACKET(set_entity_data_packet)
-SILENCE_PACKET(set_entity_motion_packet)
 SILENCE_PACKET(set_time_packet)
-SILENCE_PACKET(teleport_entity_packet)
 SILENCE_PACKET(update_attributes_packet)
 
+struct client::handler_table {
+    using value_type = void (client::*)(proto::packet_reader &);
+
+    template<class PacketInfo>
+    static constexpr value_type entry() { return &client::dispatch_packet<PacketInfo>; }
+    static constexpr value_type missing() { return nullptr; }
+};
+
+struct packet_name_table {
+    using value_type = std::string_view;
+
+    template<class PacketInfo>
+    static constexpr value_type entry() { return proto::generated::packet_traits<PacketInfo>::name; }
+    static constexpr value_type missing() { return {}; }
+};
+
 void client::on_packet_received(int32_t packet_id, proto::packet_reader &reader) {
     using namespace proto::generated;
-    switch (m_state) {
-#define _MCCPP_ITER_STATE_START(state)  \
-    case connection_state::state: \
-        switch (packet_id) {
-#define _MCCPP_ITER_PACKET(type) \
-            case type::id: return handle_packet<type>(reader);
-#define _MCCPP_ITER_STATE_END(state) \
-        } \
-        break;
-
-    MCCPP_ITERATE_CLIENTBOUND
-
-#undef _MCCPP_ITER_STATE_END
-#undef _MCCPP_ITER_PACKET
-#undef _MCCPP_ITER_STATE_START
-    };
+    constexpr auto &handlers = clientbound::state_tables<handler_table>;
+
+    std::span<const handler_table::value_type> state_handlers = handlers[static_cast<size_t>(m_state)];
+    if (packet_id >= 0 && static_cast<size_t>(packet_id) < state_handlers.size()) {
+        if (handler_table::value_type handler = state_handlers[packet_id])
+            return (this->*handler)(reader);
+    }
 
     // Either the server sent us an invalid packet or we're in an incorrect state
     MCCPP_E("Received an invalid packet id 0x{:02x} in state {}", packet_id, m_state);
     throw proto::protocol_error("invalid packet id");
 }
 
+packet_stats_table client::empty_packet_stats() {
+    packet_stats_table table {};
+    for (std::span<const std::string_view> names : proto::generated::clientbound::state_tables<packet_name_table>) {
+        table.emplace_back(names.size());
+    }
+    return table;
+}
+
+std::string_view packet_name(proto::generated::connection_state state, int32_t packet_id) {
+    constexpr auto &names = proto::generated::clientbound::state_tables<packet_name_table>;
+    std::span<const std::string_view> state_names = names.at(static_cast<size_t>(state));
+    if (packet_id < 0 || static_cast<size_t>(packet_id) >= state_names.size())
+        return {};
+    return state_names[packet_id];
+}
+
+void log_packet_stats(const packet_stats_table &table) {
+    using namespace proto::generated;
+    using ms = std::chrono::duration<double, std::milli>;
+    constexpr double MB = 1024. * 1024.;
+
+    std::vector<std::pair<std::string_view, const packet_type_stats *>> by_time {};
+    for (size_t state = 0; state < table.size(); state++) {
+        for (size_t id = 0; id < table[state].size(); id++) {
+            if (table[state][id].count)
+                by_time.emplace_back(packet_name(connection_state(state), id), &table[state][id]);
+        }
+    }
+    std::sort(by_time.begin(), by_time.end(), [](const auto &a, const auto &b) {
+        return a.second->decode_time > b.second->decode_time;
+    });
+
+    MCCPP_I("{:<48} {:>10} {:>12} {:>10} {:>10}", "packet", "count", "total ms", "avg us", "MB/s");
+    for (const auto &[name, stats] : by_time) {
+        double total_ms = ms(stats->decode_time).count();
+        MCCPP_I("{:<48} {:>10} {:>12.3f} {:>10.3f} {:>10.1f}",
+                name, stats->count, total_ms, total_ms * 1000. / stats->count,
+                total_ms > 0 ? stats->bytes / MB / (total_ms / 1000.) : 0.);
+    }
+}
+
 }
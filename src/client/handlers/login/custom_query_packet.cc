@@ -1,6 +1,7 @@
 #include "generated/client/handlers.hh"
 
 #include "../../../logger.hh"
+#include "../../../proto/clientbound/packets.hh"
 #include "../../../proto/serverbound/packets.hh"
 
 namespace mccpp::client {
@@ -10,10 +11,11 @@ template<>
 void client::handle_packet<proto::generated::clientbound::login::custom_query_packet>(proto::packet_reader &s) {
     using namespace proto::generated;
 
-    int32_t message_id = s.read_varint();
-    s.discard(s.remaining());
+    auto request = proto::read_packet<clientbound::login::custom_query_packet>(s);
+    MCCPP_D("Ignoring login plugin request {} on \"{}\"", request.message_id, request.channel);
     queue_send<serverbound::login::custom_query_packet>({
-        .message_id = message_id,
+        .message_id = request.message_id,
+        .data = std::nullopt,
     });
 }
 
@@ -1,6 +1,7 @@
 #include "generated/client/handlers.hh"
 
 #include "../../../logger.hh"
+#include "../../../proto/clientbound/packets.hh"
 #include "../../../proto/serverbound/packets.hh"
 
 namespace mccpp::client {
@@ -10,16 +11,10 @@ template<>
 void client::handle_packet<proto::generated::clientbound::login::game_profile_packet>(proto::packet_reader &s) {
     using namespace proto::generated;
 
-    class uuid uuid = s.read_uuid();
-    std::string name = s.read_string<16>();
-    int32_t prop_count = s.read_varint();
-    MCCPP_I("Login success as \"{}\" ({}) with {} properties", name, uuid, prop_count);
-    while (prop_count-- > 0) {
-        std::string name = s.read_string<32767>();
-        std::string value = s.read_string<32767>();
-        bool is_signed = s.read_bool();
-        std::string signature = is_signed ? s.read_string<32767>() : "";
-        MCCPP_D("Property \"{}\": \"{}\" sig \"{}\"", name, value, signature);
+    auto profile = proto::read_packet<clientbound::login::game_profile_packet>(s);
+    MCCPP_I("Login success as \"{}\" ({}) with {} properties", profile.username, profile.uuid, profile.properties.size());
+    for (const auto &property : profile.properties) {
+        MCCPP_D("Property \"{}\": \"{}\" sig \"{}\"", property.name, property.value, property.signature.value_or(""));
     }
 
     m_state = connection_state::PLAY;
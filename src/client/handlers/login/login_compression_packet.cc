@@ -1,15 +1,18 @@
 #include "generated/client/handlers.hh"
 
 #include "../../../logger.hh"
+#include "../../../proto/clientbound/packets.hh"
 
 namespace mccpp::client {
 
 // https://wiki.vg/index.php?title=Protocol&oldid=17979#Set_Compression
 template<>
 void client::handle_packet<proto::generated::clientbound::login::login_compression_packet>(proto::packet_reader &s) {
-    (void)s;
-    MCCPP_F("Protocol compression not yet implemented");
-    abort();
+    using namespace proto::generated;
+
+    // NOTE: proto::client already switched the framing over when it received this
+    auto compression = proto::read_packet<clientbound::login::login_compression_packet>(s);
+    MCCPP_D("Compression threshold set to {}", compression.threshold);
 }
 
 }
@@ -0,0 +1,25 @@
+#include "generated/client/handlers.hh"
+
+namespace mccpp::client {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Spawn_Entity
+template<>
+void client::handle_packet<proto::generated::clientbound::play::add_entity_packet>(proto::packet_reader &s) {
+    world::entity_spawn spawn {};
+    spawn.id = s.read_varint();
+    spawn.uuid = s.read_uuid();
+    spawn.type = s.read_varint();
+    spawn.position.x = s.read_double();
+    spawn.position.y = s.read_double();
+    spawn.position.z = s.read_double();
+    spawn.pitch = s.read_angle();
+    spawn.yaw = s.read_angle();
+    spawn.head_yaw = s.read_angle();
+    /* data */ s.read_varint();
+    spawn.velocity.x = s.read_i16() / 8000.f;
+    spawn.velocity.y = s.read_i16() / 8000.f;
+    spawn.velocity.z = s.read_i16() / 8000.f;
+    m_game.world().entities().add(spawn);
+}
+
+}
@@ -0,0 +1,21 @@
+#include "generated/client/handlers.hh"
+
+namespace mccpp::client {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Spawn_Player
+template<>
+void client::handle_packet<proto::generated::clientbound::play::add_player_packet>(proto::packet_reader &s) {
+    world::entity_spawn spawn {};
+    spawn.id = s.read_varint();
+    spawn.uuid = s.read_uuid();
+    spawn.type = world::PLAYER_ENTITY_TYPE;
+    spawn.position.x = s.read_double();
+    spawn.position.y = s.read_double();
+    spawn.position.z = s.read_double();
+    spawn.yaw = s.read_angle();
+    spawn.pitch = s.read_angle();
+    spawn.head_yaw = spawn.yaw;
+    m_game.world().entities().add(spawn);
+}
+
+}
@@ -0,0 +1,20 @@
+#include "generated/client/handlers.hh"
+
+#include "../../../nbt.hh"
+
+namespace mccpp::client {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Block_Entity_Data
+template<>
+void client::handle_packet<proto::generated::clientbound::play::block_entity_data_packet>(proto::packet_reader &s) {
+    proto::position position = s.read_position();
+    int32_t type = s.read_varint();
+    world::chunk_column *column = m_options.store_chunks
+            ? m_game.world().chunks().try_get(position.x() >> 4, position.z() >> 4) : nullptr;
+    if (column)
+        column->block_entities().set(position.x() & 15, position.y(), position.z() & 15, type, s);
+    else
+        nbt::skip(s);
+}
+
+}
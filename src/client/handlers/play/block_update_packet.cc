@@ -0,0 +1,20 @@
+#include "generated/client/handlers.hh"
+
+#include <limits>
+
+#include "../../../proto/exceptions.hh"
+
+namespace mccpp::client {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Block_Update
+template<>
+void client::handle_packet<proto::generated::clientbound::play::block_update_packet>(proto::packet_reader &s) {
+    proto::position position = s.read_position();
+    int32_t state = s.read_varint();
+    if (state < 0 || state > std::numeric_limits<world::block_state>::max())
+        throw proto::decode_error("invalid block state");
+    if (m_options.store_chunks)
+        m_game.world().set_block(position.x(), position.y(), position.z(), static_cast<world::block_state>(state));
+}
+
+}
@@ -1,6 +1,7 @@
 #include "generated/client/handlers.hh"
 
 #include "../../../logger.hh"
+#include "../../../proto/clientbound/packets.hh"
 #include "../../../proto/serverbound/packets.hh"
 #include "../../../utility/format.hh"
 #include "../../../nbt.hh"
@@ -10,12 +11,14 @@ namespace mccpp::client {
 // https://wiki.vg/index.php?title=Protocol&oldid=17979#Plugin_Message
 template<>
 void client::handle_packet<proto::generated::clientbound::play::custom_payload_packet>(proto::packet_reader &s) {
-    std::string channel = s.read_identifier();
-    if (channel == "minecraft:brand") {
-        MCCPP_I("Server Brand: {}", s.read_char_array(s.remaining()));
+    using namespace proto::generated;
+
+    auto payload = proto::read_packet<clientbound::play::custom_payload_packet>(s);
+    if (payload.channel == "minecraft:brand") {
+        std::string_view brand(reinterpret_cast<const char *>(payload.data.data()), payload.data.size());
+        MCCPP_I("Server Brand: {}", brand);
     } else {
-        MCCPP_I("Received plugin message of length {} on an unknown channel \"{}\"", s.remaining(), channel);
-        s.discard(s.remaining());
+        MCCPP_I("Received plugin message of length {} on an unknown channel \"{}\"", payload.data.size(), payload.channel);
     }
 }
 
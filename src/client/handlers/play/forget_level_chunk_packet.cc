@@ -0,0 +1,14 @@
+#include "generated/client/handlers.hh"
+
+namespace mccpp::client {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Unload_Chunk
+template<>
+void client::handle_packet<proto::generated::clientbound::play::forget_level_chunk_packet>(proto::packet_reader &s) {
+    int32_t chunk_x = s.read_i32();
+    int32_t chunk_z = s.read_i32();
+    if (m_options.store_chunks)
+        m_game.world().unload_column(chunk_x, chunk_z);
+}
+
+}
@@ -1,6 +1,7 @@
 #include "generated/client/handlers.hh"
 
 #include "../../../logger.hh"
+#include "../../../proto/clientbound/packets.hh"
 #include "../../../proto/serverbound/packets.hh"
 #include "../../../utility/format.hh"
 #include "../../../nbt.hh"
@@ -12,9 +13,9 @@ template<>
 void client::handle_packet<proto::generated::clientbound::play::keep_alive_packet>(proto::packet_reader &s) {
     using namespace proto::generated;
 
-    int64_t keep_alive_id = s.read_i64();
+    auto keep_alive = proto::read_packet<clientbound::play::keep_alive_packet>(s);
     queue_send<serverbound::play::keep_alive_packet>({
-        .keep_alive_id = keep_alive_id,
+        .keep_alive_id = keep_alive.keep_alive_id,
     });
 }
 
@@ -4,7 +4,6 @@
 #include "../../../proto/serverbound/packets.hh"
 #include "../../../proto/exceptions.hh"
 #include "../../../utility/format.hh"
-#include "../../../nbt.hh"
 
 namespace mccpp::client {
 
@@ -13,36 +12,54 @@ template<>
 void client::handle_packet<proto::generated::clientbound::play::level_chunk_with_light_packet>(proto::packet_reader &s) {
     int32_t chunk_x = s.read_i32();
     int32_t chunk_y = s.read_i32();
-    nbt::nbt heightmaps { s };
+    size_t world_height = m_game.world().chunks().height_in_chunks() * 16;
+    world::chunk_column *chunk_column = m_options.store_chunks
+            ? &m_game.world().chunks().get(chunk_x, chunk_y) : nullptr;
+    if (chunk_column) {
+        chunk_column->heightmaps().load(s, world_height);
+    } else {
+        world::column_heightmaps scratch {};
+        scratch.load(s, world_height);
+    }
+
     int32_t data_size = s.read_varint();
     if (data_size < 0) {
         throw proto::decode_error("invalid data size");
     }
-    proto::packet_reader chunk_reader([&s]() -> std::byte {
-        return s.read_byte();
-    }, data_size);
+    proto::packet_reader chunk_reader = s.take(data_size);
 
-    world::chunk_column &chunk_column = m_game.world().chunks().get(chunk_x, chunk_y);
     // https://wiki.vg/index.php?title=Chunk_Format&oldid=17949#Data_structure
-    for (world::chunk &chunk : chunk_column) {
-        chunk.load(chunk_reader);
+    if (chunk_column) {
+        for (world::chunk &chunk : *chunk_column) {
+            chunk.load(chunk_reader);
+        }
+    } else {
+        // still decode everything so headless clients pay the same cost
+        auto scratch = std::make_unique<world::chunk>();
+        for (size_t i = 0; i < m_game.world().chunks().height_in_chunks(); i++) {
+            scratch->load(chunk_reader);
+        }
     }
 
     chunk_reader.discard(chunk_reader.remaining());
 
-    int32_t number_of_block_entities = s.read_varint();
-    for (int32_t i = 0; i < number_of_block_entities; i++) {
-        uint8_t packed_xz = s.read_u8();
-        int16_t y = s.read_i16();
-        int32_t type = s.read_varint();
-        nbt::nbt data { s };
-        (void)packed_xz;
-        (void)y;
-        (void)type;
+    if (chunk_column) {
+        chunk_column->block_entities().load(s);
+    } else {
+        world::column_block_entities scratch {};
+        scratch.load(s);
     }
     bool trust_edges = s.read_bool();
-    s.discard(s.remaining());
-    //MCCPP_T("chunk {}, {}  block entities {}  trust edges {}", chunk_x, chunk_y, number_of_block_entities, trust_edges);
+    if (chunk_column) {
+        chunk_column->light().load(s);
+        // may evict the column, it's done with here
+        m_game.world().on_column_loaded(chunk_x, chunk_y);
+    } else {
+        world::column_light scratch { m_game.world().chunks().height_in_chunks() };
+        scratch.load(s);
+    }
+    m_chunks_received.fetch_add(1, std::memory_order_relaxed);
+    //MCCPP_T("chunk {}, {}  trust edges {}", chunk_x, chunk_y, trust_edges);
     (void)chunk_x;
     (void)chunk_y;
     (void)trust_edges;
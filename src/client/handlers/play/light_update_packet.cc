@@ -0,0 +1,28 @@
+#include "generated/client/handlers.hh"
+
+#include "../../../logger.hh"
+
+namespace mccpp::client {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Update_Light
+template<>
+void client::handle_packet<proto::generated::clientbound::play::light_update_packet>(proto::packet_reader &s) {
+    int32_t chunk_x = s.read_varint();
+    int32_t chunk_z = s.read_varint();
+    /* trust_edges */ s.read_bool();
+
+    world::chunk_column *chunk_column = m_options.store_chunks
+            ? m_game.world().chunks().try_get(chunk_x, chunk_z) : nullptr;
+    if (chunk_column) {
+        chunk_column->light().load(s);
+        m_game.world().on_light_loaded(chunk_x, chunk_z);
+        return;
+    }
+
+    // light for a column we don't have, decode it anyway to validate it
+    MCCPP_T("light update for missing chunk {}, {}", chunk_x, chunk_z);
+    world::column_light scratch { m_game.world().chunks().height_in_chunks() };
+    scratch.load(s);
+}
+
+}
@@ -1,9 +1,12 @@
 #include "generated/client/handlers.hh"
 
+#include <algorithm>
+
 #include "../../../logger.hh"
+#include "../../../proto/exceptions.hh"
 #include "../../../proto/serverbound/packets.hh"
 #include "../../../utility/format.hh"
-#include "../../../nbt.hh"
+#include "../../../nbt_visitor.hh"
 
 namespace mccpp::client {
 
@@ -16,6 +19,107 @@ static std::vector<std::byte> string_to_bytes(std::string_view str) {
     return vec;
 }
 
+namespace {
+
+struct dimension_info {
+    std::string name;
+    int32_t min_y = 0;
+    int32_t height = 256;
+};
+
+// The parts of registry_codec the client uses
+struct registries {
+    std::vector<dimension_info> dimension_types;
+    std::vector<world::biome> biomes;
+    std::vector<chat_type> chat_types;
+};
+
+}
+
+// Entry i of a registry list, added as the values come in
+template<typename T>
+static T &entry(std::vector<T> &entries, size_t i) {
+    if (i >= entries.size())
+        entries.resize(i + 1);
+    return entries[i];
+}
+
+// Moves the entries of a registry list to their ids, entries without a valid
+// id are dropped
+template<typename T>
+static std::vector<T> order_by_id(std::vector<T> entries, const std::vector<int32_t> &ids) {
+    std::vector<T> ordered {};
+    for (size_t i = 0; i < entries.size() && i < ids.size(); i++) {
+        // ids are small and dense, anything else is a broken registry
+        if (ids[i] < 0 || static_cast<size_t>(ids[i]) >= entries.size())
+            continue;
+        entry(ordered, ids[i]) = std::move(entries[i]);
+    }
+    return ordered;
+}
+
+// Picks the values out of the registry_codec NBT in one pass, skipping the
+// damage types, trim materials and everything else the client doesn't use
+static registries read_registries(proto::packet_reader &s) {
+    registries r {};
+    std::vector<int32_t> biome_ids {};
+    std::vector<int32_t> chat_type_ids {};
+    using match = nbt::path_query::match;
+    nbt::path_query query {};
+
+    query.on({ "minecraft:dimension_type", "value", "*", "name" }, [&](const match &m) {
+        entry(r.dimension_types, m.indices[0]).name = m.string;
+    });
+    query.on({ "minecraft:dimension_type", "value", "*", "element", "min_y" }, [&](const match &m) {
+        entry(r.dimension_types, m.indices[0]).min_y = static_cast<int32_t>(m.integer);
+    });
+    query.on({ "minecraft:dimension_type", "value", "*", "element", "height" }, [&](const match &m) {
+        entry(r.dimension_types, m.indices[0]).height = static_cast<int32_t>(m.integer);
+    });
+
+    query.on({ "minecraft:worldgen/biome", "value", "*", "name" }, [&](const match &m) {
+        entry(r.biomes, m.indices[0]).name = m.string;
+    });
+    query.on({ "minecraft:worldgen/biome", "value", "*", "id" }, [&](const match &m) {
+        entry(biome_ids, m.indices[0]) = static_cast<int32_t>(m.integer);
+    });
+    query.on({ "minecraft:worldgen/biome", "value", "*", "element", "temperature" }, [&](const match &m) {
+        entry(r.biomes, m.indices[0]).temperature = static_cast<float>(m.floating);
+    });
+    query.on({ "minecraft:worldgen/biome", "value", "*", "element", "downfall" }, [&](const match &m) {
+        entry(r.biomes, m.indices[0]).downfall = static_cast<float>(m.floating);
+    });
+    auto color = [&](std::string_view name, auto member) {
+        query.on({ "minecraft:worldgen/biome", "value", "*", "element", "effects", name }, [&r, member](const match &m) {
+            entry(r.biomes, m.indices[0]).*member = static_cast<uint32_t>(m.integer);
+        });
+    };
+    color("sky_color", &world::biome::sky_color);
+    color("fog_color", &world::biome::fog_color);
+    color("water_color", &world::biome::water_color);
+    color("water_fog_color", &world::biome::water_fog_color);
+    color("grass_color", &world::biome::grass_color);
+    color("foliage_color", &world::biome::foliage_color);
+
+    query.on({ "minecraft:chat_type", "value", "*", "name" }, [&](const match &m) {
+        entry(r.chat_types, m.indices[0]).name = m.string;
+    });
+    query.on({ "minecraft:chat_type", "value", "*", "id" }, [&](const match &m) {
+        entry(chat_type_ids, m.indices[0]) = static_cast<int32_t>(m.integer);
+    });
+    query.on({ "minecraft:chat_type", "value", "*", "element", "chat", "translation_key" }, [&](const match &m) {
+        entry(r.chat_types, m.indices[0]).translation_key = m.string;
+    });
+    query.on({ "minecraft:chat_type", "value", "*", "element", "chat", "parameters", "*" }, [&](const match &m) {
+        entry(entry(r.chat_types, m.indices[0]).parameters, m.indices[1]) = m.string;
+    });
+
+    query.run(s);
+    r.biomes = order_by_id(std::move(r.biomes), biome_ids);
+    r.chat_types = order_by_id(std::move(r.chat_types), chat_type_ids);
+    return r;
+}
+
 // https://wiki.vg/index.php?title=Protocol&oldid=17979#Login_.28play.29
 template<>
 void client::handle_packet<proto::generated::clientbound::play::login_packet>(proto::packet_reader &s) {
@@ -30,7 +134,7 @@ void client::handle_packet<proto::generated::clientbound::play::login_packet>(pr
     while (dimension_count-- > 0) {
         dimension_names.emplace_back(s.read_identifier());
     }
-    nbt::nbt registry_codec(s);
+    registries registry_codec = read_registries(s);
     std::string dimension_type = s.read_identifier();
     std::string dimension_name = s.read_identifier();
     int64_t hashed_seed = s.read_i64();
@@ -57,8 +161,18 @@ void client::handle_packet<proto::generated::clientbound::play::login_packet>(pr
         MCCPP_D("Death Location: {} {} {} {}", death_dimension_name, death_location.x(), death_location.y(), death_location.z());
     }
 
-    // FIXME: get world height from registry_codec/dimension_type/height and handle the rest of the registry
-    m_game.create_world(384);
+    MCCPP_D("Registries: {} dimension types, {} biomes, {} chat types", registry_codec.dimension_types.size(),
+            registry_codec.biomes.size(), registry_codec.chat_types.size());
+
+    auto dimension = std::find_if(registry_codec.dimension_types.begin(), registry_codec.dimension_types.end(),
+                                  [&](const dimension_info &type) { return type.name == dimension_type; });
+    if (dimension == registry_codec.dimension_types.end())
+        throw proto::protocol_error(fmt::format("unknown dimension type {}", dimension_type));
+    if (dimension->height <= 0 || dimension->height % 16 != 0 || dimension->min_y % 16 != 0)
+        throw proto::protocol_error(fmt::format("invalid dimension type {}", dimension_type));
+    world::world &world = m_game.create_world(dimension->min_y, dimension->height, std::move(registry_codec.biomes));
+    world.chunks().set_view_distance(view_distance);
+    m_chat_types = std::move(registry_codec.chat_types);
 
     queue_send<serverbound::play::custom_payload_packet>({
         .channel = "minecraft:brand",
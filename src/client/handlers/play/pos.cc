@@ -0,0 +1,17 @@
+#include "generated/client/handlers.hh"
+
+namespace mccpp::client {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Update_Entity_Position
+template<>
+void client::handle_packet<proto::generated::clientbound::play::pos>(proto::packet_reader &s) {
+    int32_t id = s.read_varint();
+    glm::dvec3 delta {};
+    delta.x = s.read_i16() / 4096.;
+    delta.y = s.read_i16() / 4096.;
+    delta.z = s.read_i16() / 4096.;
+    bool on_ground = s.read_bool();
+    m_game.world().entities().move(id, delta, on_ground);
+}
+
+}
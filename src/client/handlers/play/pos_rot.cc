@@ -0,0 +1,21 @@
+#include "generated/client/handlers.hh"
+
+namespace mccpp::client {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Update_Entity_Position_and_Rotation
+template<>
+void client::handle_packet<proto::generated::clientbound::play::pos_rot>(proto::packet_reader &s) {
+    int32_t id = s.read_varint();
+    glm::dvec3 delta {};
+    delta.x = s.read_i16() / 4096.;
+    delta.y = s.read_i16() / 4096.;
+    delta.z = s.read_i16() / 4096.;
+    float yaw = s.read_angle();
+    float pitch = s.read_angle();
+    bool on_ground = s.read_bool();
+    world::entity_store &entities = m_game.world().entities();
+    if (entities.move(id, delta, on_ground))
+        entities.rotate(id, yaw, pitch, on_ground);
+}
+
+}
@@ -0,0 +1,19 @@
+#include "generated/client/handlers.hh"
+
+#include "../../../proto/exceptions.hh"
+
+namespace mccpp::client {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Remove_Entities
+template<>
+void client::handle_packet<proto::generated::clientbound::play::remove_entities_packet>(proto::packet_reader &s) {
+    int32_t count = s.read_varint();
+    if (count < 0 || static_cast<size_t>(count) > s.remaining())
+        throw proto::decode_error("invalid entity count");
+    world::entity_store &entities = m_game.world().entities();
+    for (int32_t i = 0; i < count; i++) {
+        entities.remove(s.read_varint());
+    }
+}
+
+}
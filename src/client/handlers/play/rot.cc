@@ -0,0 +1,15 @@
+#include "generated/client/handlers.hh"
+
+namespace mccpp::client {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Update_Entity_Rotation
+template<>
+void client::handle_packet<proto::generated::clientbound::play::rot>(proto::packet_reader &s) {
+    int32_t id = s.read_varint();
+    float yaw = s.read_angle();
+    float pitch = s.read_angle();
+    bool on_ground = s.read_bool();
+    m_game.world().entities().rotate(id, yaw, pitch, on_ground);
+}
+
+}
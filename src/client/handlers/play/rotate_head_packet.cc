@@ -0,0 +1,13 @@
+#include "generated/client/handlers.hh"
+
+namespace mccpp::client {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Set_Head_Rotation
+template<>
+void client::handle_packet<proto::generated::clientbound::play::rotate_head_packet>(proto::packet_reader &s) {
+    int32_t id = s.read_varint();
+    float head_yaw = s.read_angle();
+    m_game.world().entities().rotate_head(id, head_yaw);
+}
+
+}
@@ -0,0 +1,32 @@
+#include "generated/client/handlers.hh"
+
+#include <vector>
+
+#include "../../../proto/exceptions.hh"
+
+namespace mccpp::client {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Update_Section_Blocks
+template<>
+void client::handle_packet<proto::generated::clientbound::play::section_blocks_update_packet>(proto::packet_reader &s) {
+    // x and z are 22 bits, y 20 bits
+    int64_t section = s.read_i64();
+    glm::ivec3 position {
+        static_cast<int32_t>(section >> 42),
+        static_cast<int32_t>(section << 44 >> 44),
+        static_cast<int32_t>(section << 22 >> 42),
+    };
+    /* suppress_light_updates */ s.read_bool();
+
+    int32_t count = s.read_varint();
+    if (count < 0 || static_cast<size_t>(count) > s.remaining())
+        throw proto::decode_error("invalid block count");
+    std::vector<int64_t> entries(count);
+    for (int64_t &entry : entries) {
+        entry = s.read_varlong();
+    }
+    if (m_options.store_chunks)
+        m_game.world().set_blocks(position, entries);
+}
+
+}
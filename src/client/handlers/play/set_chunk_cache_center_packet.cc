@@ -0,0 +1,13 @@
+#include "generated/client/handlers.hh"
+
+namespace mccpp::client {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Set_Center_Chunk
+template<>
+void client::handle_packet<proto::generated::clientbound::play::set_chunk_cache_center_packet>(proto::packet_reader &s) {
+    int32_t chunk_x = s.read_varint();
+    int32_t chunk_z = s.read_varint();
+    m_game.world().set_center(chunk_x, chunk_z);
+}
+
+}
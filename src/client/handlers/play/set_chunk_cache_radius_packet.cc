@@ -0,0 +1,12 @@
+#include "generated/client/handlers.hh"
+
+namespace mccpp::client {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Set_Render_Distance
+template<>
+void client::handle_packet<proto::generated::clientbound::play::set_chunk_cache_radius_packet>(proto::packet_reader &s) {
+    int32_t view_distance = s.read_varint();
+    m_game.world().chunks().set_view_distance(view_distance);
+}
+
+}
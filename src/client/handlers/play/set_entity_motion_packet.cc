@@ -0,0 +1,16 @@
+#include "generated/client/handlers.hh"
+
+namespace mccpp::client {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Set_Entity_Velocity
+template<>
+void client::handle_packet<proto::generated::clientbound::play::set_entity_motion_packet>(proto::packet_reader &s) {
+    int32_t id = s.read_varint();
+    glm::vec3 velocity {};
+    velocity.x = s.read_i16() / 8000.f;
+    velocity.y = s.read_i16() / 8000.f;
+    velocity.z = s.read_i16() / 8000.f;
+    m_game.world().entities().set_velocity(id, velocity);
+}
+
+}
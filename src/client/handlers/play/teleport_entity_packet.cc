@@ -0,0 +1,21 @@
+#include "generated/client/handlers.hh"
+
+namespace mccpp::client {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Teleport_Entity
+template<>
+void client::handle_packet<proto::generated::clientbound::play::teleport_entity_packet>(proto::packet_reader &s) {
+    int32_t id = s.read_varint();
+    glm::dvec3 position {};
+    position.x = s.read_double();
+    position.y = s.read_double();
+    position.z = s.read_double();
+    float yaw = s.read_angle();
+    float pitch = s.read_angle();
+    bool on_ground = s.read_bool();
+    world::entity_store &entities = m_game.world().entities();
+    if (entities.teleport(id, position, on_ground))
+        entities.rotate(id, yaw, pitch, on_ground);
+}
+
+}
@@ -1,13 +1,17 @@
 #include "generated/client/handlers.hh"
 
 #include "../../../logger.hh"
+#include "../../../proto/clientbound/packets.hh"
 
 namespace mccpp::client {
 
 // https://wiki.vg/index.php?title=Protocol&oldid=17979#Ping_Response
 template<>
 void client::handle_packet<proto::generated::clientbound::status::pong_response_packet>(proto::packet_reader &s) {
-    MCCPP_I("pong response: 0x{:016x}", s.read_i64());
+    using namespace proto::generated;
+
+    auto pong = proto::read_packet<clientbound::status::pong_response_packet>(s);
+    MCCPP_I("pong response: 0x{:016x}", pong.payload);
 }
 
 }
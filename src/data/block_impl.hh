@@ -41,6 +41,21 @@ namespace impl::block {
 namespace impl::state {
     extern const size_t count;
     extern const block_id block[];
+    // index into impl::shape
+    extern const uint16_t collision_shape[];
+    // bits 0-3 opacity
+    //      4-7 emission
+    extern const uint8_t light[];
+}
+
+// Deduplicated collision shapes in block space, shape 0 is empty and shape 1
+// a full cube
+namespace impl::shape {
+    extern const size_t count;
+    // count + 1 entries, the boxes of shape i are [box_offset[i], box_offset[i + 1])
+    extern const uint16_t box_offset[];
+    // min x, y, z then max x, y, z per box
+    extern const double boxes[];
 }
 
 }
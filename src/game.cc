@@ -1,17 +1,25 @@
 #include "game.hh"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <imgui.h>
 
+#include "client/client.hh"
 #include "cvar.hh"
 #include "input/input.hh"
 #include "renderer/renderer.hh"
 
 namespace mccpp {
 
+static constexpr float TICK_TIME = 0.05f;
+static constexpr float PLAYER_EYE_HEIGHT = 1.62f;
+static constexpr double PLAYER_WIDTH = 0.6;
+static constexpr double PLAYER_HEIGHT = 1.8;
+
 class game_impl final : public game {
 public:
     game_impl(application &);
@@ -20,6 +28,14 @@ public:
     float delta_time() override { return m_frame_time; }
 
 private:
+    // One step of vanilla walking physics, move is the horizontal input in
+    // world space
+    void tick_player(glm::dvec3 move, bool jump);
+
+    void draw_packet_stats();
+    void draw_chunk_stats();
+
+    application &m_app;
     cvar::manager &m_cvar_manager;
     input::manager &m_input_manager;
     renderer::renderer &m_renderer;
@@ -27,6 +43,21 @@ private:
     std::chrono::steady_clock::time_point m_frame_last;
     float m_frame_time = 0.f;
 
+    bool m_noclip = false;
+    // Light propagation steps per frame, 0 for unlimited
+    size_t m_light_budget = world::light_engine::DEFAULT_BUDGET;
+    // Physics and entities run at the server tick rate, the camera and
+    // entities are drawn interpolated between the last two ticks
+    float m_tick_time = 0.f;
+    struct {
+        // Center of the feet
+        glm::dvec3 position {};
+        glm::dvec3 previous {};
+        // Blocks per tick
+        glm::dvec3 velocity {};
+        bool on_ground = false;
+    } m_player;
+
     struct {
         struct {
             input::input_ref xn;
@@ -50,7 +81,8 @@ std::unique_ptr<game> game::create(application &app) {
 }
 
 game_impl::game_impl(application &app)
-: m_cvar_manager(app.cvar_manager())
+: m_app(app)
+, m_cvar_manager(app.cvar_manager())
 , m_input_manager(app.input_manager())
 , m_renderer(app.renderer())
 , m_input {
@@ -79,6 +111,43 @@ game_impl::game_impl(application &app)
     m_input_manager.bind_keyboard(SDL_SCANCODE_SPACE, m_input.jump);
     m_input_manager.bind_keyboard(SDL_SCANCODE_LSHIFT, m_input.sneak);
 
+    cvar::cvar &chunk_budget = m_cvar_manager.create("cl_chunk_budget", 2048, "Memory for loaded chunk columns in MiB, 0 for unlimited",
+            [this](float value) {
+        if (value < 0.f)
+            return false;
+        set_chunk_memory_budget(static_cast<size_t>(value) * 1024 * 1024);
+        return true;
+    });
+    set_chunk_memory_budget(static_cast<size_t>(chunk_budget.value()) * 1024 * 1024);
+
+    cvar::cvar &biome_blend = m_cvar_manager.create("cl_biome_blend", world::biome_blender::DEFAULT_RADIUS,
+            "Radius in blocks that grass, foliage and water colours are blended over",
+            [this](float value) {
+        if (value < 0.f || value > world::biome_blender::MAX_RADIUS)
+            return false;
+        set_biome_blend_radius(static_cast<int>(value));
+        return true;
+    });
+    set_biome_blend_radius(static_cast<int>(biome_blend.value()));
+
+    cvar::cvar &light_budget = m_cvar_manager.create("cl_light_budget", world::light_engine::DEFAULT_BUDGET,
+            "Light propagation steps per frame after blocks change, 0 for unlimited",
+            [this](float value) {
+        if (value < 0.f)
+            return false;
+        m_light_budget = static_cast<size_t>(value);
+        return true;
+    });
+    m_light_budget = static_cast<size_t>(light_budget.value());
+    set_client_light(true);
+
+    cvar::cvar &noclip = m_cvar_manager.create("cl_noclip", 0, "Fly through blocks instead of walking",
+            [this](float value) {
+        m_noclip = value != 0.f;
+        return true;
+    });
+    m_noclip = noclip.value() != 0.f;
+
     m_frame_last = std::chrono::steady_clock::now();
 }
 
@@ -112,14 +181,46 @@ void game_impl::on_frame() {
         move = glm::normalize(move);
     }
 
-    camera_position.x += MOVE_SPEED * move.y * m_frame_time;
-    camera_position.z += MOVE_SPEED * move.x * m_frame_time;
-    float fly = 0.f;
-    if (m_input.jump->pressed())
-        fly += 1.f;
-    if (m_input.sneak->pressed())
-        fly -= 1.f;
-    camera_position.y += MOVE_SPEED * fly * m_frame_time;
+    // walking needs the column under the player, until it's loaded the
+    // camera flies as with noclip
+    glm::ivec3 block { glm::floor(m_player.position) };
+    bool walking = !m_noclip && has_world() && world().chunks().try_get(block.x >> 4, block.z >> 4);
+
+    m_tick_time += m_frame_time;
+    // after a hitch rather drop ticks than spend frames catching up
+    m_tick_time = std::min(m_tick_time, 10 * TICK_TIME);
+    while (m_tick_time >= TICK_TIME) {
+        m_tick_time -= TICK_TIME;
+        if (has_world())
+            world().entities().tick();
+        if (walking)
+            tick_player({ move.y, 0., move.x }, m_input.jump->pressed());
+    }
+    double partial_tick = m_tick_time / TICK_TIME;
+    if (has_world()) {
+        world().entities().interpolate(partial_tick);
+        // blocks changed by packets since the last frame
+        world().update_light(m_light_budget == 0 ? SIZE_MAX : m_light_budget);
+    }
+
+    if (walking) {
+        glm::dvec3 feet = glm::mix(m_player.previous, m_player.position, partial_tick);
+        camera_position = glm::vec3 { feet } + glm::vec3 { 0.f, PLAYER_EYE_HEIGHT, 0.f };
+    } else {
+        camera_position.x += MOVE_SPEED * move.y * m_frame_time;
+        camera_position.z += MOVE_SPEED * move.x * m_frame_time;
+        float fly = 0.f;
+        if (m_input.jump->pressed())
+            fly += 1.f;
+        if (m_input.sneak->pressed())
+            fly -= 1.f;
+        camera_position.y += MOVE_SPEED * fly * m_frame_time;
+
+        m_player.position = glm::dvec3 { camera_position } - glm::dvec3 { 0., PLAYER_EYE_HEIGHT, 0. };
+        m_player.previous = m_player.position;
+        m_player.velocity = {};
+        m_player.on_ground = false;
+    }
 
     ImGui::SetNextWindowPos(ImVec2{0, 0}, ImGuiCond_Always, {0, 0});
     if (ImGui::Begin("##DebugTopLeft", nullptr,
@@ -129,6 +230,9 @@ void game_impl::on_frame() {
             ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoBringToFrontOnFocus))
     {
         ImGui::Text("%.0f fps %.3f ms", 1 / m_frame_time, m_frame_time * 1000.f);
+        draw_chunk_stats();
+        if (has_world())
+            ImGui::Text("entities: %zu", world().entities().size());
 
         ImGui::Text("move : %f, %f", move.x, move.y);
         ImGui::Text("move_input : %f, %f", move_input.x, move_input.y);
@@ -171,9 +275,98 @@ void game_impl::on_frame() {
         }
     }
 
+    if (ImGui::CollapsingHeader("Packets")) {
+        draw_packet_stats();
+    }
+
     auto now = std::chrono::steady_clock::now();
     m_frame_time = std::chrono::duration_cast<std::chrono::duration<float>>(now - m_frame_last).count();
     m_frame_last = now;
 }
 
+void game_impl::tick_player(glm::dvec3 move, bool jump) {
+    // the vanilla constants for a player walking on ordinary blocks
+    const double STEP_HEIGHT = 0.6;
+    const double GRAVITY = 0.08;
+    const double AIR_DRAG = 0.98;
+    const double SLIPPERINESS = 0.6;
+    const double WALK_SPEED = 0.1;
+    const double AIR_SPEED = 0.02;
+    const double JUMP_VELOCITY = 0.42;
+
+    m_player.previous = m_player.position;
+    glm::dvec3 &velocity = m_player.velocity;
+    for (int a = 0; a < 3; a++) {
+        if (std::abs(velocity[a]) < 0.003)
+            velocity[a] = 0.;
+    }
+    if (jump && m_player.on_ground)
+        velocity.y = JUMP_VELOCITY;
+
+    double friction = m_player.on_ground ? SLIPPERINESS * 0.91 : 0.91;
+    double speed = m_player.on_ground ? WALK_SPEED * (0.21600002 / (SLIPPERINESS * SLIPPERINESS * SLIPPERINESS)) : AIR_SPEED;
+    velocity += move * 0.98 * speed;
+
+    glm::dvec3 half { PLAYER_WIDTH / 2., 0., PLAYER_WIDTH / 2. };
+    world::aabb box { m_player.position - half, m_player.position + half + glm::dvec3 { 0., PLAYER_HEIGHT, 0. } };
+    world::move_result result = collider().move(box, velocity, STEP_HEIGHT, m_player.on_ground);
+    m_player.position += result.motion;
+    m_player.on_ground = result.on_ground;
+
+    // blocked axes lose their velocity
+    if (result.motion.x != velocity.x)
+        velocity.x = 0.;
+    if (result.motion.z != velocity.z)
+        velocity.z = 0.;
+    if (result.collided_vertically)
+        velocity.y = 0.;
+
+    velocity.y = (velocity.y - GRAVITY) * AIR_DRAG;
+    velocity.x *= friction;
+    velocity.z *= friction;
+}
+
+void game_impl::draw_chunk_stats() {
+    if (!has_world())
+        return;
+    world::chunk_stats stats = world().chunks().stats();
+    ImGui::Text("chunks: %zu (%zu overflow) %.1f / %.0f MiB", stats.columns, stats.overflow,
+                stats.bytes / 1024. / 1024., stats.budget / 1024. / 1024.);
+    ImGui::Text("evicted: %llu  forgotten: %llu", static_cast<unsigned long long>(stats.evicted),
+                static_cast<unsigned long long>(stats.forgotten));
+}
+
+void game_impl::draw_packet_stats() {
+    using namespace proto::generated;
+    using us = std::chrono::duration<double, std::micro>;
+
+    if (!ImGui::BeginTable("##PacketStats", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+        return;
+    ImGui::TableSetupColumn("packet");
+    ImGui::TableSetupColumn("count");
+    ImGui::TableSetupColumn("KiB");
+    ImGui::TableSetupColumn("avg us");
+    ImGui::TableHeadersRow();
+
+    const client::packet_stats_table &table = m_app.client().packet_stats();
+    for (size_t state = 0; state < table.size(); state++) {
+        for (size_t id = 0; id < table[state].size(); id++) {
+            const client::packet_type_stats &stats = table[state][id];
+            if (!stats.count)
+                continue;
+            std::string_view name = client::packet_name(connection_state(state), id);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(name.data(), name.data() + name.size());
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(stats.count));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", stats.bytes / 1024.);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", us(stats.decode_time).count() / stats.count);
+        }
+    }
+    ImGui::EndTable();
+}
+
 }
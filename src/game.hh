@@ -3,6 +3,7 @@
 #include <memory>
 
 #include "application.hh"
+#include "world/collision.hh"
 #include "world/world.hh"
 
 namespace mccpp {
@@ -13,19 +14,61 @@ public:
 
     static std::unique_ptr<game> create(application &);
 
-    world::world &create_world(size_t height) {
-        return m_world.emplace(height);
+    world::world &create_world(int32_t min_y, size_t height, std::vector<world::biome> biomes) {
+        m_collider.reset();
+        world::world &world = m_world.emplace(min_y, height, std::move(biomes));
+        world.chunks().set_memory_budget(m_chunk_memory_budget);
+        world.set_biome_blend_radius(m_biome_blend_radius);
+        world.set_collision_shapes(world::collision_shapes::baked());
+        if (m_client_light)
+            world.light().set_properties(world::light_engine::baked_properties());
+        m_collider.emplace(world, world::collision_shapes::baked());
+        return world;
+    }
+
+    bool has_world() const {
+        return m_world.has_value();
     }
 
     world::world &world() {
         return m_world.value();
     }
 
+    // Collision against the current world, keeps the boxes around the
+    // player between ticks
+    world::collider &collider() {
+        return m_collider.value();
+    }
+
+    // Applies to the current and all later worlds, 0 for unlimited
+    void set_chunk_memory_budget(size_t bytes) {
+        m_chunk_memory_budget = bytes;
+        if (m_world)
+            m_world->chunks().set_memory_budget(bytes);
+    }
+
+    // Applies to the current and all later worlds
+    void set_biome_blend_radius(int radius) {
+        m_biome_blend_radius = radius;
+        if (m_world)
+            m_world->set_biome_blend_radius(radius);
+    }
+
+    // Whether later worlds update their light after block changes instead
+    // of waiting for the server to send it
+    void set_client_light(bool enabled) {
+        m_client_light = enabled;
+    }
+
     virtual void on_frame() = 0;
     virtual float delta_time() = 0;
 
 private:
     std::optional<world::world> m_world;
+    std::optional<world::collider> m_collider;
+    size_t m_chunk_memory_budget = 0;
+    int m_biome_blend_radius = world::biome_blender::DEFAULT_RADIUS;
+    bool m_client_light = false;
 };
 
 }
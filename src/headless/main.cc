@@ -0,0 +1,98 @@
+// Headless load testing client, runs many independent client sessions
+// against a single server without SDL, OpenGL or ImGui
+
+#include <chrono>
+#include <csignal>
+#include <string_view>
+
+#include <asio.hpp>
+
+#include "../logger.hh"
+#include "session.hh"
+
+namespace mccpp::headless {
+
+struct options {
+    std::string address = "127.0.0.1";
+    uint16_t port = 25565;
+    size_t sessions = 1;
+    size_t threads = 1;
+    unsigned seconds = 30;
+    bool store_chunks = true;
+    // records the inbound stream of the first session for mccpp-replay
+    std::string capture;
+};
+
+static bool parse_options(int argc, char **argv, options &opts) {
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--no-chunks") {
+            opts.store_chunks = false;
+            continue;
+        }
+        if (i + 1 >= argc)
+            return false;
+        std::string_view value = argv[++i];
+        bool ok;
+        if (arg == "--address") {
+            opts.address = value;
+            ok = true;
+        } else if (arg == "--port") {
+            ok = parse_number(value, opts.port);
+        } else if (arg == "--sessions") {
+            ok = parse_number(value, opts.sessions) && opts.sessions > 0;
+        } else if (arg == "--threads") {
+            ok = parse_number(value, opts.threads) && opts.threads > 0;
+        } else if (arg == "--seconds") {
+            ok = parse_number(value, opts.seconds);
+        } else if (arg == "--capture") {
+            opts.capture = value;
+            ok = true;
+        } else {
+            ok = false;
+        }
+        if (!ok)
+            return false;
+    }
+    return true;
+}
+
+static int main(int argc, char **argv) {
+    logger::set_thread_name("main");
+
+    options opts {};
+    if (!parse_options(argc, argv, opts)) {
+        MCCPP_E("Usage: {} [--address ADDRESS] [--port PORT] [--sessions N] [--threads N] [--seconds N] [--no-chunks] [--capture FILE]", argv[0]);
+        return 1;
+    }
+
+    asio::io_context io(opts.threads);
+
+    std::unique_ptr<proto::capture_writer> capture {};
+    if (!opts.capture.empty()) {
+        capture = std::make_unique<proto::capture_writer>(opts.capture);
+    }
+    session_list sessions = start_sessions(io, opts.sessions, opts.address, opts.port, opts.store_chunks,
+                                           std::move(capture));
+    MCCPP_I("Started {} sessions on {} threads to {}:{}", opts.sessions, opts.threads, opts.address, opts.port);
+
+    asio::steady_timer timer(io, std::chrono::seconds(opts.seconds));
+    timer.async_wait([&io](const asio::error_code &) {
+        io.stop();
+    });
+    asio::signal_set signals(io, SIGINT, SIGTERM);
+    signals.async_wait([&io](const asio::error_code &, int) {
+        io.stop();
+    });
+
+    double seconds = run_threads(io, opts.threads);
+
+    report(sessions, seconds);
+    return 0;
+}
+
+}
+
+int main(int argc, char **argv) {
+    return mccpp::headless::main(argc, argv);
+}
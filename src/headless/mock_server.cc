@@ -0,0 +1,590 @@
+// Minimal local server for measuring the client side of the protocol without
+// a real server in the way. It accepts status and login, optionally enables
+// compression, then streams pre-encoded terrain chunks around spawn in a loop
+// at a fixed rate. With --clients it also runs headless sessions against
+// itself and reports how fast they decode.
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <csignal>
+#include <string_view>
+#include <thread>
+
+#include <asio.hpp>
+
+#include "../PerlinNoise.hpp"
+#include "../logger.hh"
+#include "../nbt.hh"
+#include "../proto/compression.hh"
+#include "generated/proto/clientbound/types.hh"
+#include "generated/proto/serverbound/types.hh"
+#include "session.hh"
+
+namespace mccpp::headless {
+
+using asio::ip::tcp;
+template<typename T>
+using awaitable = asio::awaitable<T>;
+using asio::use_awaitable;
+
+struct options {
+    uint16_t port = 25565;
+    // -1 disables compression
+    int32_t compression = 256;
+    // columns are sent in a square of this radius around 0, 0
+    int32_t radius = 8;
+    // chunks per second and connection, 0 for as fast as possible
+    unsigned rate = 0;
+    // in-process headless sessions, the server runs until stopped without any
+    size_t clients = 0;
+    size_t threads = 1;
+    unsigned seconds = 10;
+};
+
+static bool parse_options(int argc, char **argv, options &opts) {
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (i + 1 >= argc)
+            return false;
+        std::string_view value = argv[++i];
+        bool ok;
+        if (arg == "--port") {
+            ok = parse_number(value, opts.port);
+        } else if (arg == "--compression") {
+            ok = parse_number(value, opts.compression) && opts.compression >= -1;
+        } else if (arg == "--radius") {
+            ok = parse_number(value, opts.radius) && opts.radius >= 0 && opts.radius <= 64;
+        } else if (arg == "--rate") {
+            ok = parse_number(value, opts.rate);
+        } else if (arg == "--clients") {
+            ok = parse_number(value, opts.clients);
+        } else if (arg == "--threads") {
+            ok = parse_number(value, opts.threads) && opts.threads > 0;
+        } else if (arg == "--seconds") {
+            ok = parse_number(value, opts.seconds);
+        } else {
+            ok = false;
+        }
+        if (!ok)
+            return false;
+    }
+    return true;
+}
+
+// 1.19.3 overworld
+constexpr int32_t MIN_Y = -64;
+constexpr int32_t HEIGHT = 384;
+constexpr int32_t SECTION_COUNT = HEIGHT / 16;
+
+// global palette ids
+enum block_state : int32_t {
+    AIR = 0,
+    STONE = 1,
+    GRASS_BLOCK = 9,
+    DIRT = 10,
+    BEDROCK = 79,
+};
+
+class terrain {
+public:
+    explicit terrain(siv::PerlinNoise::seed_type seed)
+    : m_perlin(seed)
+    {}
+
+    // y of the topmost solid block
+    int32_t surface(int32_t x, int32_t z) const {
+        constexpr double scale = 0.01;
+        return 40 + int32_t(m_perlin.octave2D_01(x * scale, z * scale, 4) * 80.);
+    }
+
+    static block_state block_at(int32_t y, int32_t surface) {
+        if (y == MIN_Y)
+            return BEDROCK;
+        if (y > surface)
+            return AIR;
+        if (y == surface)
+            return GRASS_BLOCK;
+        if (y > surface - 4)
+            return DIRT;
+        return STONE;
+    }
+
+private:
+    siv::PerlinNoise m_perlin;
+};
+
+// https://wiki.vg/index.php?title=Chunk_Format&oldid=17949#Paletted_Container_structure
+static void write_block_states(proto::packet_writer &w, const std::array<block_state, 4096> &blocks) {
+    std::vector<int32_t> palette {};
+    std::array<uint8_t, 4096> indices;
+    for (size_t i = 0; i < blocks.size(); i++) {
+        auto iter = std::find(palette.begin(), palette.end(), blocks[i]);
+        if (iter == palette.end()) {
+            iter = palette.emplace(palette.end(), blocks[i]);
+        }
+        indices[i] = iter - palette.begin();
+    }
+
+    if (palette.size() == 1) {
+        w.write_u8(0);
+        w.write_varint(palette[0]);
+        w.write_varint(0);
+        return;
+    }
+
+    unsigned bits = std::max<unsigned>(4, std::bit_width(palette.size() - 1));
+    w.write_u8(bits);
+    w.write_varint(palette.size());
+    for (int32_t id : palette) {
+        w.write_varint(id);
+    }
+
+    // entries don't span across longs
+    unsigned per_long = 64 / bits;
+    size_t longs = (indices.size() + per_long - 1) / per_long;
+    w.write_varint(longs);
+    for (size_t i = 0; i < longs; i++) {
+        uint64_t value = 0;
+        for (unsigned j = 0; j < per_long && i * per_long + j < indices.size(); j++) {
+            value |= uint64_t(indices[i * per_long + j]) << (j * bits);
+        }
+        w.write_u64(value);
+    }
+}
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Chunk_Data_and_Update_Light
+static std::vector<std::byte> encode_chunk(const terrain &t, int32_t chunk_x, int32_t chunk_z) {
+    std::array<int32_t, 256> surface;
+    for (int32_t z = 0; z < 16; z++) {
+        for (int32_t x = 0; x < 16; x++) {
+            surface[z * 16 + x] = t.surface(chunk_x * 16 + x, chunk_z * 16 + z);
+        }
+    }
+
+    proto::packet_writer w {};
+    w.write_varint(proto::generated::clientbound::play::level_chunk_with_light_packet::id);
+    w.write_i32(chunk_x);
+    w.write_i32(chunk_z);
+
+    // 9 bits per column, 7 columns per long
+    std::vector<int64_t> heightmap((256 + 6) / 7, 0);
+    for (size_t i = 0; i < 256; i++) {
+        uint64_t height = surface[i] - MIN_Y + 1;
+        heightmap[i / 7] |= int64_t(height << (i % 7 * 9));
+    }
+    nbt::writer heightmaps { w };
+    heightmaps.begin_compound();
+    heightmaps.write_long_array("MOTION_BLOCKING", heightmap);
+    heightmaps.write_long_array("WORLD_SURFACE", heightmap);
+    heightmaps.end_compound();
+
+    proto::packet_writer data {};
+    std::array<block_state, 4096> blocks;
+    for (int32_t section = 0; section < SECTION_COUNT; section++) {
+        int16_t block_count = 0;
+        for (int32_t y = 0; y < 16; y++) {
+            for (int32_t z = 0; z < 16; z++) {
+                for (int32_t x = 0; x < 16; x++) {
+                    block_state b = terrain::block_at(MIN_Y + section * 16 + y, surface[z * 16 + x]);
+                    blocks[(y * 16 + z) * 16 + x] = b;
+                    block_count += b != AIR;
+                }
+            }
+        }
+        data.write_i16(block_count);
+        write_block_states(data, blocks);
+        // biomes, a single plains
+        data.write_u8(0);
+        data.write_varint(0);
+        data.write_varint(0);
+    }
+    std::span<const std::byte> data_bytes = data;
+    w.write_varint(data_bytes.size());
+    w.write_bytes(data_bytes);
+
+    // block entities
+    w.write_varint(0);
+    // trust edges
+    w.write_bool(true);
+
+    // sky light for every section plus one below and above, no block light
+    constexpr int32_t LIGHT_SECTIONS = SECTION_COUNT + 2;
+    constexpr uint64_t LIGHT_MASK = (uint64_t(1) << LIGHT_SECTIONS) - 1;
+    w.write_varint(1);
+    w.write_u64(LIGHT_MASK);
+    w.write_varint(0);
+    w.write_varint(0);
+    w.write_varint(1);
+    w.write_u64(LIGHT_MASK);
+
+    w.write_varint(LIGHT_SECTIONS);
+    for (int32_t section = -1; section <= SECTION_COUNT; section++) {
+        std::array<std::byte, 2048> light {};
+        for (int32_t i = 0; i < 4096; i++) {
+            int32_t y = MIN_Y + section * 16 + i / 256;
+            int32_t column = i % 256;
+            uint8_t level = y > surface[column] ? 15 : 0;
+            light[i / 2] |= std::byte(i % 2 == 0 ? level : level << 4);
+        }
+        w.write_varint(light.size());
+        w.write_bytes(light);
+    }
+    w.write_varint(0);
+
+    return std::vector<std::byte>(std::span<const std::byte>(w).begin(), std::span<const std::byte>(w).end());
+}
+
+// Frames for every column in the radius, closest first so clients see
+// something useful right away
+static std::vector<std::vector<std::byte>> encode_world(const options &opts) {
+    std::vector<std::pair<int32_t, int32_t>> positions {};
+    for (int32_t z = -opts.radius; z <= opts.radius; z++) {
+        for (int32_t x = -opts.radius; x <= opts.radius; x++) {
+            positions.emplace_back(x, z);
+        }
+    }
+    std::stable_sort(positions.begin(), positions.end(), [](auto a, auto b) {
+        return a.first * a.first + a.second * a.second < b.first * b.first + b.second * b.second;
+    });
+
+    terrain t { 123456u };
+    std::vector<std::vector<std::byte>> frames {};
+    frames.reserve(positions.size());
+    size_t body_bytes = 0;
+    size_t frame_bytes = 0;
+    for (auto [x, z] : positions) {
+        std::vector<std::byte> body = encode_chunk(t, x, z);
+        body_bytes += body.size();
+        frames.emplace_back(proto::encode_frame(body, opts.compression));
+        frame_bytes += frames.back().size();
+    }
+    MCCPP_I("Encoded {} chunks, {:.1f} KiB per chunk, {:.1f} KiB on the wire",
+            frames.size(), body_bytes / 1024. / frames.size(), frame_bytes / 1024. / frames.size());
+    return frames;
+}
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Login_.28play.29
+static std::vector<std::byte> encode_login() {
+    proto::packet_writer w {};
+    w.write_varint(proto::generated::clientbound::play::login_packet::id);
+    w.write_i32(1);
+    w.write_bool(false);
+    w.write_u8(1);
+    w.write_i8(-1);
+    w.write_varint(1);
+    w.write_identifier("minecraft:overworld");
+
+    nbt::writer codec { w };
+    codec.begin_compound();
+
+    codec.begin_compound("minecraft:dimension_type");
+    codec.write_string("type", "minecraft:dimension_type");
+    codec.begin_list("value", nbt::TAG_COMPOUND, 1);
+    codec.begin_compound();
+    codec.write_string("name", "minecraft:overworld");
+    codec.write_int("id", 0);
+    codec.begin_compound("element");
+    codec.write_byte("piglin_safe", 0);
+    codec.write_byte("has_raids", 1);
+    codec.write_int("monster_spawn_light_level", 0);
+    codec.write_int("monster_spawn_block_light_limit", 0);
+    codec.write_byte("natural", 1);
+    codec.write_float("ambient_light", 0.f);
+    codec.write_string("infiniburn", "#minecraft:infiniburn_overworld");
+    codec.write_byte("respawn_anchor_works", 0);
+    codec.write_byte("has_skylight", 1);
+    codec.write_byte("bed_works", 1);
+    codec.write_string("effects", "minecraft:overworld");
+    codec.write_int("min_y", MIN_Y);
+    codec.write_int("height", HEIGHT);
+    codec.write_int("logical_height", HEIGHT);
+    codec.write_double("coordinate_scale", 1.);
+    codec.write_byte("ultrawarm", 0);
+    codec.write_byte("has_ceiling", 0);
+    codec.end_compound();
+    codec.end_compound();
+    codec.end_list();
+    codec.end_compound();
+
+    codec.begin_compound("minecraft:worldgen/biome");
+    codec.write_string("type", "minecraft:worldgen/biome");
+    codec.begin_list("value", nbt::TAG_COMPOUND, 1);
+    codec.begin_compound();
+    codec.write_string("name", "minecraft:plains");
+    codec.write_int("id", 0);
+    codec.begin_compound("element");
+    codec.write_string("precipitation", "rain");
+    codec.write_float("temperature", 0.8f);
+    codec.write_float("downfall", 0.4f);
+    codec.begin_compound("effects");
+    codec.write_int("sky_color", 7907327);
+    codec.write_int("water_fog_color", 329011);
+    codec.write_int("fog_color", 12638463);
+    codec.write_int("water_color", 4159204);
+    codec.end_compound();
+    codec.end_compound();
+    codec.end_compound();
+    codec.end_list();
+    codec.end_compound();
+
+    codec.begin_compound("minecraft:chat_type");
+    codec.write_string("type", "minecraft:chat_type");
+    codec.begin_list("value", nbt::TAG_END, 0);
+    codec.end_list();
+    codec.end_compound();
+
+    codec.end_compound();
+
+    w.write_identifier("minecraft:overworld");
+    w.write_identifier("minecraft:overworld");
+    w.write_i64(0);
+    w.write_varint(20);
+    w.write_varint(10);
+    w.write_varint(10);
+    w.write_bool(false);
+    w.write_bool(true);
+    w.write_bool(false);
+    w.write_bool(false);
+    w.write_bool(false);
+
+    return std::vector<std::byte>(std::span<const std::byte>(w).begin(), std::span<const std::byte>(w).end());
+}
+
+class connection {
+public:
+    explicit connection(tcp::socket &&socket)
+    : m_socket(std::move(socket))
+    {}
+
+    tcp::socket &socket() { return m_socket; }
+
+    void enable_compression(int32_t threshold) {
+        m_compression_threshold = threshold;
+    }
+
+    awaitable<int32_t> read_varint() {
+        uint32_t value = 0;
+        for (unsigned position = 0; position < 35; position += 7) {
+            uint8_t byte;
+            co_await asio::async_read(m_socket, asio::buffer(&byte, 1), use_awaitable);
+            value |= uint32_t(byte & 0x7f) << position;
+            if ((byte & 0x80) == 0)
+                co_return std::bit_cast<int32_t>(value);
+        }
+        throw proto::decode_error("invalid varint");
+    }
+
+    // Reads a whole packet, decompressed when compression is on, the packet
+    // id is still the first varint of the returned bytes
+    awaitable<std::vector<std::byte>> read_packet() {
+        int32_t length = co_await read_varint();
+        if (length <= 0 || length > 2097151)
+            throw proto::decode_error("invalid packet length");
+        std::vector<std::byte> packet(length);
+        co_await asio::async_read(m_socket, asio::buffer(packet), use_awaitable);
+        if (m_compression_threshold >= 0) {
+            packet = proto::decompress_frame(std::move(packet));
+        }
+        co_return packet;
+    }
+
+    awaitable<void> send(std::span<const std::byte> body) {
+        std::vector<std::byte> frame = proto::encode_frame(body, m_compression_threshold);
+        co_await send_frame(frame);
+    }
+
+    awaitable<void> send_frame(std::span<const std::byte> frame) {
+        co_await asio::async_write(m_socket, asio::buffer(frame.data(), frame.size()), use_awaitable);
+    }
+
+    awaitable<void> send(const proto::packet_writer &w) {
+        co_await send(std::span<const std::byte>(w));
+    }
+
+private:
+    tcp::socket m_socket;
+    int32_t m_compression_threshold = -1;
+};
+
+struct server_state {
+    const options &opts;
+    std::vector<std::vector<std::byte>> chunk_frames;
+    std::vector<std::byte> login;
+};
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Status
+static awaitable<void> serve_status(connection &conn) {
+    using namespace proto::generated;
+    for (;;) {
+        std::vector<std::byte> packet = co_await conn.read_packet();
+        proto::packet_reader s { packet };
+        int32_t id = s.read_varint();
+        proto::packet_writer w {};
+        if (id == serverbound::status::status_request_packet::id) {
+            w.write_varint(clientbound::status::status_response_packet::id);
+            w.write_string<32767>(R"({"version":{"name":"1.19.3","protocol":761},)"
+                                  R"("players":{"max":20,"online":0},"description":{"text":"mccpp mock server"}})");
+        } else if (id == serverbound::status::ping_request_packet::id) {
+            w.write_varint(clientbound::status::pong_response_packet::id);
+            w.write_i64(s.read_i64());
+        } else {
+            throw proto::protocol_error("unexpected status packet");
+        }
+        co_await conn.send(w);
+    }
+}
+
+// Anything the client sends during play is ignored, but it has to be read
+// so the client never blocks on a full socket
+static awaitable<void> drain(std::shared_ptr<connection> conn) {
+    std::vector<std::byte> discard(4096);
+    for (;;) {
+        co_await conn->socket().async_read_some(asio::buffer(discard), use_awaitable);
+    }
+}
+
+static awaitable<void> stream_chunks(connection &conn, const server_state &state) {
+    using clock = std::chrono::steady_clock;
+    asio::steady_timer timer(conn.socket().get_executor());
+    clock::duration period = state.opts.rate == 0
+        ? clock::duration::zero()
+        : std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1. / state.opts.rate));
+    clock::time_point next = clock::now();
+    for (;;) {
+        for (const std::vector<std::byte> &frame : state.chunk_frames) {
+            if (period != clock::duration::zero()) {
+                next += period;
+                timer.expires_at(next);
+                co_await timer.async_wait(use_awaitable);
+            }
+            co_await conn.send_frame(frame);
+        }
+    }
+}
+
+static awaitable<void> serve(tcp::socket socket, const server_state &state) {
+    using namespace proto::generated;
+    socket.set_option(tcp::no_delay(true));
+    // shared with drain() which may outlive this coroutine
+    auto shared_conn = std::make_shared<connection>(std::move(socket));
+    connection &conn = *shared_conn;
+
+    // https://wiki.vg/index.php?title=Protocol&oldid=17979#Handshake
+    std::vector<std::byte> handshake = co_await conn.read_packet();
+    proto::packet_reader s { handshake };
+    if (s.read_varint() != serverbound::handshaking::client_intention_packet::id)
+        throw proto::protocol_error("expected a handshake");
+    /* protocol_version */ s.read_varint();
+    /* server_address */ s.read_string<255>();
+    /* server_port */ s.read_u16();
+    int32_t next_state = s.read_varint();
+    if (next_state == int32_t(connection_state::STATUS)) {
+        co_await serve_status(conn);
+        co_return;
+    }
+    if (next_state != int32_t(connection_state::LOGIN))
+        throw proto::protocol_error("invalid next state");
+
+    // https://wiki.vg/index.php?title=Protocol&oldid=17979#Login_Start
+    std::vector<std::byte> hello = co_await conn.read_packet();
+    s = proto::packet_reader { hello };
+    if (s.read_varint() != serverbound::login::hello_packet::id)
+        throw proto::protocol_error("expected login start");
+    std::string name = s.read_string<16>();
+    MCCPP_D("{} logging in", name);
+
+    if (state.opts.compression >= 0) {
+        proto::packet_writer w {};
+        w.write_varint(clientbound::login::login_compression_packet::id);
+        w.write_varint(state.opts.compression);
+        co_await conn.send(w);
+        conn.enable_compression(state.opts.compression);
+    }
+
+    {
+        proto::packet_writer w {};
+        w.write_varint(clientbound::login::game_profile_packet::id);
+        w.write_uuid({});
+        w.write_string<16>(name);
+        w.write_varint(0);
+        co_await conn.send(w);
+    }
+
+    co_await conn.send(state.login);
+
+    asio::co_spawn(conn.socket().get_executor(), drain(shared_conn), asio::detached);
+    co_await stream_chunks(conn, state);
+}
+
+static awaitable<void> listen(tcp::acceptor &acceptor, const server_state &state) {
+    for (;;) {
+        tcp::socket socket = co_await acceptor.async_accept(use_awaitable);
+        asio::co_spawn(acceptor.get_executor(), serve(std::move(socket), state),
+                       [](std::exception_ptr e) {
+            try {
+                if (e)
+                    std::rethrow_exception(e);
+            } catch (const std::exception &e) {
+                MCCPP_D("connection closed: {}", e.what());
+            }
+        });
+    }
+}
+
+static int main(int argc, char **argv) {
+    logger::set_thread_name("main");
+
+    options opts {};
+    if (!parse_options(argc, argv, opts)) {
+        MCCPP_E("Usage: {} [--port PORT] [--compression THRESHOLD] [--radius N] [--rate CHUNKS_PER_SECOND] "
+                "[--clients N] [--threads N] [--seconds N]", argv[0]);
+        return 1;
+    }
+
+    server_state state { opts, encode_world(opts), encode_login() };
+
+    asio::io_context server_io(1);
+    tcp::acceptor acceptor(server_io, { asio::ip::address_v4::loopback(), opts.port });
+    asio::co_spawn(server_io, listen(acceptor, state), asio::detached);
+    MCCPP_I("Listening on {}:{} with compression threshold {}, {} chunks/s",
+            acceptor.local_endpoint().address().to_string(), acceptor.local_endpoint().port(),
+            opts.compression, opts.rate);
+
+    if (opts.clients == 0) {
+        asio::signal_set signals(server_io, SIGINT, SIGTERM);
+        signals.async_wait([&server_io](const asio::error_code &, int) {
+            server_io.stop();
+        });
+        server_io.run();
+        return 0;
+    }
+
+    std::thread server_thread([&server_io] {
+        logger::set_thread_name("server");
+        server_io.run();
+    });
+
+    asio::io_context io(opts.threads);
+    session_list sessions = start_sessions(io, opts.clients, "127.0.0.1", acceptor.local_endpoint().port(), true);
+    asio::steady_timer timer(io, std::chrono::seconds(opts.seconds));
+    timer.async_wait([&io](const asio::error_code &) {
+        io.stop();
+    });
+    asio::signal_set signals(io, SIGINT, SIGTERM);
+    signals.async_wait([&io](const asio::error_code &, int) {
+        io.stop();
+    });
+    double seconds = run_threads(io, opts.threads);
+    report(sessions, seconds);
+
+    server_io.stop();
+    server_thread.join();
+    return 0;
+}
+
+}
+
+int main(int argc, char **argv) {
+    return mccpp::headless::main(argc, argv);
+}
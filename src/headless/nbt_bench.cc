@@ -0,0 +1,177 @@
+// Compares nbt::skip, nbt::document and building an nbt::nbt tree on the NBT
+// found in the chunk packets of a capture recorded with mccpp-headless
+// --capture, that is the heightmaps and block entity data.
+
+#include <chrono>
+#include <string_view>
+
+#include "../logger.hh"
+#include "../nbt.hh"
+#include "../nbt_document.hh"
+#include "../proto/capture.hh"
+#include "../proto/compression.hh"
+#include "../proto/varint.hh"
+#include "generated/proto/clientbound/types.hh"
+#include "session.hh"
+
+namespace mccpp::headless {
+
+struct options {
+    std::string path;
+    unsigned iterations = 20;
+};
+
+static bool parse_options(int argc, char **argv, options &opts) {
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--iterations") {
+            if (i + 1 >= argc || !parse_number(argv[++i], opts.iterations) || opts.iterations == 0)
+                return false;
+        } else if (opts.path.empty() && !arg.starts_with("--")) {
+            opts.path = arg;
+        } else {
+            return false;
+        }
+    }
+    return !opts.path.empty();
+}
+
+// Frames the captured stream the same way proto::client does and returns the
+// bodies of all chunk packets. Captures never contain encrypted sessions.
+static std::vector<std::vector<std::byte>> chunk_packets(const std::vector<proto::capture_record> &records) {
+    using namespace proto::generated::clientbound;
+
+    std::vector<std::byte> stream {};
+    for (const proto::capture_record &record : records) {
+        stream.insert(stream.end(), record.data.begin(), record.data.end());
+    }
+
+    std::vector<std::vector<std::byte>> packets {};
+    int32_t compression_threshold = -1;
+    bool play = false;
+    size_t offset = 0;
+    while (offset < stream.size()) {
+        int32_t length = proto::varint::read([&]() {
+            if (offset >= stream.size())
+                throw proto::decode_error("truncated capture");
+            return stream[offset++];
+        });
+        if (length <= 0 || static_cast<size_t>(length) > stream.size() - offset)
+            break;
+        std::vector<std::byte> body(stream.begin() + offset, stream.begin() + offset + length);
+        offset += length;
+        if (compression_threshold >= 0)
+            body = proto::decompress_frame(std::move(body));
+
+        proto::packet_reader reader { body };
+        int32_t packet_id = reader.read_varint();
+        if (!play) {
+            if (packet_id == login::login_compression_packet::id) {
+                compression_threshold = reader.read_varint();
+            } else if (packet_id == login::game_profile_packet::id) {
+                play = true;
+            }
+        } else if (packet_id == play::level_chunk_with_light_packet::id) {
+            packets.emplace_back(std::move(body));
+        }
+    }
+    return packets;
+}
+
+// Every NBT value in a chunk packet, located with nbt::skip
+static std::vector<std::span<const std::byte>> nbt_values(const std::vector<std::byte> &packet) {
+    std::vector<std::span<const std::byte>> values {};
+    proto::packet_reader s { packet };
+    auto skip_value = [&] {
+        size_t start = packet.size() - s.remaining();
+        nbt::skip(s);
+        values.emplace_back(std::span(packet).subspan(start, packet.size() - s.remaining() - start));
+    };
+
+    s.read_varint();
+    s.read_i32();
+    s.read_i32();
+    skip_value();
+    int32_t data_size = s.read_varint();
+    s.take(data_size);
+    int32_t block_entities = s.read_varint();
+    while (block_entities-- > 0) {
+        s.read_u8();
+        s.read_i16();
+        s.read_varint();
+        skip_value();
+    }
+    return values;
+}
+
+template<typename F>
+static void measure(std::string_view name, const std::vector<std::span<const std::byte>> &values,
+                    size_t bytes, unsigned iterations, F &&parse) {
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < iterations; i++) {
+        for (std::span<const std::byte> value : values) {
+            parse(value);
+        }
+    }
+    auto finish = std::chrono::steady_clock::now();
+
+    constexpr double MB = 1024. * 1024.;
+    double seconds = std::chrono::duration<double>(finish - start).count();
+    double count = double(values.size()) * iterations;
+    MCCPP_I("{:<24} {:10.1f} ns/value {:10.1f} MB/s", name,
+            seconds * 1e9 / count, bytes * double(iterations) / MB / seconds);
+}
+
+static int main(int argc, char **argv) {
+    logger::set_thread_name("main");
+
+    options opts {};
+    if (!parse_options(argc, argv, opts)) {
+        MCCPP_E("Usage: {} [--iterations N] FILE", argv[0]);
+        return 1;
+    }
+
+    std::vector<std::vector<std::byte>> packets = chunk_packets(proto::read_capture(opts.path));
+    std::vector<std::span<const std::byte>> values {};
+    size_t bytes = 0;
+    for (const std::vector<std::byte> &packet : packets) {
+        for (std::span<const std::byte> value : nbt_values(packet)) {
+            values.emplace_back(value);
+            bytes += value.size();
+        }
+    }
+    MCCPP_I("{} chunk packets, {} NBT values, {} bytes", packets.size(), values.size(), bytes);
+    if (values.empty())
+        return 1;
+
+    measure("nbt::nbt", values, bytes, opts.iterations, [](std::span<const std::byte> value) {
+        proto::packet_reader s { value };
+        nbt::nbt tree { s };
+    });
+    measure("nbt::document", values, bytes, opts.iterations, [](std::span<const std::byte> value) {
+        proto::packet_reader s { value };
+        nbt::document document { s };
+    });
+    measure("nbt::skip", values, bytes, opts.iterations, [](std::span<const std::byte> value) {
+        proto::packet_reader s { value };
+        nbt::skip(s);
+    });
+    // how the chunk handler read before packet_reader could read from memory
+    measure("nbt::nbt byte callback", values, bytes, opts.iterations, [](std::span<const std::byte> value) {
+        const std::byte *data = value.data();
+        proto::packet_reader s { [&data] { return *data++; }, value.size() };
+        nbt::nbt tree { s };
+    });
+    measure("nbt::skip byte callback", values, bytes, opts.iterations, [](std::span<const std::byte> value) {
+        const std::byte *data = value.data();
+        proto::packet_reader s { [&data] { return *data++; }, value.size() };
+        nbt::skip(s);
+    });
+    return 0;
+}
+
+}
+
+int main(int argc, char **argv) {
+    return mccpp::headless::main(argc, argv);
+}
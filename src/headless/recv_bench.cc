@@ -0,0 +1,183 @@
+// Receive path benchmark, an in-process server writes as fast as it can to
+// N loopback connections which are drained through tcp_client. The asio
+// backend is fixed at compile time, build once with MCCPP_IO_URING=OFF and
+// once with ON to compare epoll with io_uring.
+
+#include <chrono>
+#include <algorithm>
+#include <string_view>
+#include <thread>
+
+#include <sys/resource.h>
+
+#include <asio.hpp>
+
+#include "../logger.hh"
+#include "../proto/tcp_client.hh"
+#include "session.hh"
+
+namespace mccpp::headless {
+
+using asio::ip::tcp;
+
+struct options {
+    std::vector<size_t> connections = { 1, 100, 1000 };
+    size_t threads = 1;
+    unsigned seconds = 5;
+};
+
+static bool parse_options(int argc, char **argv, options &opts) {
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (i + 1 >= argc)
+            return false;
+        std::string_view value = argv[++i];
+        bool ok = true;
+        if (arg == "--connections") {
+            opts.connections.clear();
+            while (ok && !value.empty()) {
+                size_t comma = std::min(value.find(','), value.size());
+                size_t &count = opts.connections.emplace_back();
+                ok = parse_number(value.substr(0, comma), count) && count > 0;
+                value.remove_prefix(std::min(comma + 1, value.size()));
+            }
+            ok = ok && !opts.connections.empty();
+        } else if (arg == "--threads") {
+            ok = parse_number(value, opts.threads) && opts.threads > 0;
+        } else if (arg == "--seconds") {
+            ok = parse_number(value, opts.seconds) && opts.seconds > 0;
+        } else {
+            ok = false;
+        }
+        if (!ok)
+            return false;
+    }
+    return true;
+}
+
+static std::string_view backend_name() {
+#if defined(ASIO_HAS_IO_URING) && defined(ASIO_DISABLE_EPOLL)
+    return "io_uring";
+#else
+    return "epoll";
+#endif
+}
+
+// Drains everything in blocks the size of a large chunk packet
+class receiver final : private proto::tcp_client {
+public:
+    static constexpr size_t BLOCK_SIZE = 16 * 1024;
+
+    receiver()
+    : m_task(run())
+    {}
+
+    using tcp_client::connect;
+    using tcp_client::bytes_received;
+    using tcp_client::reads_completed;
+
+private:
+    void on_tcp_error(asio::error_code error) override {
+        MCCPP_E("TCP error: {}", error.message());
+    }
+
+    void on_tcp_connect() override {
+        m_task.handle().resume();
+    }
+
+    void on_readable() override {}
+
+    task<> run() {
+        std::vector<std::byte> block(BLOCK_SIZE);
+        for (;;) {
+            co_await async_recv_until(block.size());
+            read_bytes(block);
+        }
+    }
+
+    task<> m_task;
+};
+
+static asio::awaitable<void> write_forever(tcp::socket socket) {
+    static const std::vector<std::byte> data(256 * 1024, std::byte(0x55));
+    for (;;) {
+        co_await asio::async_write(socket, asio::buffer(data), asio::use_awaitable);
+    }
+}
+
+static asio::awaitable<void> listen(tcp::acceptor &acceptor) {
+    for (;;) {
+        // a strand per connection since the server runs on several threads
+        tcp::socket socket = co_await acceptor.async_accept(asio::make_strand(acceptor.get_executor()), asio::use_awaitable);
+        asio::co_spawn(socket.get_executor(), write_forever(std::move(socket)), asio::detached);
+    }
+}
+
+static void run(size_t connections, const options &opts) {
+    asio::io_context server_io(opts.threads);
+    tcp::acceptor acceptor(server_io, { asio::ip::address_v4::loopback(), 0 });
+    asio::co_spawn(server_io, listen(acceptor), asio::detached);
+    std::vector<std::thread> server_threads {};
+    for (size_t i = 0; i < opts.threads; i++) {
+        server_threads.emplace_back([&server_io, i] {
+            logger::set_thread_name(fmt::format("server{}", i));
+            server_io.run();
+        });
+    }
+
+    asio::io_context io(opts.threads);
+    std::vector<std::unique_ptr<receiver>> receivers {};
+    for (size_t i = 0; i < connections; i++) {
+        receivers.emplace_back(std::make_unique<receiver>())->connect(io, acceptor.local_endpoint());
+    }
+
+    asio::steady_timer timer(io, std::chrono::seconds(opts.seconds));
+    timer.async_wait([&io](const asio::error_code &) {
+        io.stop();
+    });
+    double seconds = run_threads(io, opts.threads);
+
+    server_io.stop();
+    for (std::thread &thread : server_threads) {
+        thread.join();
+    }
+
+    uint64_t bytes = 0;
+    uint64_t reads = 0;
+    for (const std::unique_ptr<receiver> &r : receivers) {
+        bytes += r->bytes_received();
+        reads += r->reads_completed();
+    }
+    constexpr double MB = 1024. * 1024.;
+    MCCPP_I("{:>8} {:>5} connections {:10.1f} MB/s {:12.0f} reads/s {:8.1f} KiB/read",
+            backend_name(), connections, bytes / MB / seconds, reads / seconds,
+            reads ? bytes / 1024. / reads : 0.);
+}
+
+static int main(int argc, char **argv) {
+    logger::set_thread_name("main");
+
+    options opts {};
+    if (!parse_options(argc, argv, opts)) {
+        MCCPP_E("Usage: {} [--connections N[,N...]] [--threads N] [--seconds N]", argv[0]);
+        return 1;
+    }
+
+    // both ends of every connection live in this process
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    for (size_t connections : opts.connections) {
+        run(connections, opts);
+    }
+    return 0;
+}
+
+}
+
+int main(int argc, char **argv) {
+    return mccpp::headless::main(argc, argv);
+}
@@ -0,0 +1,118 @@
+// Replays a capture recorded with mccpp-headless --capture through the
+// packet framing and handlers without a socket, reporting the decode time
+// of every packet type. Captures are deterministic input for profiling.
+
+#include <chrono>
+#include <string_view>
+#include <thread>
+
+#include "../logger.hh"
+#include "../proto/capture.hh"
+#include "session.hh"
+
+namespace mccpp::headless {
+
+struct options {
+    std::string path;
+    // sleep until each read is due instead of replaying as fast as possible
+    bool paced = false;
+    bool store_chunks = true;
+    unsigned iterations = 1;
+};
+
+static bool parse_options(int argc, char **argv, options &opts) {
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--paced") {
+            opts.paced = true;
+        } else if (arg == "--no-chunks") {
+            opts.store_chunks = false;
+        } else if (arg == "--iterations") {
+            if (i + 1 >= argc || !parse_number(argv[++i], opts.iterations) || opts.iterations == 0)
+                return false;
+        } else if (opts.path.empty() && !arg.starts_with("--")) {
+            opts.path = arg;
+        } else {
+            return false;
+        }
+    }
+    return !opts.path.empty();
+}
+
+struct totals {
+    uint64_t bytes = 0;
+    uint64_t decoded = 0;
+    uint64_t packets = 0;
+    uint64_t chunks = 0;
+    std::chrono::nanoseconds time {};
+    client::packet_stats_table packets_by_type = client::client::empty_packet_stats();
+};
+
+static void replay(const std::vector<proto::capture_record> &records, const options &opts, totals &out) {
+    session s { "replay", opts.store_chunks };
+    s.client.connect_offline();
+
+    auto start = std::chrono::steady_clock::now();
+    for (const proto::capture_record &record : records) {
+        if (opts.paced) {
+            std::this_thread::sleep_until(start + record.time);
+        }
+        s.client.feed(record.data);
+    }
+    auto finish = std::chrono::steady_clock::now();
+
+    out.bytes += s.client.bytes_received();
+    out.decoded += s.client.bytes_decoded();
+    out.packets += s.client.packets_received();
+    out.chunks += s.client.chunks_received();
+    out.time += finish - start;
+    const client::packet_stats_table &stats = s.client.packet_stats();
+    for (size_t state = 0; state < stats.size(); state++) {
+        for (size_t id = 0; id < stats[state].size(); id++) {
+            client::packet_type_stats &total = out.packets_by_type[state][id];
+            total.count += stats[state][id].count;
+            total.bytes += stats[state][id].bytes;
+            total.decode_time += stats[state][id].decode_time;
+        }
+    }
+}
+
+static void report(const totals &t) {
+    constexpr double MB = 1024. * 1024.;
+
+    client::log_packet_stats(t.packets_by_type);
+
+    double seconds = std::chrono::duration<double>(t.time).count();
+    MCCPP_I("{:.3f} MB/s {:.3f} MB/s decoded {:.1f} packets/s {:.1f} chunks/s over {:.3f} s",
+            t.bytes / MB / seconds, t.decoded / MB / seconds, t.packets / seconds, t.chunks / seconds, seconds);
+}
+
+static int main(int argc, char **argv) {
+    logger::set_thread_name("main");
+
+    options opts {};
+    if (!parse_options(argc, argv, opts)) {
+        MCCPP_E("Usage: {} [--paced] [--no-chunks] [--iterations N] FILE", argv[0]);
+        return 1;
+    }
+
+    std::vector<proto::capture_record> records = proto::read_capture(opts.path);
+    size_t size = 0;
+    for (const proto::capture_record &record : records) {
+        size += record.data.size();
+    }
+    MCCPP_I("Loaded {} reads, {} bytes from {}", records.size(), size, opts.path);
+
+    totals t {};
+    for (unsigned i = 0; i < opts.iterations; i++) {
+        replay(records, opts, t);
+    }
+    report(t);
+    return 0;
+}
+
+}
+
+int main(int argc, char **argv) {
+    return mccpp::headless::main(argc, argv);
+}
@@ -0,0 +1,78 @@
+#include "session.hh"
+
+#include <chrono>
+#include <thread>
+
+#include "../logger.hh"
+
+namespace mccpp::headless {
+
+session_list start_sessions(asio::io_context &io, size_t count,
+                            std::string_view address, uint16_t port, bool store_chunks,
+                            std::unique_ptr<proto::capture_writer> capture) {
+    session_list sessions {};
+    sessions.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        session &s = *sessions.emplace_back(std::make_unique<session>(fmt::format("bot{}", i), store_chunks));
+        if (capture) {
+            s.client.capture_to(std::move(capture));
+        }
+        s.client.connect(io, address, port);
+    }
+    return sessions;
+}
+
+static void run_io(asio::io_context &io) {
+    for (;;) {
+        try {
+            io.run();
+            return;
+        } catch (const std::exception &e) {
+            // a broken session shouldn't take down all the others
+            MCCPP_E("session failed: {}", e.what());
+        }
+    }
+}
+
+double run_threads(asio::io_context &io, size_t threads) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool {};
+    for (size_t i = 1; i < threads; i++) {
+        pool.emplace_back([&io, i] {
+            logger::set_thread_name(fmt::format("io{}", i));
+            run_io(io);
+        });
+    }
+    run_io(io);
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(finish - start).count();
+}
+
+void report(const session_list &sessions, double seconds) {
+    constexpr double MB = 1024. * 1024.;
+    uint64_t total_bytes = 0;
+    uint64_t total_decoded = 0;
+    uint64_t total_packets = 0;
+    uint64_t total_chunks = 0;
+    for (const std::unique_ptr<session> &s : sessions) {
+        uint64_t bytes = s->client.bytes_received();
+        uint64_t decoded = s->client.bytes_decoded();
+        uint64_t packets = s->client.packets_received();
+        uint64_t chunks = s->client.chunks_received();
+        MCCPP_I("{:>12} {:8.3f} MB/s {:8.3f} MB/s decoded {:10.1f} packets/s {:8.1f} chunks/s",
+                s->client.username(), bytes / MB / seconds, decoded / MB / seconds,
+                packets / seconds, chunks / seconds);
+        total_bytes += bytes;
+        total_decoded += decoded;
+        total_packets += packets;
+        total_chunks += chunks;
+    }
+    MCCPP_I("{:>12} {:8.3f} MB/s {:8.3f} MB/s decoded {:10.1f} packets/s {:8.1f} chunks/s over {:.2f} s",
+            "total", total_bytes / MB / seconds, total_decoded / MB / seconds,
+            total_packets / seconds, total_chunks / seconds, seconds);
+}
+
+}
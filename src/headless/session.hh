@@ -0,0 +1,55 @@
+#pragma once
+
+#include <charconv>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <asio.hpp>
+
+#include "../client/client.hh"
+#include "../game.hh"
+
+namespace mccpp::headless {
+
+class headless_game final : public game {
+public:
+    void on_frame() override {}
+    float delta_time() override { return 0.f; }
+};
+
+struct session {
+    session(std::string username, bool store_chunks)
+    : client(game, {
+            .username = std::move(username),
+            .dispatch = proto::dispatch_mode::INLINE,
+            .store_chunks = store_chunks,
+        })
+    {}
+
+    headless_game game;
+    client::client client;
+};
+
+using session_list = std::vector<std::unique_ptr<session>>;
+
+// Connects sessions named bot0, bot1, ... they make progress once io runs.
+// The first session records everything it receives to capture if set.
+session_list start_sessions(asio::io_context &io, size_t count,
+                            std::string_view address, uint16_t port, bool store_chunks,
+                            std::unique_ptr<proto::capture_writer> capture = nullptr);
+
+// Runs io on the calling thread and threads - 1 extra threads until it is
+// stopped, returns the elapsed time in seconds
+double run_threads(asio::io_context &io, size_t threads);
+
+void report(const session_list &sessions, double seconds);
+
+template<typename T>
+bool parse_number(std::string_view str, T &out) {
+    auto [end, error] = std::from_chars(str.data(), str.data() + str.size(), out);
+    return error == std::errc() && end == str.data() + str.size();
+}
+
+}
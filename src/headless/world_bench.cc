@@ -0,0 +1,396 @@
+// Measures world queries on generated terrain, without any networking
+// involved.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "../PerlinNoise.hpp"
+#include "../logger.hh"
+#include "../world/collision.hh"
+#include "../world/entities.hh"
+#include "../world/raycast.hh"
+#include "../world/world.hh"
+#include "session.hh"
+
+namespace mccpp::headless {
+
+struct options {
+    int32_t radius = 8;
+    size_t rays = 200000;
+};
+
+static bool parse_options(int argc, char **argv, options &opts) {
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (i + 1 >= argc)
+            return false;
+        std::string_view value = argv[++i];
+        bool ok;
+        if (arg == "--radius") {
+            ok = parse_number(value, opts.radius) && opts.radius >= 0 && opts.radius <= 32;
+        } else if (arg == "--rays") {
+            ok = parse_number(value, opts.rays) && opts.rays > 0;
+        } else {
+            ok = false;
+        }
+        if (!ok)
+            return false;
+    }
+    return true;
+}
+
+// Rolling hills of stone between y 40 and 120
+static int32_t surface(const siv::PerlinNoise &perlin, int32_t x, int32_t z) {
+    return 40 + int32_t(perlin.octave2D_01(x * 0.01, z * 0.01, 4) * 80.);
+}
+
+static void generate_world(world::world &w, const siv::PerlinNoise &perlin, int32_t radius) {
+    constexpr world::block_state STONE = 1;
+    for (int32_t cx = -radius; cx <= radius; cx++) {
+        for (int32_t cz = -radius; cz <= radius; cz++) {
+            world::chunk_column &column = w.chunks().get(cx, cz);
+            for (int z = 0; z < 16; z++) {
+                for (int x = 0; x < 16; x++) {
+                    int32_t top = surface(perlin, cx * 16 + x, cz * 16 + z) - w.min_y();
+                    for (int32_t y = 0; y <= top; y++) {
+                        column[y >> 4].set_state(x, y & 15, z, STONE);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// The same walk without the section cache or skipping empty sections
+static std::optional<world::ray_hit> naive_raycast(world::world &w, const world::ray &r) {
+    glm::dvec3 dir = glm::normalize(r.direction);
+    glm::ivec3 voxel { glm::floor(r.origin) };
+    glm::ivec3 step {};
+    glm::dvec3 t_delta { INFINITY };
+    glm::dvec3 t_max { INFINITY };
+    for (int a = 0; a < 3; a++) {
+        if (dir[a] != 0.) {
+            step[a] = dir[a] > 0. ? 1 : -1;
+            t_delta[a] = std::abs(1. / dir[a]);
+            t_max[a] = (dir[a] > 0. ? voxel[a] + 1 - r.origin[a] : r.origin[a] - voxel[a]) * t_delta[a];
+        }
+    }
+    double t = 0.;
+    while (t <= r.max_distance) {
+        world::block_state state = w.block_state_at(voxel.x, voxel.y, voxel.z);
+        if (state != world::AIR)
+            return world::ray_hit { voxel, {}, t, state };
+        int a = t_max.x < t_max.y ? (t_max.x < t_max.z ? 0 : 2) : (t_max.y < t_max.z ? 1 : 2);
+        t = t_max[a];
+        voxel[a] += step[a];
+        t_max[a] += t_delta[a];
+    }
+    return std::nullopt;
+}
+
+template<typename F>
+static void measure(std::string_view name, size_t count, F &&run) {
+    auto start = std::chrono::steady_clock::now();
+    size_t hits = run();
+    auto finish = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(finish - start).count();
+    MCCPP_I("{:<28} {:8.1f} ns/op  {:6.1f}% hits", name, seconds * 1e9 / count, 100. * hits / count);
+}
+
+static void bench_rays(world::world &w, std::string_view name, const std::vector<world::ray> &rays) {
+    measure(fmt::format("{} naive", name), rays.size(), [&] {
+        size_t hits = 0;
+        for (const world::ray &r : rays) {
+            hits += naive_raycast(w, r).has_value();
+        }
+        return hits;
+    });
+    measure(fmt::format("{} single", name), rays.size(), [&] {
+        size_t hits = 0;
+        for (const world::ray &r : rays) {
+            hits += world::raycast(w, r).has_value();
+        }
+        return hits;
+    });
+    std::vector<std::optional<world::ray_hit>> results(rays.size());
+    measure(fmt::format("{} batch", name), rays.size(), [&] {
+        world::raycast(w, rays, results);
+        return size_t(std::count_if(results.begin(), results.end(), [](const auto &hit) { return hit.has_value(); }));
+    });
+}
+
+// Players walking over the hills at 20 TPS, one collider each like a bot
+// would have. Without the cache every move gathers its boxes again.
+static void bench_walking(world::world &w, const siv::PerlinNoise &perlin, int32_t radius, size_t moves, bool cached) {
+    constexpr size_t WALKERS = 64;
+    world::collision_shapes shapes {};
+    std::mt19937 random { 2 };
+    std::uniform_real_distribution<double> position { -radius * 16. + 8., radius * 16. + 8. };
+    std::uniform_real_distribution<double> angle { 0., 6.283185307179586 };
+
+    struct walker {
+        world::collider collider;
+        glm::dvec3 position;
+        glm::dvec3 velocity;
+        bool on_ground;
+    };
+    std::vector<walker> walkers {};
+    for (size_t i = 0; i < WALKERS; i++) {
+        glm::dvec3 p { position(random), 0., position(random) };
+        p.y = surface(perlin, int32_t(std::floor(p.x)), int32_t(std::floor(p.z))) + 1.;
+        double a = angle(random);
+        walkers.push_back({ { w, shapes }, p, { std::cos(a) * 0.2, 0., std::sin(a) * 0.2 }, true });
+    }
+
+    measure(cached ? "walking cached" : "walking uncached", moves, [&] {
+        size_t blocked = 0;
+        for (size_t i = 0; i < moves; i++) {
+            walker &k = walkers[i % WALKERS];
+            if (!cached)
+                k.collider.invalidate();
+            glm::dvec3 half { 0.3, 0., 0.3 };
+            world::aabb box { k.position - half, k.position + half + glm::dvec3 { 0., 1.8, 0. } };
+            glm::dvec3 motion { k.velocity.x, k.velocity.y - 0.08, k.velocity.z };
+            world::move_result r = k.collider.move(box, motion, 0.6, k.on_ground);
+            k.position += r.motion;
+            k.on_ground = r.on_ground;
+            k.velocity.y = r.collided_vertically ? 0. : motion.y;
+            // turn around at walls and at the edge of the world
+            if (r.collided_horizontally || std::abs(k.position.x) > radius * 16. || std::abs(k.position.z) > radius * 16.) {
+                k.velocity.x = -k.velocity.x;
+                k.velocity.z = -k.velocity.z;
+                blocked++;
+            }
+        }
+        return blocked;
+    });
+}
+
+// Proximity queries over entities around the spawn, the grid against
+// scanning all of them, and the cost of keeping the grid up to date
+static void bench_entities(size_t count, size_t queries) {
+    std::mt19937 random { 3 };
+    std::uniform_real_distribution<double> horizontal { -128., 128. };
+    std::uniform_real_distribution<double> vertical { 40., 120. };
+    std::uniform_real_distribution<double> step { -0.5, 0.5 };
+    world::entity_store entities {};
+    for (size_t i = 0; i < count; i++) {
+        world::entity_spawn spawn {};
+        spawn.id = int32_t(i);
+        spawn.position = { horizontal(random), vertical(random), horizontal(random) };
+        entities.add(spawn);
+    }
+    std::vector<glm::dvec3> centers {};
+    for (size_t i = 0; i < queries; i++) {
+        centers.push_back({ horizontal(random), vertical(random), horizontal(random) });
+    }
+
+    std::vector<uint32_t> found {};
+    auto label = [count](std::string_view name) { return fmt::format("{} {}", count, name); };
+    measure(label("radius 16 scan"), queries, [&] {
+        size_t hits = 0;
+        for (glm::dvec3 center : centers) {
+            found.clear();
+            for (uint32_t slot = 0; slot < entities.size(); slot++) {
+                glm::dvec3 d = entities.position(slot) - center;
+                if (glm::dot(d, d) <= 16. * 16.)
+                    found.push_back(slot);
+            }
+            hits += !found.empty();
+        }
+        return hits;
+    });
+    measure(label("radius 16 grid"), queries, [&] {
+        size_t hits = 0;
+        for (glm::dvec3 center : centers) {
+            entities.query_radius(center, 16., found);
+            hits += !found.empty();
+        }
+        return hits;
+    });
+    measure(label("box 32x8x32 grid"), queries, [&] {
+        size_t hits = 0;
+        for (glm::dvec3 center : centers) {
+            entities.query_box({ center - glm::dvec3 { 16., 4., 16. }, center + glm::dvec3 { 16., 4., 16. } }, found);
+            hits += !found.empty();
+        }
+        return hits;
+    });
+    measure(label("nearest 8 scan"), queries, [&] {
+        std::vector<std::pair<double, uint32_t>> all(entities.size());
+        for (glm::dvec3 center : centers) {
+            for (uint32_t slot = 0; slot < entities.size(); slot++) {
+                glm::dvec3 d = entities.position(slot) - center;
+                all[slot] = { glm::dot(d, d), slot };
+            }
+            std::partial_sort(all.begin(), all.begin() + std::min<size_t>(8, all.size()), all.end());
+        }
+        return queries;
+    });
+    measure(label("nearest 8 grid"), queries, [&] {
+        size_t hits = 0;
+        for (glm::dvec3 center : centers) {
+            entities.query_nearest(center, 8, found);
+            hits += found.size() == 8;
+        }
+        return hits;
+    });
+    // a movement packet for every entity, a few cross into another cell
+    std::vector<glm::dvec3> steps {};
+    for (size_t i = 0; i < count; i++) {
+        steps.push_back({ step(random), step(random) * 0.2, step(random) });
+    }
+    measure(label("moves"), count * 20, [&] {
+        for (int tick = 0; tick < 20; tick++) {
+            for (size_t i = 0; i < count; i++) {
+                entities.move(int32_t(i), tick % 2 ? -steps[i] : steps[i], true);
+            }
+        }
+        return size_t(0);
+    });
+}
+
+// Biome colours of every block, worked out per column and looked up after
+static void bench_tints(const siv::PerlinNoise &perlin, int32_t radius, size_t rounds) {
+    std::vector<world::biome> biomes(8);
+    for (size_t i = 0; i < biomes.size(); i++) {
+        biomes[i].name = fmt::format("biome {}", i);
+        biomes[i].temperature = float(i) / 8.f;
+        biomes[i].downfall = float(i % 3) / 3.f;
+        biomes[i].water_color = 0x3f76e4;
+    }
+    world::world w { -64, 384, std::move(biomes) };
+    for (int32_t cx = -radius; cx <= radius; cx++) {
+        for (int32_t cz = -radius; cz <= radius; cz++) {
+            for (world::chunk &c : w.chunks().get(cx, cz)) {
+                for (size_t i = 0; i < c.biomes.size(); i++) {
+                    int32_t x = cx * 16 + int32_t(i & 3) * 4;
+                    int32_t z = cz * 16 + int32_t(i >> 2 & 3) * 4;
+                    c.biomes[i] = static_cast<world::biome_id>(perlin.octave2D_01(x * 0.005, z * 0.005, 2) * 8.);
+                }
+            }
+        }
+    }
+
+    size_t columns = w.chunks().size();
+    for (int blend : { 0, 2, 7 }) {
+        measure(fmt::format("blend tints radius {}", blend), columns * rounds, [&] {
+            size_t hits = 0;
+            for (size_t i = 0; i < rounds; i++) {
+                w.set_biome_blend_radius(blend);
+                for (int32_t cx = -radius; cx <= radius; cx++) {
+                    for (int32_t cz = -radius; cz <= radius; cz++) {
+                        hits += w.tints(cx, cz) != nullptr;
+                    }
+                }
+            }
+            return hits;
+        });
+    }
+    measure("cached tint lookups", columns * rounds * 256, [&] {
+        uint32_t sum = 0;
+        for (size_t i = 0; i < rounds; i++) {
+            for (int32_t cx = -radius; cx <= radius; cx++) {
+                for (int32_t cz = -radius; cz <= radius; cz++) {
+                    const world::column_tints *tints = w.tints(cx, cz);
+                    for (int z = 0; z < 16; z++) {
+                        for (int x = 0; x < 16; x++) {
+                            sum += tints->at(world::tint::GRASS, x, z);
+                        }
+                    }
+                }
+            }
+        }
+        return size_t(sum & 1);
+    });
+}
+
+// Torches put on the surface and taken away again, each spread all the way
+static void bench_light(world::world &w, const siv::PerlinNoise &perlin, int32_t radius, size_t edits) {
+    constexpr world::block_state TORCH = 2;
+    w.light().set_properties(TORCH, { 14, 0 });
+    std::mt19937 random { 2 };
+    std::uniform_int_distribution<int32_t> position { -radius * 16, radius * 16 + 15 };
+    std::vector<glm::ivec3> torches {};
+    for (size_t i = 0; i < edits; i++) {
+        glm::ivec3 p { position(random), 0, position(random) };
+        p.y = surface(perlin, p.x, p.z) + 1;
+        torches.push_back(p);
+    }
+    for (world::block_state state : { TORCH, world::AIR }) {
+        size_t steps = 0;
+        measure(state == TORCH ? "light place torch" : "light remove torch", edits, [&] {
+            for (glm::ivec3 p : torches) {
+                w.set_block(p.x, p.y, p.z, state);
+                steps += w.update_light(SIZE_MAX);
+            }
+            return size_t(0);
+        });
+        MCCPP_I("{:<28} {:8.1f} steps/op", "", double(steps) / edits);
+    }
+    w.take_dirty_sections();
+}
+
+static int main(int argc, char **argv) {
+    logger::set_thread_name("main");
+
+    options opts {};
+    if (!parse_options(argc, argv, opts)) {
+        MCCPP_E("Usage: {} [--radius N] [--rays N]", argv[0]);
+        return 1;
+    }
+
+    world::world w { -64, 384, {} };
+    siv::PerlinNoise perlin { 123456u };
+    generate_world(w, perlin, opts.radius);
+    MCCPP_I("Generated {} columns", w.chunks().size());
+
+    std::mt19937 random { 1 };
+    std::normal_distribution<double> direction {};
+    std::uniform_real_distribution<double> position { -opts.radius * 16., opts.radius * 16. + 16. };
+    std::uniform_real_distribution<double> height { 60., 200. };
+
+    // block targeting from the eyes of players, mostly short and hitting,
+    // a bot looking around casts a few from the same place
+    std::vector<world::ray> targeting {};
+    glm::dvec3 origin {};
+    for (size_t i = 0; i < opts.rays; i++) {
+        if (i % 16 == 0) {
+            origin = { position(random), 0., position(random) };
+            origin.y = surface(perlin, int32_t(std::floor(origin.x)), int32_t(std::floor(origin.z))) + 2.62;
+        }
+        glm::dvec3 d { direction(random), direction(random), direction(random) };
+        targeting.push_back({ origin, d, 5. });
+    }
+    bench_rays(w, "targeting 5", targeting);
+
+    // line of sight between points above and below the hills, long and
+    // crossing many empty sections
+    std::vector<world::ray> sight {};
+    for (size_t i = 0; i < opts.rays; i++) {
+        glm::dvec3 from { position(random), height(random), position(random) };
+        glm::dvec3 to { position(random), height(random), position(random) };
+        sight.push_back({ from, to - from, glm::length(to - from) });
+    }
+    bench_rays(w, "line of sight", sight);
+
+    bench_walking(w, perlin, opts.radius, opts.rays, true);
+    bench_walking(w, perlin, opts.radius, opts.rays, false);
+
+    bench_entities(1000, opts.rays / 10);
+    bench_entities(10000, opts.rays / 100);
+
+    bench_tints(perlin, opts.radius, 20);
+    bench_light(w, perlin, opts.radius, opts.rays / 100);
+    return 0;
+}
+
+}
+
+int main(int argc, char **argv) {
+    return mccpp::headless::main(argc, argv);
+}
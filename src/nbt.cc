@@ -1,5 +1,8 @@
 #include "nbt.hh"
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <iostream>
 
 namespace mccpp::nbt {
@@ -126,8 +129,18 @@ tag_double::tag_double(proto::packet_reader &s) {
     m_value = s.read_double();
 }
 
-tag_byte_array::tag_byte_array(proto::packet_reader &) {
-    throw parse_error("unimplemented");
+// Length prefix of an array, checked against what is left so a bogus length
+// can't allocate gigabytes
+static size_t read_array_length(proto::packet_reader &s, size_t element_size) {
+    int32_t length = s.read_i32();
+    if (length < 0 || static_cast<size_t>(length) > s.remaining() / element_size)
+        throw parse_error("invalid length");
+    return static_cast<size_t>(length);
+}
+
+tag_byte_array::tag_byte_array(proto::packet_reader &s) {
+    m_container.resize(read_array_length(s, 1));
+    s.read_bytes(std::as_writable_bytes(std::span(m_container)));
 }
 
 tag_string::tag_string(proto::packet_reader &s) {
@@ -167,23 +180,13 @@ tag_compound::tag_compound(proto::packet_reader &s) {
 }
 
 tag_int_array::tag_int_array(proto::packet_reader &s) {
-    int32_t length = s.read_i32();
-    if (length <= 0)
-        return;
-    m_container.reserve(length);
-    while (length-- > 0) {
-        m_container.emplace_back(s.read_i32());
-    }
+    m_container.resize(read_array_length(s, sizeof(element_type)));
+    s.read_i32_array(m_container);
 }
 
 tag_long_array::tag_long_array(proto::packet_reader &s) {
-    int32_t length = s.read_i32();
-    if (length <= 0)
-        return;
-    m_container.reserve(length);
-    while (length-- > 0) {
-        m_container.emplace_back(s.read_i64());
-    }
+    m_container.resize(read_array_length(s, sizeof(element_type)));
+    s.read_i64_array(m_container);
 }
 
 nbt::nbt(mccpp::proto::packet_reader &s) {
@@ -198,6 +201,17 @@ nbt::nbt(mccpp::proto::packet_reader &s) {
     m_root = tag::create(type, s);
 }
 
+template<typename Array>
+static void dump_array(Array &array) {
+    fmt::print("[{}] {{", array.values().size());
+    std::string_view separator = " ";
+    for (auto value : array) {
+        fmt::print("{}{}", separator, value);
+        separator = ", ";
+    }
+    fmt::print(" }}\n");
+}
+
 void dump_nbt(tag &tag, size_t indent_count = 0) {
     std::string indent(indent_count*2, ' ');
     std::string inner_indent((indent_count + 1)*2, ' ');
@@ -209,7 +223,7 @@ void dump_nbt(tag &tag, size_t indent_count = 0) {
     case TAG_LONG: fmt::print("{}\n", tag.as_long().value()); break;
     case TAG_FLOAT: fmt::print("{}\n", tag.as_float().value()); break;
     case TAG_DOUBLE: fmt::print("{}\n", tag.as_double().value()); break;
-    case TAG_BYTE_ARRAY: fmt::print("TODO\n"); break;
+    case TAG_BYTE_ARRAY: dump_array(tag.as_byte_array()); break;
     case TAG_STRING: fmt::print("\"{}\"\n", tag.as_string().value());break;
     case TAG_LIST:
         fmt::print("{{\n");
@@ -227,8 +241,8 @@ void dump_nbt(tag &tag, size_t indent_count = 0) {
         }
         fmt::print("{}}}\n", indent);
         break;
-    case TAG_INT_ARRAY: fmt::print("TODO\n"); break;
-    case TAG_LONG_ARRAY: fmt::print("TODO\n"); break;
+    case TAG_INT_ARRAY: dump_array(tag.as_int_array()); break;
+    case TAG_LONG_ARRAY: dump_array(tag.as_long_array()); break;
     default: abort();
     }
 }
@@ -238,4 +252,195 @@ void dump_nbt(proto::packet_reader &s) {
     dump_nbt(file.root());
 }
 
+// Vanilla refuses anything nested deeper
+static constexpr size_t MAX_DEPTH = 512;
+
+static void skip_bytes(proto::packet_reader &s, int64_t n) {
+    if (n < 0 || static_cast<uint64_t>(n) > s.remaining())
+        throw parse_error("invalid length");
+    s.discard(n);
+}
+
+// Size of the payload for types without a length prefix, 0 otherwise
+static size_t fixed_payload_size(tag_type type) {
+    switch (type) {
+    case TAG_BYTE: return 1;
+    case TAG_SHORT: return 2;
+    case TAG_INT: return 4;
+    case TAG_LONG: return 8;
+    case TAG_FLOAT: return 4;
+    case TAG_DOUBLE: return 8;
+    default: return 0;
+    }
+}
+
+void skip(proto::packet_reader &s) {
+    auto type = tag_type(s.read_u8());
+    if (type == TAG_END)
+        return;
+    skip_bytes(s, s.read_u16());
+    skip_payload(type, s);
+}
+
+void skip_payload(tag_type type, proto::packet_reader &s) {
+    struct frame {
+        bool is_list;
+        tag_type item_type;
+        int32_t remaining;
+    };
+    std::array<frame, MAX_DEPTH> stack;
+    size_t depth = 0;
+
+    for (;;) {
+        if (size_t size = fixed_payload_size(type)) {
+            skip_bytes(s, size);
+        } else {
+            switch (type) {
+            case TAG_BYTE_ARRAY: skip_bytes(s, s.read_i32()); break;
+            case TAG_STRING: skip_bytes(s, s.read_u16()); break;
+            case TAG_INT_ARRAY: skip_bytes(s, int64_t(s.read_i32()) * 4); break;
+            case TAG_LONG_ARRAY: skip_bytes(s, int64_t(s.read_i32()) * 8); break;
+            case TAG_LIST: {
+                auto item_type = tag_type(s.read_u8());
+                int32_t length = std::max(s.read_i32(), 0);
+                if (size_t size = fixed_payload_size(item_type)) {
+                    skip_bytes(s, int64_t(length) * size);
+                    break;
+                }
+                if (length > 0 && (item_type == TAG_END || item_type > TAG_LONG_ARRAY))
+                    throw parse_error("invalid list item type");
+                if (depth == MAX_DEPTH)
+                    throw parse_error("nested too deep");
+                stack[depth++] = { true, item_type, length };
+                break;
+            }
+            case TAG_COMPOUND:
+                if (depth == MAX_DEPTH)
+                    throw parse_error("nested too deep");
+                stack[depth++] = { false, TAG_END, 0 };
+                break;
+            default:
+                throw parse_error("unknown type");
+            }
+        }
+
+        // find the next value or return once the root has been closed
+        for (;;) {
+            if (depth == 0)
+                return;
+            frame &top = stack[depth - 1];
+            if (top.is_list) {
+                if (top.remaining > 0) {
+                    top.remaining--;
+                    type = top.item_type;
+                    break;
+                }
+                depth--;
+            } else {
+                type = tag_type(s.read_u8());
+                if (type == TAG_END) {
+                    depth--;
+                    continue;
+                }
+                skip_bytes(s, s.read_u16());
+                break;
+            }
+        }
+    }
+}
+
+void writer::begin_compound(std::string_view name) {
+    write_header(TAG_COMPOUND, name);
+    m_in_list.emplace_back(false);
+}
+
+void writer::end_compound() {
+    assert(!m_in_list.empty() && !m_in_list.back());
+    m_in_list.pop_back();
+    m_writer.write_u8(TAG_END);
+}
+
+void writer::begin_list(std::string_view name, tag_type item_type, int32_t length) {
+    write_header(TAG_LIST, name);
+    m_writer.write_u8(item_type);
+    m_writer.write_i32(length);
+    m_in_list.emplace_back(true);
+}
+
+void writer::end_list() {
+    assert(!m_in_list.empty() && m_in_list.back());
+    m_in_list.pop_back();
+}
+
+void writer::write_byte(std::string_view name, int8_t value) {
+    write_header(TAG_BYTE, name);
+    m_writer.write_i8(value);
+}
+
+void writer::write_short(std::string_view name, int16_t value) {
+    write_header(TAG_SHORT, name);
+    m_writer.write_i16(value);
+}
+
+void writer::write_int(std::string_view name, int32_t value) {
+    write_header(TAG_INT, name);
+    m_writer.write_i32(value);
+}
+
+void writer::write_long(std::string_view name, int64_t value) {
+    write_header(TAG_LONG, name);
+    m_writer.write_i64(value);
+}
+
+void writer::write_float(std::string_view name, float value) {
+    write_header(TAG_FLOAT, name);
+    m_writer.write_u32(std::bit_cast<uint32_t>(value));
+}
+
+void writer::write_double(std::string_view name, double value) {
+    write_header(TAG_DOUBLE, name);
+    m_writer.write_u64(std::bit_cast<uint64_t>(value));
+}
+
+void writer::write_string(std::string_view name, std::string_view value) {
+    write_header(TAG_STRING, name);
+    write_name(value);
+}
+
+void writer::write_byte_array(std::string_view name, std::span<const int8_t> values) {
+    write_header(TAG_BYTE_ARRAY, name);
+    m_writer.write_i32(values.size());
+    m_writer.write_bytes(std::as_bytes(values));
+}
+
+void writer::write_int_array(std::string_view name, std::span<const int32_t> values) {
+    write_header(TAG_INT_ARRAY, name);
+    m_writer.write_i32(values.size());
+    for (int32_t value : values) {
+        m_writer.write_i32(value);
+    }
+}
+
+void writer::write_long_array(std::string_view name, std::span<const int64_t> values) {
+    write_header(TAG_LONG_ARRAY, name);
+    m_writer.write_i32(values.size());
+    for (int64_t value : values) {
+        m_writer.write_i64(value);
+    }
+}
+
+void writer::write_header(tag_type type, std::string_view name) {
+    if (!m_in_list.empty() && m_in_list.back())
+        return;
+    m_writer.write_u8(type);
+    write_name(name);
+}
+
+void writer::write_name(std::string_view name) {
+    if (name.size() > UINT16_MAX)
+        throw proto::encode_error("NBT string too long");
+    m_writer.write_u16(name.size());
+    m_writer.write_bytes(std::as_bytes(std::span(name.data(), name.size())));
+}
+
 }
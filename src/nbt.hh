@@ -137,6 +137,17 @@ class tag_byte_array final : public tag {
 public:
     tag_type type() override { return TAG_BYTE_ARRAY; }
     tag_byte_array(proto::packet_reader &);
+
+    using element_type = int8_t;
+    using container_type = std::vector<element_type>;
+    using iterator = container_type::iterator;
+
+    iterator begin() { return m_container.begin(); }
+    iterator end() { return m_container.end(); }
+    container_type &values() { return m_container; }
+
+private:
+    container_type m_container;
 };
 
 class tag_string final : public tag {
@@ -198,6 +209,7 @@ public:
 
     iterator begin() { return m_container.begin(); }
     iterator end() { return m_container.end(); }
+    container_type &values() { return m_container; }
 
 private:
     container_type m_container;
@@ -214,6 +226,7 @@ public:
 
     iterator begin() { return m_container.begin(); }
     iterator end() { return m_container.end(); }
+    container_type &values() { return m_container; }
 
 private:
     container_type m_container;
@@ -231,4 +244,43 @@ private:
 
 void dump_nbt(mccpp::proto::packet_reader &s);
 
+// Validates and steps over a whole named tag without allocating, for data
+// that isn't needed. Strings and arrays are skipped by their length.
+void skip(proto::packet_reader &s);
+// Same for the payload of a tag whose type and name were already read
+void skip_payload(tag_type, proto::packet_reader &s);
+
+// Streams tags straight into a packet_writer without building a tree, names
+// are ignored for the elements of a list
+class writer {
+public:
+    explicit writer(proto::packet_writer &w)
+    : m_writer(w)
+    {}
+
+    void begin_compound(std::string_view name = {});
+    void end_compound();
+    void begin_list(std::string_view name, tag_type item_type, int32_t length);
+    void end_list();
+
+    void write_byte(std::string_view name, int8_t);
+    void write_short(std::string_view name, int16_t);
+    void write_int(std::string_view name, int32_t);
+    void write_long(std::string_view name, int64_t);
+    void write_float(std::string_view name, float);
+    void write_double(std::string_view name, double);
+    void write_string(std::string_view name, std::string_view);
+    void write_byte_array(std::string_view name, std::span<const int8_t>);
+    void write_int_array(std::string_view name, std::span<const int32_t>);
+    void write_long_array(std::string_view name, std::span<const int64_t>);
+
+private:
+    void write_header(tag_type, std::string_view name);
+    void write_name(std::string_view);
+
+    proto::packet_writer &m_writer;
+    // true for every open list, false for every open compound
+    std::vector<bool> m_in_list;
+};
+
 }
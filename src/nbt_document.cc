@@ -0,0 +1,268 @@
+#include "nbt_document.hh"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace mccpp::nbt {
+
+// Vanilla refuses anything nested deeper
+static constexpr size_t MAX_DEPTH = 512;
+
+template<typename T>
+static T load_be(const std::byte *in) {
+    using TU = std::make_unsigned_t<T>;
+    TU v = 0;
+    for (size_t i = 0; i < sizeof(T); i++) {
+        v = static_cast<TU>(v << 8 | static_cast<uint8_t>(in[i]));
+    }
+    return std::bit_cast<T>(v);
+}
+
+namespace {
+
+class cursor {
+public:
+    explicit cursor(std::span<const std::byte> data)
+    : m_data(data)
+    {}
+
+    size_t position() const { return m_position; }
+
+    // Returns the offset of n bytes and steps over them
+    size_t advance(int64_t n) {
+        if (n < 0 || static_cast<uint64_t>(n) > m_data.size() - m_position)
+            throw parse_error("invalid length");
+        size_t offset = m_position;
+        m_position += n;
+        return offset;
+    }
+
+    template<typename T>
+    T read() {
+        return load_be<T>(m_data.data() + advance(sizeof(T)));
+    }
+
+private:
+    std::span<const std::byte> m_data;
+    size_t m_position = 0;
+};
+
+}
+
+document::document(proto::packet_reader &s) {
+    std::optional<std::span<const std::byte>> unread = s.unread();
+    if (!unread.has_value())
+        throw parse_error("document needs a reader over memory");
+    // offsets are 32 bit
+    m_source = unread->first(std::min<size_t>(unread->size(), UINT32_MAX));
+    m_source = m_source.first(parse());
+    s.discard(m_source.size());
+}
+
+size_t document::parse() {
+    static_assert(sizeof(node) == 16);
+    cursor c { m_source };
+
+    auto type = tag_type(c.read<uint8_t>());
+    if (type == TAG_END)
+        return c.position();
+
+    struct frame {
+        bool is_list;
+        tag_type item_type;
+        int32_t remaining;
+    };
+    std::vector<frame> frames {};
+    // levels[i] collects the children of frames[i - 1], levels[0] the root
+    std::vector<std::vector<node>> levels(1);
+
+    uint16_t name_length = c.read<uint16_t>();
+    uint32_t name_offset = c.advance(name_length);
+
+    for (;;) {
+        node &n = levels[frames.size()].emplace_back();
+        n.name_offset = name_offset;
+        n.name_length = name_length;
+        n.type = type;
+        switch (type) {
+        case TAG_BYTE: n.integer = c.read<int8_t>(); break;
+        case TAG_SHORT: n.integer = c.read<int16_t>(); break;
+        case TAG_INT: n.integer = c.read<int32_t>(); break;
+        case TAG_LONG: n.integer = c.read<int64_t>(); break;
+        case TAG_FLOAT: n.floating = std::bit_cast<float>(c.read<uint32_t>()); break;
+        case TAG_DOUBLE: n.floating = std::bit_cast<double>(c.read<uint64_t>()); break;
+        case TAG_STRING: {
+            uint16_t length = c.read<uint16_t>();
+            n.range = { static_cast<uint32_t>(c.advance(length)), length };
+            break;
+        }
+        case TAG_BYTE_ARRAY:
+        case TAG_INT_ARRAY:
+        case TAG_LONG_ARRAY: {
+            int32_t length = c.read<int32_t>();
+            int64_t element_size = type == TAG_BYTE_ARRAY ? 1 : type == TAG_INT_ARRAY ? 4 : 8;
+            if (length < 0)
+                throw parse_error("invalid length");
+            n.range = { static_cast<uint32_t>(c.advance(length * element_size)), static_cast<uint32_t>(length) };
+            break;
+        }
+        case TAG_LIST:
+        case TAG_COMPOUND: {
+            if (frames.size() == MAX_DEPTH)
+                throw parse_error("nested too deep");
+            frame &f = frames.emplace_back(type == TAG_LIST, TAG_END, 0);
+            if (f.is_list) {
+                f.item_type = tag_type(c.read<uint8_t>());
+                f.remaining = std::max(c.read<int32_t>(), 0);
+                if (f.remaining > 0 && (f.item_type == TAG_END || f.item_type > TAG_LONG_ARRAY))
+                    throw parse_error("invalid list item type");
+            }
+            if (levels.size() <= frames.size())
+                levels.emplace_back();
+            levels[frames.size()].clear();
+            break;
+        }
+        default:
+            throw parse_error("unknown type");
+        }
+
+        // find the next value, closing every container that ends here
+        for (;;) {
+            if (frames.empty()) {
+                m_nodes.emplace_back(levels[0][0]);
+                return c.position();
+            }
+
+            frame &top = frames.back();
+            if (top.is_list) {
+                if (top.remaining > 0) {
+                    top.remaining--;
+                    type = top.item_type;
+                    name_offset = 0;
+                    name_length = 0;
+                    break;
+                }
+            } else {
+                type = tag_type(c.read<uint8_t>());
+                if (type != TAG_END) {
+                    name_length = c.read<uint16_t>();
+                    name_offset = c.advance(name_length);
+                    break;
+                }
+            }
+
+            std::vector<node> &children = levels[frames.size()];
+            if (!top.is_list) {
+                std::stable_sort(children.begin(), children.end(), [this](const node &a, const node &b) {
+                    return name_of(a) < name_of(b);
+                });
+            }
+            node &parent = levels[frames.size() - 1].back();
+            parent.range = { static_cast<uint32_t>(m_nodes.size()), static_cast<uint32_t>(children.size()) };
+            m_nodes.insert(m_nodes.end(), children.begin(), children.end());
+            frames.pop_back();
+        }
+    }
+}
+
+std::string_view document::name_of(const node &n) const {
+    return { reinterpret_cast<const char *>(m_source.data()) + n.name_offset, n.name_length };
+}
+
+std::optional<document::value> document::root() const {
+    if (m_nodes.empty())
+        return std::nullopt;
+    // containers are written after their children so the root comes last
+    return value { *this, static_cast<uint32_t>(m_nodes.size() - 1) };
+}
+
+std::string_view document::value::name() const {
+    return m_document->name_of(node());
+}
+
+int8_t document::value::as_byte() const {
+    assert(type() == TAG_BYTE);
+    return static_cast<int8_t>(node().integer);
+}
+
+int16_t document::value::as_short() const {
+    assert(type() == TAG_SHORT);
+    return static_cast<int16_t>(node().integer);
+}
+
+int32_t document::value::as_int() const {
+    assert(type() == TAG_INT);
+    return static_cast<int32_t>(node().integer);
+}
+
+int64_t document::value::as_long() const {
+    assert(type() == TAG_LONG);
+    return node().integer;
+}
+
+float document::value::as_float() const {
+    assert(type() == TAG_FLOAT);
+    return static_cast<float>(node().floating);
+}
+
+double document::value::as_double() const {
+    assert(type() == TAG_DOUBLE);
+    return node().floating;
+}
+
+std::string_view document::value::as_string() const {
+    assert(type() == TAG_STRING);
+    return { reinterpret_cast<const char *>(payload()), node().range.count };
+}
+
+size_t document::value::size() const {
+    assert(type() == TAG_BYTE_ARRAY || type() == TAG_INT_ARRAY || type() == TAG_LONG_ARRAY ||
+           type() == TAG_LIST || type() == TAG_COMPOUND);
+    return node().range.count;
+}
+
+std::span<const int8_t> document::value::byte_array() const {
+    assert(type() == TAG_BYTE_ARRAY);
+    return { reinterpret_cast<const int8_t *>(payload()), node().range.count };
+}
+
+int32_t document::value::int_array_at(size_t i) const {
+    assert(type() == TAG_INT_ARRAY && i < size());
+    return load_be<int32_t>(payload() + i * 4);
+}
+
+int64_t document::value::long_array_at(size_t i) const {
+    assert(type() == TAG_LONG_ARRAY && i < size());
+    return load_be<int64_t>(payload() + i * 8);
+}
+
+document::value document::value::operator[](size_t i) const {
+    assert((type() == TAG_LIST || type() == TAG_COMPOUND) && i < size());
+    return { *m_document, static_cast<uint32_t>(node().range.first + i) };
+}
+
+document::iterator document::value::begin() const {
+    assert(type() == TAG_LIST || type() == TAG_COMPOUND);
+    return { *m_document, node().range.first };
+}
+
+document::iterator document::value::end() const {
+    assert(type() == TAG_LIST || type() == TAG_COMPOUND);
+    return { *m_document, node().range.first + node().range.count };
+}
+
+std::optional<document::value> document::value::find(std::string_view name) const {
+    assert(type() == TAG_COMPOUND);
+    const document &doc = *m_document;
+    auto first = doc.m_nodes.begin() + node().range.first;
+    auto last = first + node().range.count;
+    auto it = std::lower_bound(first, last, name, [&doc](const document::node &n, std::string_view name) {
+        return doc.name_of(n) < name;
+    });
+    if (it == last || doc.name_of(*it) != name)
+        return std::nullopt;
+    return value { doc, static_cast<uint32_t>(it - doc.m_nodes.begin()) };
+}
+
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "nbt.hh"
+
+namespace mccpp::nbt {
+
+// Read-only NBT tree stored as one flat array of nodes. Names, strings and
+// arrays are views into the source bytes which must outlive the document.
+// The children of a list or compound are contiguous, compound children are
+// sorted by name so lookups are a binary search.
+class document {
+    struct node;
+
+public:
+    // The reader must read from memory, see packet_reader::unread()
+    explicit document(proto::packet_reader &);
+
+    class value;
+    class iterator;
+
+    // Empty documents (a lone TAG_End) have no root
+    std::optional<value> root() const;
+
+    size_t node_count() const { return m_nodes.size(); }
+
+private:
+    // Offsets are relative to m_source, 16 bytes per node
+    struct node {
+        uint32_t name_offset;
+        uint16_t name_length;
+        uint8_t type;
+        union {
+            int64_t integer;
+            double floating;
+            // strings and arrays: payload offset and element count
+            // lists and compounds: first child node and child count
+            struct {
+                uint32_t first;
+                uint32_t count;
+            } range;
+        };
+    };
+
+    // Returns the number of bytes used
+    size_t parse();
+    std::string_view name_of(const node &) const;
+
+    std::span<const std::byte> m_source;
+    std::vector<node> m_nodes;
+};
+
+class document::value {
+public:
+    tag_type type() const { return tag_type(node().type); }
+    std::string_view name() const;
+
+    int8_t as_byte() const;
+    int16_t as_short() const;
+    int32_t as_int() const;
+    int64_t as_long() const;
+    float as_float() const;
+    double as_double() const;
+    std::string_view as_string() const;
+
+    // Element count of arrays, lists and compounds
+    size_t size() const;
+
+    // Elements of byte, int and long arrays
+    std::span<const int8_t> byte_array() const;
+    int32_t int_array_at(size_t) const;
+    int64_t long_array_at(size_t) const;
+
+    // Elements of lists, or compounds in name order
+    value operator[](size_t) const;
+    iterator begin() const;
+    iterator end() const;
+
+    // Compounds only
+    std::optional<value> find(std::string_view name) const;
+
+private:
+    value(const document &doc, uint32_t index)
+    : m_document(&doc)
+    , m_index(index)
+    {}
+
+    const document::node &node() const { return m_document->m_nodes[m_index]; }
+    const std::byte *payload() const { return m_document->m_source.data() + node().range.first; }
+
+    const document *m_document;
+    uint32_t m_index;
+
+    friend class document;
+};
+
+class document::iterator {
+public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = document::value;
+
+    value operator*() const { return { *m_document, m_index }; }
+    iterator &operator++() { m_index++; return *this; }
+    iterator operator++(int) { iterator it = *this; m_index++; return it; }
+    bool operator==(const iterator &) const = default;
+
+private:
+    iterator(const document &doc, uint32_t index)
+    : m_document(&doc)
+    , m_index(index)
+    {}
+
+    const document *m_document;
+    uint32_t m_index;
+
+    friend class document::value;
+};
+
+}
@@ -0,0 +1,208 @@
+#include "nbt_visitor.hh"
+
+#include <algorithm>
+#include <array>
+
+namespace mccpp::nbt {
+
+// Vanilla refuses anything nested deeper
+static constexpr size_t MAX_DEPTH = 512;
+
+static std::span<const std::byte> read_view(proto::packet_reader &s, int64_t n) {
+    std::span<const std::byte> unread = *s.unread();
+    if (n < 0 || static_cast<uint64_t>(n) > unread.size())
+        throw parse_error("invalid length");
+    s.discard(n);
+    return unread.first(n);
+}
+
+static std::string_view read_string_view(proto::packet_reader &s) {
+    std::span<const std::byte> bytes = read_view(s, s.read_u16());
+    return { reinterpret_cast<const char *>(bytes.data()), bytes.size() };
+}
+
+void visit(proto::packet_reader &s, visitor &v) {
+    if (!s.unread().has_value())
+        throw parse_error("visit needs a reader over memory");
+
+    auto type = tag_type(s.read_u8());
+    if (type == TAG_END)
+        return;
+    read_string_view(s);
+
+    struct frame {
+        bool is_list;
+        tag_type item_type;
+        int32_t remaining;
+    };
+    std::array<frame, MAX_DEPTH> stack;
+    size_t depth = 0;
+
+    for (;;) {
+        switch (type) {
+        case TAG_BYTE: v.value(type, int64_t(s.read_i8())); break;
+        case TAG_SHORT: v.value(type, int64_t(s.read_i16())); break;
+        case TAG_INT: v.value(type, int64_t(s.read_i32())); break;
+        case TAG_LONG: v.value(type, s.read_i64()); break;
+        case TAG_FLOAT: v.value(type, double(s.read_float())); break;
+        case TAG_DOUBLE: v.value(type, s.read_double()); break;
+        case TAG_STRING: v.value(read_string_view(s)); break;
+        case TAG_BYTE_ARRAY: v.value(type, read_view(s, s.read_i32())); break;
+        case TAG_INT_ARRAY: v.value(type, read_view(s, int64_t(s.read_i32()) * 4)); break;
+        case TAG_LONG_ARRAY: v.value(type, read_view(s, int64_t(s.read_i32()) * 8)); break;
+        case TAG_LIST: {
+            auto item_type = tag_type(s.read_u8());
+            int32_t length = std::max(s.read_i32(), 0);
+            if (length > 0 && (item_type == TAG_END || item_type > TAG_LONG_ARRAY))
+                throw parse_error("invalid list item type");
+            if (depth == MAX_DEPTH)
+                throw parse_error("nested too deep");
+            if (!v.begin_list(item_type, length)) {
+                while (length-- > 0) {
+                    skip_payload(item_type, s);
+                }
+                break;
+            }
+            stack[depth++] = { true, item_type, length };
+            break;
+        }
+        case TAG_COMPOUND:
+            if (depth == MAX_DEPTH)
+                throw parse_error("nested too deep");
+            if (!v.begin_compound()) {
+                skip_payload(type, s);
+                break;
+            }
+            stack[depth++] = { false, TAG_END, 0 };
+            break;
+        default:
+            throw parse_error("unknown type");
+        }
+
+        // find the next value, closing every container that ends here
+        for (;;) {
+            if (depth == 0)
+                return;
+            frame &top = stack[depth - 1];
+            if (top.is_list) {
+                if (top.remaining > 0) {
+                    top.remaining--;
+                    type = top.item_type;
+                    break;
+                }
+                depth--;
+                v.end_list();
+            } else {
+                type = tag_type(s.read_u8());
+                if (type == TAG_END) {
+                    depth--;
+                    v.end_compound();
+                    continue;
+                }
+                v.key(read_string_view(s));
+                break;
+            }
+        }
+    }
+}
+
+void path_query::on(std::initializer_list<std::string_view> path, callback function) {
+    m_queries.emplace_back(std::vector<std::string>(path.begin(), path.end()), std::move(function));
+}
+
+void path_query::next_element() {
+    if (!m_frames.empty() && m_frames.back().is_list)
+        m_frames.back().count++;
+}
+
+bool path_query::prefix_matches(const query &q, size_t length) const {
+    if (q.segments.size() < length)
+        return false;
+    for (size_t i = 0; i < length; i++) {
+        const std::string &segment = q.segments[i];
+        if (segment == "*")
+            continue;
+        if (m_frames[i].is_list || segment != m_frames[i].key)
+            return false;
+    }
+    return true;
+}
+
+bool path_query::descend(bool is_list) {
+    next_element();
+    size_t depth = m_frames.size();
+    bool wanted = std::any_of(m_queries.begin(), m_queries.end(), [&](const query &q) {
+        return q.segments.size() > depth && prefix_matches(q, depth);
+    });
+    if (wanted)
+        m_frames.emplace_back(is_list, 0, std::string_view {});
+    return wanted;
+}
+
+void path_query::report(match &m) {
+    next_element();
+    size_t depth = m_frames.size();
+    for (const query &q : m_queries) {
+        if (q.segments.size() != depth || !prefix_matches(q, depth))
+            continue;
+        m_indices.clear();
+        for (size_t i = 0; i < depth; i++) {
+            if (q.segments[i] == "*")
+                m_indices.emplace_back(m_frames[i].count - 1);
+        }
+        m.indices = m_indices;
+        q.function(m);
+    }
+}
+
+bool path_query::begin_compound() {
+    return descend(false);
+}
+
+void path_query::key(std::string_view name) {
+    frame &top = m_frames.back();
+    top.count++;
+    top.key = name;
+}
+
+void path_query::end_compound() {
+    m_frames.pop_back();
+}
+
+bool path_query::begin_list(tag_type, int32_t) {
+    return descend(true);
+}
+
+void path_query::end_list() {
+    m_frames.pop_back();
+}
+
+void path_query::value(tag_type type, int64_t value) {
+    match m {};
+    m.type = type;
+    m.integer = value;
+    report(m);
+}
+
+void path_query::value(tag_type type, double value) {
+    match m {};
+    m.type = type;
+    m.floating = value;
+    report(m);
+}
+
+void path_query::value(std::string_view value) {
+    match m {};
+    m.type = TAG_STRING;
+    m.string = value;
+    report(m);
+}
+
+void path_query::value(tag_type type, std::span<const std::byte> value) {
+    match m {};
+    m.type = type;
+    m.array = value;
+    report(m);
+}
+
+}
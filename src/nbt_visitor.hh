@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nbt.hh"
+
+namespace mccpp::nbt {
+
+// Receives the events of visit(). Names, strings and arrays are views into
+// the packet and only valid during the call. Returning false from
+// begin_compound() or begin_list() skips the container without any further
+// events, not even the matching end.
+class visitor {
+public:
+    virtual ~visitor() = default;
+
+    virtual bool begin_compound() { return true; }
+    // Name of the next value in the innermost compound
+    virtual void key(std::string_view) {}
+    virtual void end_compound() {}
+
+    // Item type and length
+    virtual bool begin_list(tag_type, int32_t) { return true; }
+    virtual void end_list() {}
+
+    // TAG_Byte, TAG_Short, TAG_Int and TAG_Long
+    virtual void value(tag_type, int64_t) {}
+    // TAG_Float and TAG_Double
+    virtual void value(tag_type, double) {}
+    virtual void value(std::string_view) {}
+    // TAG_Byte_Array, TAG_Int_Array and TAG_Long_Array, big endian elements
+    virtual void value(tag_type, std::span<const std::byte>) {}
+};
+
+// Streams one named tag into a visitor without building a tree, the root
+// name is ignored. The reader must read from memory, see
+// packet_reader::unread().
+void visit(proto::packet_reader &, visitor &);
+
+// Extracts the values at a set of paths in a single pass, subtrees no path
+// leads into are skipped. A path is a list of compound keys, keys may contain
+// '/' like registry names do. "*" matches any key of a compound and every
+// element of a list:
+//
+//     query.on({ "minecraft:dimension_type", "value", "*", "element", "height" }, [&](const path_query::match &m) {
+//         heights.at(m.indices[0]) = m.integer;
+//     });
+//
+// Only leaves are reported, paths ending at a list or compound never match.
+class path_query final : public visitor {
+public:
+    struct match {
+        // List index or key position for every "*" of the path, outermost first
+        std::span<const size_t> indices;
+        tag_type type;
+        int64_t integer = 0;
+        double floating = 0;
+        std::string_view string;
+        std::span<const std::byte> array;
+    };
+    using callback = std::function<void(const match &)>;
+
+    void on(std::initializer_list<std::string_view> path, callback);
+    void run(proto::packet_reader &s) { visit(s, *this); }
+
+private:
+    bool begin_compound() override;
+    void key(std::string_view) override;
+    void end_compound() override;
+    bool begin_list(tag_type, int32_t) override;
+    void end_list() override;
+    void value(tag_type, int64_t) override;
+    void value(tag_type, double) override;
+    void value(std::string_view) override;
+    void value(tag_type, std::span<const std::byte>) override;
+
+    struct query {
+        std::vector<std::string> segments;
+        callback function;
+    };
+
+    struct frame {
+        bool is_list;
+        // Elements or keys seen so far, the current one is count - 1
+        size_t count;
+        std::string_view key;
+    };
+
+    // Moves a list to its next element, called before every value in it
+    void next_element();
+    bool prefix_matches(const query &, size_t length) const;
+    bool descend(bool is_list);
+    void report(match &);
+
+    std::vector<query> m_queries;
+    std::vector<frame> m_frames;
+    std::vector<size_t> m_indices;
+};
+
+}
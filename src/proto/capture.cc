@@ -0,0 +1,75 @@
+#include "capture.hh"
+
+#include <array>
+
+namespace mccpp::proto {
+
+template<typename T>
+static void write_le(std::ofstream &stream, T value) {
+    std::array<char, sizeof(T)> bytes;
+    for (size_t i = 0; i < sizeof(T); i++) {
+        bytes[i] = char(value >> (i * 8));
+    }
+    stream.write(bytes.data(), bytes.size());
+}
+
+template<typename T>
+static bool read_le(std::ifstream &stream, T &value) {
+    std::array<unsigned char, sizeof(T)> bytes;
+    if (!stream.read(reinterpret_cast<char *>(bytes.data()), bytes.size()))
+        return false;
+    value = 0;
+    for (size_t i = 0; i < sizeof(T); i++) {
+        value |= T(bytes[i]) << (i * 8);
+    }
+    return true;
+}
+
+capture_writer::capture_writer(const std::string &path)
+: m_stream(path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc)
+, m_start(std::chrono::steady_clock::now())
+{
+    if (!m_stream) {
+        throw capture_error("failed to open " + path);
+    }
+    m_stream.write(CAPTURE_MAGIC.data(), CAPTURE_MAGIC.size());
+}
+
+void capture_writer::write(std::span<const std::byte> front, std::span<const std::byte> back) {
+    auto time = std::chrono::steady_clock::now() - m_start;
+    write_le<uint64_t>(m_stream, std::chrono::duration_cast<std::chrono::nanoseconds>(time).count());
+    write_le<uint32_t>(m_stream, front.size() + back.size());
+    m_stream.write(reinterpret_cast<const char *>(front.data()), front.size());
+    m_stream.write(reinterpret_cast<const char *>(back.data()), back.size());
+    if (!m_stream) {
+        throw capture_error("failed to write capture");
+    }
+}
+
+std::vector<capture_record> read_capture(const std::string &path) {
+    std::ifstream stream(path, std::ios_base::in | std::ios_base::binary);
+    if (!stream) {
+        throw capture_error("failed to open " + path);
+    }
+
+    std::string magic(CAPTURE_MAGIC.size(), '\0');
+    if (!stream.read(magic.data(), magic.size()) || magic != CAPTURE_MAGIC) {
+        throw capture_error(path + " is not a capture");
+    }
+
+    std::vector<capture_record> records {};
+    for (;;) {
+        uint64_t time;
+        uint32_t length;
+        if (!read_le(stream, time))
+            break;
+        if (!read_le(stream, length))
+            throw capture_error("truncated capture record");
+        capture_record &record = records.emplace_back(std::chrono::nanoseconds(time), std::vector<std::byte>(length));
+        if (!stream.read(reinterpret_cast<char *>(record.data.data()), length))
+            throw capture_error("truncated capture record");
+    }
+    return records;
+}
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace mccpp::proto {
+
+// Raw inbound byte stream of a connection together with the time each read
+// completed, so real sessions can be replayed through the decoder offline.
+//
+// The file starts with CAPTURE_MAGIC followed by records of a u64 of
+// nanoseconds since the capture started, a u32 length and the data, with
+// all integers little endian.
+
+class capture_error : public std::runtime_error {
+public:
+    capture_error(const std::string &what_arg)
+    : std::runtime_error(what_arg)
+    {}
+
+    capture_error(const char *what_arg)
+    : std::runtime_error(what_arg)
+    {}
+};
+
+constexpr std::string_view CAPTURE_MAGIC { "MCCPCAP1" };
+
+struct capture_record {
+    std::chrono::nanoseconds time;
+    std::vector<std::byte> data;
+};
+
+class capture_writer {
+public:
+    explicit capture_writer(const std::string &path);
+
+    // A single read, split in two because it may wrap around a ring buffer
+    void write(std::span<const std::byte> front, std::span<const std::byte> back = {});
+
+private:
+    std::ofstream m_stream;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+std::vector<capture_record> read_capture(const std::string &path);
+
+}
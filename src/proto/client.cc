@@ -2,6 +2,8 @@
 
 #include "../logger.hh"
 #include "../utility/format.hh"
+#include "compression.hh"
+#include "generated/proto/clientbound/types.hh"
 #include "varint.hh"
 
 namespace mccpp::proto {
@@ -10,8 +12,35 @@ void client::connect(asio::io_context &io, std::string_view address, uint16_t po
     tcp_client::connect(io, asio::ip::tcp::endpoint { asio::ip::make_address(address), port });
 }
 
+void client::poll() {
+    assert(m_dispatch_mode == dispatch_mode::QUEUED);
+    while (std::optional<std::vector<std::byte>> packet = m_receive_queue.try_pop()) {
+        // Pairs with the fence in receive_queue_awaiter: either this sees the
+        // flag or the receiver sees the slot that was just freed
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_receive_blocked.load(std::memory_order_relaxed) && m_receive_blocked.exchange(false)) {
+            asio::post(executor(), [this, handle = m_receive_blocked_resume] {
+                handle.resume();
+                on_readable();
+            });
+        }
+        dispatch(*packet);
+    }
+}
+
+void client::dispatch(std::span<const std::byte> packet) {
+    packet_reader reader { packet };
+
+    int32_t packet_id = reader.read_varint();
+    on_packet_received(packet_id, reader);
+    if (reader.remaining() != 0) {
+        throw decode_error("trailing data in packet");
+    }
+    m_packets_received.fetch_add(1, std::memory_order_relaxed);
+}
+
 void client::on_tcp_error(asio::error_code error) {
-    MCCPP_E("TCP connect failed: {}", error.message());
+    MCCPP_E("TCP error: {}", error.message());
 }
 
 void client::on_tcp_connect() {
@@ -20,36 +49,27 @@ void client::on_tcp_connect() {
     on_connect();
 }
 
-void client::write_varint(int32_t value) {
-    varint::write(value, [this](std::byte byte) { write_byte(byte); });
+void client::queue_send(std::span<const std::byte> body) {
+    send(encode_frame(body, m_compression_threshold.load(std::memory_order_relaxed)));
 }
 
-void client::queue_send(std::span<const std::byte> body) {
-    // Packets cannot be larger than 2^21 − 1 or 2097151 bytes (the maximum that can be sent in a 3-byte VarInt). For compressed packets, this applies to both the compressed length and uncompressed lengths.
-    if (body.size() > 2097151) {
-        throw encode_error("Packet length exceeded");
-    }
+void client::begin_login() {
+    m_framing_login = true;
+}
+
+void client::frame_login_packet(std::span<const std::byte> packet) {
+    using namespace generated::clientbound;
+
+    packet_reader reader { packet };
 
-    int32_t packet_length = body.size();
-    write_varint(packet_length);
-    write_bytes(body);
-    write_flush();
-
-    //if (m_compress_threshold < 0) {
-    //} else if (m_compress_threshold < body.size()) {
-    //    write_varint(packet_length);
-    //    write_varint(0);
-    //    write_bytes(body);
-    //} else {
-    //    // TODO: Send compressed packet
-    //    abort();
-    //    /*  Pseudo code
-    //     *  auto buffer = compress(body);
-    //     *  write_varint(buffer.size());
-    //     *  write_varint(packet_length);
-    //     *  write_bytes(buffer);
-    //     */
-    //}
+    // Compression has to be enabled before the next packet is framed, so
+    // this can't wait for the handler which may run later on another thread
+    int32_t packet_id = reader.read_varint();
+    if (packet_id == login::login_compression_packet::id) {
+        m_compression_threshold.store(reader.read_varint(), std::memory_order_relaxed);
+    } else if (packet_id == login::game_profile_packet::id) {
+        m_framing_login = false;
+    }
 }
 
 task<int32_t> client::async_read_varint() {
@@ -64,6 +84,34 @@ void client::on_readable() {
     }
 }
 
+class client::receive_queue_awaiter {
+public:
+    bool await_ready() { return !m_client.m_receive_queue.full(); }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        m_client.m_receive_blocked_resume = handle;
+        m_client.m_receive_blocked.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_client.m_receive_queue.full()) {
+            return true;
+        }
+        // poll() made space after the check in await_ready, whoever clears
+        // the flag is responsible for resuming
+        return !m_client.m_receive_blocked.exchange(false);
+    }
+
+    constexpr void await_resume() noexcept {}
+
+private:
+    receive_queue_awaiter(client &c)
+    : m_client(c)
+    {}
+
+    client &m_client;
+
+    friend class client;
+};
+
 task<> client::receiver_task() {
     for (;;) {
         int32_t packet_length = co_await async_read_varint();
@@ -76,15 +124,28 @@ task<> client::receiver_task() {
 
         co_await async_recv_until(packet_length);
 
-        packet_reader reader { [this] {
-            return read_byte();
-        }, size_t(packet_length) };
+        std::vector<std::byte> packet(packet_length);
+        read_bytes(packet);
+
+        if (m_compression_threshold.load(std::memory_order_relaxed) >= 0) {
+            packet = decompress_frame(std::move(packet));
+        }
+        if (m_framing_login) {
+            frame_login_packet(packet);
+        }
+        m_bytes_decoded.fetch_add(packet.size(), std::memory_order_relaxed);
 
-        int32_t packet_id = reader.read_varint();
-        on_packet_received(packet_id, reader);
-        if (reader.remaining() != 0) {
-            throw decode_error("trailing data in packet");
+        if (m_dispatch_mode == dispatch_mode::INLINE) {
+            dispatch(packet);
+            continue;
         }
+
+        // Not reading from the socket while the queue is full pushes
+        // back on the server through TCP flow control
+        co_await receive_queue_awaiter { *this };
+        bool pushed = m_receive_queue.try_push(std::move(packet));
+        assert(pushed);
+        (void)pushed;
     }
 }
 
@@ -1,27 +1,72 @@
 #pragma once
 
+#include <atomic>
+
+#include "codec.hh"
 #include "packet.hh"
 #include "tcp_client.hh"
+#include "../utility/spsc_queue.hh"
 
 namespace mccpp::proto {
 
+// Packets are framed by receiver_task on the thread running the io_context.
+enum class dispatch_mode {
+    // Framed packets are handed over to whichever thread calls poll(),
+    // on_packet_received is only ever called from poll()
+    QUEUED,
+    // on_packet_received is called right away on the io_context, for
+    // headless clients that don't have a separate game thread
+    INLINE,
+};
+
 class client : private tcp_client {
 public:
-    client()
-    : m_receive_task(receiver_task())
+    // Maximum number of framed packets waiting for poll(), when the queue is
+    // full the client stops reading from the socket until poll() catches up.
+    static constexpr size_t DEFAULT_RECEIVE_QUEUE_CAPACITY = 1024;
+
+    client(dispatch_mode mode = dispatch_mode::QUEUED,
+           size_t receive_queue_capacity = DEFAULT_RECEIVE_QUEUE_CAPACITY)
+    : m_dispatch_mode(mode)
+    , m_receive_queue(mode == dispatch_mode::QUEUED ? receive_queue_capacity : 1)
+    , m_receive_task(receiver_task())
     {}
 
     void connect(asio::io_context &, std::string_view address, uint16_t port);
 
+    // Handles all packets received so far, only valid for dispatch_mode::QUEUED
+    void poll();
+
+    using tcp_client::bytes_received;
+    using tcp_client::capture_to;
+    using tcp_client::connect_offline;
+    using tcp_client::feed;
+
+    uint64_t packets_received() const {
+        return m_packets_received.load(std::memory_order_relaxed);
+    }
+
+    // total size of all received packets after decompression
+    uint64_t bytes_decoded() const {
+        return m_bytes_decoded.load(std::memory_order_relaxed);
+    }
+
     template<typename PacketInfo>
     void queue_send(const packet<PacketInfo> &p) {
         packet_writer w {};
+        w.reserve(varint::size(PacketInfo::id) + encoded_size(p));
         w.write_varint(PacketInfo::id);
-        p.write(w);
+        write_fields(w, p);
         queue_send(w);
     }
 
 protected:
+    // Must be called from on_connect before sending login start, the framing
+    // then watches for set compression until login has finished
+    void begin_login();
+
+    using tcp_client::enable_encryption;
+
     virtual void on_error() = 0;
     virtual void on_connect() = 0;
     virtual void on_packet_received(int32_t, packet_reader &) = 0;
@@ -31,14 +76,28 @@ private:
     void on_tcp_connect() override final;
 
     task<int32_t> async_read_varint();
-    void write_varint(int32_t);
 
     void queue_send(std::span<const std::byte> body);
 
     virtual void on_readable() override;
 
+    class receive_queue_awaiter;
+
     task<> receiver_task();
+    void frame_login_packet(std::span<const std::byte> packet);
+    void dispatch(std::span<const std::byte> packet);
 
+    const dispatch_mode m_dispatch_mode;
+    std::atomic<uint64_t> m_packets_received = 0;
+    std::atomic<uint64_t> m_bytes_decoded = 0;
+    // -1 while compression is disabled, set from the io_context
+    std::atomic<int32_t> m_compression_threshold = -1;
+    // only accessed from the io_context
+    bool m_framing_login = false;
+    spsc_queue<std::vector<std::byte>> m_receive_queue;
+    // set by receiver_task while it waits for space in m_receive_queue
+    std::atomic<bool> m_receive_blocked = false;
+    std::coroutine_handle<> m_receive_blocked_resume = nullptr;
     task<> m_receive_task;
 };
 
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "generated/proto/misc.hh"
+#include "generated/proto/clientbound/types.hh"
+#include "../../codec.hh"
+
+namespace mccpp::proto {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Login_Plugin_Request
+template<>
+struct packet<generated::clientbound::login::custom_query_packet> {
+    using packet_type = generated::clientbound::login::custom_query_packet;
+
+    int32_t message_id;
+    std::string channel;
+    std::vector<std::byte> data;
+
+    static constexpr std::tuple fields {
+        field<wire::varint>(&packet::message_id),
+        field<wire::identifier>(&packet::channel),
+        field<wire::rest>(&packet::data),
+    };
+};
+
+}
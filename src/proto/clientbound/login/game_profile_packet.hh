@@ -0,0 +1,41 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "generated/proto/misc.hh"
+#include "generated/proto/clientbound/types.hh"
+#include "../../codec.hh"
+
+namespace mccpp::proto {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Login_Success
+template<>
+struct packet<generated::clientbound::login::game_profile_packet> {
+    using packet_type = generated::clientbound::login::game_profile_packet;
+
+    struct property {
+        std::string name;
+        std::string value;
+        std::optional<std::string> signature;
+
+        static constexpr std::tuple fields {
+            field<wire::string<32767>>(&property::name),
+            field<wire::string<32767>>(&property::value),
+            field<wire::optional<wire::string<32767>>>(&property::signature),
+        };
+    };
+
+    class uuid uuid;
+    std::string username;
+    std::vector<property> properties;
+
+    static constexpr std::tuple fields {
+        field<wire::uuid>(&packet::uuid),
+        field<wire::string<16>>(&packet::username),
+        field<wire::list<wire::object>>(&packet::properties),
+    };
+};
+
+}
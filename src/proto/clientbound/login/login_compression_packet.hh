@@ -0,0 +1,21 @@
+#pragma once
+
+#include "generated/proto/misc.hh"
+#include "generated/proto/clientbound/types.hh"
+#include "../../codec.hh"
+
+namespace mccpp::proto {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Set_Compression
+template<>
+struct packet<generated::clientbound::login::login_compression_packet> {
+    using packet_type = generated::clientbound::login::login_compression_packet;
+
+    int32_t threshold;
+
+    static constexpr std::tuple fields {
+        field<wire::varint>(&packet::threshold),
+    };
+};
+
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "login/custom_query_packet.hh"
+#include "login/game_profile_packet.hh"
+#include "login/login_compression_packet.hh"
+
+#include "play/custom_payload_packet.hh"
+#include "play/keep_alive_packet.hh"
+
+#include "status/pong_response_packet.hh"
+#include "status/status_response_packet.hh"
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "generated/proto/misc.hh"
+#include "generated/proto/clientbound/types.hh"
+#include "../../codec.hh"
+
+namespace mccpp::proto {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Plugin_Message
+template<>
+struct packet<generated::clientbound::play::custom_payload_packet> {
+    using packet_type = generated::clientbound::play::custom_payload_packet;
+
+    std::string channel;
+    std::vector<std::byte> data;
+
+    static constexpr std::tuple fields {
+        field<wire::identifier>(&packet::channel),
+        field<wire::rest>(&packet::data),
+    };
+};
+
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "generated/proto/misc.hh"
+#include "generated/proto/clientbound/types.hh"
+#include "../../codec.hh"
+
+namespace mccpp::proto {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Keep_Alive
+template<>
+struct packet<generated::clientbound::play::keep_alive_packet> {
+    using packet_type = generated::clientbound::play::keep_alive_packet;
+
+    int64_t keep_alive_id;
+
+    static constexpr std::tuple fields {
+        field<wire::i64>(&packet::keep_alive_id),
+    };
+};
+
+}
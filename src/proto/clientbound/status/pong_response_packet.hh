@@ -0,0 +1,21 @@
+#pragma once
+
+#include "generated/proto/misc.hh"
+#include "generated/proto/clientbound/types.hh"
+#include "../../codec.hh"
+
+namespace mccpp::proto {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Ping_Response
+template<>
+struct packet<generated::clientbound::status::pong_response_packet> {
+    using packet_type = generated::clientbound::status::pong_response_packet;
+
+    int64_t payload;
+
+    static constexpr std::tuple fields {
+        field<wire::i64>(&packet::payload),
+    };
+};
+
+}
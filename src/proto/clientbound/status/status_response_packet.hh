@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+
+#include "generated/proto/misc.hh"
+#include "generated/proto/clientbound/types.hh"
+#include "../../codec.hh"
+
+namespace mccpp::proto {
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Status_Response
+template<>
+struct packet<generated::clientbound::status::status_response_packet> {
+    using packet_type = generated::clientbound::status::status_response_packet;
+
+    std::string json_response;
+
+    static constexpr std::tuple fields {
+        field<wire::string<32767>>(&packet::json_response),
+    };
+};
+
+}
@@ -0,0 +1,433 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "exceptions.hh"
+#include "packet.hh"
+#include "varint.hh"
+
+namespace mccpp::proto {
+
+// Packets describe their wire layout with a tuple of member pointers tagged
+// with a wire type, reading, writing and the exact encoded size are derived
+// from it:
+//
+//     static constexpr std::tuple fields {
+//         field<wire::varint>(&packet::protocol_version),
+//         field<wire::string<255>>(&packet::server_address),
+//         field<wire::u16>(&packet::server_port),
+//     };
+//
+// Consecutive fixed size fields form a run that is bounds checked and
+// copied once, then encoded at constant offsets.
+
+template<typename Wire, typename Class, typename T>
+struct field_info {
+    using wire = Wire;
+    T Class::*member;
+};
+
+template<typename Wire, typename Class, typename T>
+constexpr field_info<Wire, Class, T> field(T Class::*member) {
+    return { member };
+}
+
+namespace wire {
+
+// Fixed size wire types have fixed_size and store/load raw bytes, the rest
+// have size/write/read working on the stream
+
+template<typename T>
+struct integer {
+    static constexpr size_t fixed_size = sizeof(T);
+
+    template<typename V>
+    static void store(std::byte *out, V value) {
+        using TU = std::make_unsigned_t<T>;
+        TU v = static_cast<TU>(value);
+        for (size_t i = 0; i < sizeof(T); i++) {
+            out[i] = std::byte(v >> (8 * (sizeof(T) - 1 - i)));
+        }
+    }
+
+    template<typename V>
+    static void load(const std::byte *in, V &out) {
+        using TU = std::make_unsigned_t<T>;
+        TU v = 0;
+        for (size_t i = 0; i < sizeof(T); i++) {
+            v = static_cast<TU>(v << 8 | static_cast<uint8_t>(in[i]));
+        }
+        out = static_cast<V>(std::bit_cast<T>(v));
+    }
+};
+
+using u8 = integer<uint8_t>;
+using u16 = integer<uint16_t>;
+using u32 = integer<uint32_t>;
+using u64 = integer<uint64_t>;
+using i8 = integer<int8_t>;
+using i16 = integer<int16_t>;
+using i32 = integer<int32_t>;
+using i64 = integer<int64_t>;
+
+template<typename T, typename TU>
+struct floating {
+    static constexpr size_t fixed_size = sizeof(T);
+
+    static void store(std::byte *out, T value) {
+        integer<TU>::store(out, std::bit_cast<TU>(value));
+    }
+
+    static void load(const std::byte *in, T &out) {
+        TU v;
+        integer<TU>::load(in, v);
+        out = std::bit_cast<T>(v);
+    }
+};
+
+using f32 = floating<float, uint32_t>;
+using f64 = floating<double, uint64_t>;
+
+struct boolean {
+    static constexpr size_t fixed_size = 1;
+
+    static void store(std::byte *out, bool value) {
+        out[0] = value ? std::byte(0x01) : std::byte(0x00);
+    }
+
+    static void load(const std::byte *in, bool &out) {
+        if (in[0] != std::byte(0x00) && in[0] != std::byte(0x01))
+            throw decode_error("invalid boolean");
+        out = in[0] == std::byte(0x01);
+    }
+};
+
+struct uuid {
+    static constexpr size_t fixed_size = 16;
+
+    static void store(std::byte *out, class mccpp::uuid value) {
+        u64::store(out, value.high());
+        u64::store(out + 8, value.low());
+    }
+
+    static void load(const std::byte *in, class mccpp::uuid &out) {
+        uint64_t high, low;
+        u64::load(in, high);
+        u64::load(in + 8, low);
+        out = { high, low };
+    }
+};
+
+struct position {
+    static constexpr size_t fixed_size = 8;
+
+    static void store(std::byte *out, proto::position value) {
+        u64::store(out, value.raw());
+    }
+
+    static void load(const std::byte *in, proto::position &out) {
+        uint64_t raw;
+        u64::load(in, raw);
+        out = { raw };
+    }
+};
+
+struct varint {
+    template<typename V>
+    static size_t size(V value) {
+        return proto::varint::size(static_cast<int32_t>(value));
+    }
+
+    template<typename V>
+    static void write(packet_writer &s, V value) {
+        s.write_varint(static_cast<int32_t>(value));
+    }
+
+    template<typename V>
+    static void read(packet_reader &s, V &out) {
+        out = static_cast<V>(s.read_varint());
+    }
+};
+
+template<size_t MaxCodePoints>
+struct string {
+    static size_t size(const std::string &value) {
+        return proto::varint::size(static_cast<int32_t>(value.size())) + value.size();
+    }
+
+    static void write(packet_writer &s, const std::string &value) {
+        s.write_string<MaxCodePoints>(value);
+    }
+
+    static void read(packet_reader &s, std::string &out) {
+        out = s.read_string<MaxCodePoints>();
+    }
+};
+
+using identifier = string<32767>;
+
+// Everything up to the end of the packet
+struct rest {
+    static size_t size(const std::vector<std::byte> &value) {
+        return value.size();
+    }
+
+    static void write(packet_writer &s, const std::vector<std::byte> &value) {
+        s.write_bytes(value);
+    }
+
+    static void read(packet_reader &s, std::vector<std::byte> &out) {
+        out = s.read_byte_array(s.remaining());
+    }
+};
+
+// Prefixed with a boolean
+template<typename Wire>
+struct optional;
+
+// Prefixed with a VarInt count
+template<typename Wire>
+struct list;
+
+// A nested struct with its own fields
+struct object;
+
+}
+
+namespace codec_impl {
+
+template<typename Wire>
+concept fixed_size_wire = requires { Wire::fixed_size; };
+
+template<typename Packet>
+using fields_type = std::remove_const_t<decltype(Packet::fields)>;
+
+template<typename Packet>
+constexpr size_t field_count = std::tuple_size_v<fields_type<Packet>>;
+
+template<typename Packet, size_t I>
+using field_wire = typename std::tuple_element_t<I, fields_type<Packet>>::wire;
+
+template<typename Packet, size_t I>
+constexpr auto &member(Packet &p) {
+    return p.*std::get<I>(Packet::fields).member;
+}
+
+template<typename Packet, size_t I>
+constexpr const auto &member(const Packet &p) {
+    return p.*std::get<I>(Packet::fields).member;
+}
+
+template<typename Packet, size_t I>
+consteval size_t fixed_size() {
+    if constexpr (I < field_count<Packet>) {
+        if constexpr (fixed_size_wire<field_wire<Packet, I>>)
+            return field_wire<Packet, I>::fixed_size;
+    }
+    return 0;
+}
+
+// One past the last field of the fixed size run starting at I
+template<typename Packet, size_t I>
+consteval size_t run_end() {
+    if constexpr (fixed_size<Packet, I>() > 0)
+        return run_end<Packet, I + 1>();
+    else
+        return I;
+}
+
+// Bytes taken by the fields [I, J)
+template<typename Packet, size_t I, size_t J>
+consteval size_t run_size() {
+    if constexpr (I >= J)
+        return 0;
+    else
+        return fixed_size<Packet, I>() + run_size<Packet, I + 1, J>();
+}
+
+template<typename Wire, typename V>
+size_t size_of(const V &value) {
+    if constexpr (fixed_size_wire<Wire>)
+        return Wire::fixed_size;
+    else
+        return Wire::size(value);
+}
+
+template<typename Wire, typename V>
+void write_one(packet_writer &s, const V &value) {
+    if constexpr (fixed_size_wire<Wire>)
+        Wire::store(s.append(Wire::fixed_size).data(), value);
+    else
+        Wire::write(s, value);
+}
+
+template<typename Wire, typename V>
+void read_one(packet_reader &s, V &out) {
+    if constexpr (fixed_size_wire<Wire>) {
+        std::array<std::byte, Wire::fixed_size> bytes;
+        s.read_bytes(bytes);
+        Wire::load(bytes.data(), out);
+    } else {
+        Wire::read(s, out);
+    }
+}
+
+template<typename Packet, size_t ...Is>
+size_t encoded_size(const Packet &p, std::index_sequence<Is...>) {
+    return (size_t(0) + ... + size_of<field_wire<Packet, Is>>(member<Packet, Is>(p)));
+}
+
+template<typename Packet, size_t I, size_t ...Ks>
+void store_run(std::byte *out, const Packet &p, std::index_sequence<Ks...>) {
+    (field_wire<Packet, I + Ks>::store(out + run_size<Packet, I, I + Ks>(), member<Packet, I + Ks>(p)), ...);
+}
+
+template<typename Packet, size_t I, size_t ...Ks>
+void load_run(const std::byte *in, Packet &p, std::index_sequence<Ks...>) {
+    (field_wire<Packet, I + Ks>::load(in + run_size<Packet, I, I + Ks>(), member<Packet, I + Ks>(p)), ...);
+}
+
+template<typename Packet, size_t I>
+void write_fields(packet_writer &s, const Packet &p) {
+    if constexpr (I < field_count<Packet>) {
+        constexpr size_t end = run_end<Packet, I>();
+        if constexpr (end == I) {
+            field_wire<Packet, I>::write(s, member<Packet, I>(p));
+            write_fields<Packet, I + 1>(s, p);
+        } else {
+            std::byte *out = s.append(run_size<Packet, I, end>()).data();
+            store_run<Packet, I>(out, p, std::make_index_sequence<end - I>());
+            write_fields<Packet, end>(s, p);
+        }
+    }
+}
+
+template<typename Packet, size_t I>
+void read_fields(packet_reader &s, Packet &p) {
+    if constexpr (I < field_count<Packet>) {
+        constexpr size_t end = run_end<Packet, I>();
+        if constexpr (end == I) {
+            field_wire<Packet, I>::read(s, member<Packet, I>(p));
+            read_fields<Packet, I + 1>(s, p);
+        } else {
+            std::array<std::byte, run_size<Packet, I, end>()> bytes;
+            s.read_bytes(bytes);
+            load_run<Packet, I>(bytes.data(), p, std::make_index_sequence<end - I>());
+            read_fields<Packet, end>(s, p);
+        }
+    }
+}
+
+}
+
+// Exact number of bytes write_fields produces
+template<typename Packet>
+size_t encoded_size(const Packet &p) {
+    return codec_impl::encoded_size(p, std::make_index_sequence<codec_impl::field_count<Packet>>());
+}
+
+template<typename Packet>
+void write_fields(packet_writer &s, const Packet &p) {
+    codec_impl::write_fields<Packet, 0>(s, p);
+}
+
+template<typename Packet>
+void read_fields(packet_reader &s, Packet &p) {
+    codec_impl::read_fields<Packet, 0>(s, p);
+}
+
+template<typename PacketInfo>
+packet<PacketInfo> read_packet(packet_reader &s) {
+    packet<PacketInfo> p {};
+    read_fields(s, p);
+    return p;
+}
+
+namespace wire {
+
+template<typename Wire>
+struct optional {
+    template<typename V>
+    static size_t size(const std::optional<V> &value) {
+        return 1 + (value.has_value() ? codec_impl::size_of<Wire>(*value) : 0);
+    }
+
+    template<typename V>
+    static void write(packet_writer &s, const std::optional<V> &value) {
+        s.write_bool(value.has_value());
+        if (value.has_value())
+            codec_impl::write_one<Wire>(s, *value);
+    }
+
+    template<typename V>
+    static void read(packet_reader &s, std::optional<V> &out) {
+        out.reset();
+        if (s.read_bool())
+            codec_impl::read_one<Wire>(s, out.emplace());
+    }
+};
+
+template<typename Wire>
+struct list {
+    template<typename V>
+    static size_t size(const std::vector<V> &value) {
+        size_t size = proto::varint::size(static_cast<int32_t>(value.size()));
+        if constexpr (codec_impl::fixed_size_wire<Wire>) {
+            size += value.size() * Wire::fixed_size;
+        } else {
+            for (const V &v : value)
+                size += codec_impl::size_of<Wire>(v);
+        }
+        return size;
+    }
+
+    template<typename V>
+    static void write(packet_writer &s, const std::vector<V> &value) {
+        s.write_varint(static_cast<int32_t>(value.size()));
+        for (const V &v : value)
+            codec_impl::write_one<Wire>(s, v);
+    }
+
+    template<typename V>
+    static void read(packet_reader &s, std::vector<V> &out) {
+        int32_t count = s.read_varint();
+        // every element takes at least a byte, don't let the count alone
+        // allocate more than the packet could hold
+        if (count < 0 || static_cast<size_t>(count) > s.remaining())
+            throw decode_error("invalid list length");
+        out.clear();
+        out.reserve(count);
+        while (count-- > 0)
+            codec_impl::read_one<Wire>(s, out.emplace_back());
+    }
+};
+
+struct object {
+    template<typename V>
+    static size_t size(const V &value) {
+        return encoded_size(value);
+    }
+
+    template<typename V>
+    static void write(packet_writer &s, const V &value) {
+        write_fields(s, value);
+    }
+
+    template<typename V>
+    static void read(packet_reader &s, V &out) {
+        read_fields(s, out);
+    }
+};
+
+}
+
+}
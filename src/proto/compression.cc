@@ -0,0 +1,100 @@
+#include "compression.hh"
+
+#include <zlib.h>
+
+#include "exceptions.hh"
+#include "varint.hh"
+
+namespace mccpp::proto {
+
+std::vector<std::byte> deflate(std::span<const std::byte> data) {
+    uLongf length = compressBound(data.size());
+    std::vector<std::byte> out(length);
+    int result = compress2(reinterpret_cast<Bytef *>(out.data()), &length,
+                           reinterpret_cast<const Bytef *>(data.data()), data.size(),
+                           Z_DEFAULT_COMPRESSION);
+    if (result != Z_OK) {
+        throw encode_error("failed to compress packet");
+    }
+    out.resize(length);
+    return out;
+}
+
+void inflate(std::span<const std::byte> data, std::span<std::byte> out) {
+    uLongf length = out.size();
+    int result = uncompress(reinterpret_cast<Bytef *>(out.data()), &length,
+                            reinterpret_cast<const Bytef *>(data.data()), data.size());
+    if (result != Z_OK) {
+        throw decode_error("failed to decompress packet");
+    }
+    if (length != out.size()) {
+        throw decode_error("decompressed packet length mismatch");
+    }
+}
+
+std::vector<std::byte> encode_frame(std::span<const std::byte> body, int32_t compression_threshold) {
+    // Packets cannot be larger than 2^21 − 1 or 2097151 bytes (the maximum that can be sent in a 3-byte VarInt). For compressed packets, this applies to both the compressed length and uncompressed lengths.
+    if (body.size() > 2097151) {
+        throw encode_error("Packet length exceeded");
+    }
+
+    std::vector<std::byte> frame {};
+    auto write_varint = [&frame](int32_t value) {
+        varint::write(value, [&frame](std::byte byte) { frame.emplace_back(byte); });
+    };
+
+    int32_t packet_length = body.size();
+    if (compression_threshold < 0) {
+        frame.reserve(body.size() + 3);
+        write_varint(packet_length);
+        frame.insert(frame.end(), body.begin(), body.end());
+    } else if (packet_length < compression_threshold) {
+        frame.reserve(body.size() + 4);
+        // the data length of 0 takes a single byte
+        write_varint(packet_length + 1);
+        write_varint(0);
+        frame.insert(frame.end(), body.begin(), body.end());
+    } else {
+        std::vector<std::byte> compressed = deflate(body);
+        std::vector<std::byte> data_length {};
+        varint::write(packet_length, [&data_length](std::byte byte) { data_length.emplace_back(byte); });
+        if (data_length.size() + compressed.size() > 2097151) {
+            throw encode_error("Packet length exceeded");
+        }
+        frame.reserve(data_length.size() + compressed.size() + 3);
+        write_varint(data_length.size() + compressed.size());
+        frame.insert(frame.end(), data_length.begin(), data_length.end());
+        frame.insert(frame.end(), compressed.begin(), compressed.end());
+    }
+    return frame;
+}
+
+std::vector<std::byte> decompress_frame(std::vector<std::byte> &&frame) {
+    const std::byte *data = frame.data();
+    size_t remaining = frame.size();
+    int32_t data_length = varint::read([&data, &remaining] {
+        if (remaining == 0) {
+            throw decode_error("truncated compressed packet");
+        }
+        remaining--;
+        return *data++;
+    });
+    size_t header_length = frame.size() - remaining;
+
+    if (data_length == 0) {
+        frame.erase(frame.begin(), frame.begin() + header_length);
+        return std::move(frame);
+    }
+    if (data_length < 0) {
+        throw decode_error("invalid data length (too low)");
+    }
+    if (data_length > 2097151) {
+        throw decode_error("invalid data length (too high)");
+    }
+
+    std::vector<std::byte> packet(data_length);
+    inflate(std::span(frame).subspan(header_length), packet);
+    return packet;
+}
+
+}
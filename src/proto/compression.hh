@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace mccpp::proto {
+
+// zlib streams as used by compressed packets
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#With_compression
+
+std::vector<std::byte> deflate(std::span<const std::byte> data);
+
+// out must be exactly the size of the uncompressed data
+void inflate(std::span<const std::byte> data, std::span<std::byte> out);
+
+// Prefixes a packet body with its length, compressing it when the threshold
+// is reached. A negative threshold means compression is disabled.
+std::vector<std::byte> encode_frame(std::span<const std::byte> body, int32_t compression_threshold);
+
+// Turns the contents of a compressed frame (everything after the packet
+// length) back into the packet body
+std::vector<std::byte> decompress_frame(std::vector<std::byte> &&frame);
+
+}
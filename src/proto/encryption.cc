@@ -0,0 +1,256 @@
+#include "encryption.hh"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MCCPP_HAS_AESNI 1
+#include <immintrin.h>
+#endif
+
+namespace mccpp::proto {
+
+// FIPS-197
+static constexpr std::array<uint8_t, 256> SBOX = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+static constexpr uint8_t xtime(uint8_t x) {
+    return uint8_t((x << 1) ^ ((x >> 7) * 0x1b));
+}
+
+static constexpr uint32_t rotr(uint32_t x, unsigned n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+// SubBytes, ShiftRows and MixColumns combined into four lookups per column
+static constexpr std::array<std::array<uint32_t, 256>, 4> TE = [] {
+    std::array<std::array<uint32_t, 256>, 4> te {};
+    for (size_t i = 0; i < 256; i++) {
+        uint8_t s = SBOX[i];
+        uint8_t s2 = xtime(s);
+        uint8_t s3 = s2 ^ s;
+        uint32_t t = uint32_t(s2) << 24 | uint32_t(s) << 16 | uint32_t(s) << 8 | s3;
+        te[0][i] = t;
+        te[1][i] = rotr(t, 8);
+        te[2][i] = rotr(t, 16);
+        te[3][i] = rotr(t, 24);
+    }
+    return te;
+}();
+
+static uint32_t load_be(const uint8_t *p) {
+    return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | p[3];
+}
+
+static void store_be(uint8_t *p, uint32_t v) {
+    p[0] = uint8_t(v >> 24);
+    p[1] = uint8_t(v >> 16);
+    p[2] = uint8_t(v >> 8);
+    p[3] = uint8_t(v);
+}
+
+#ifdef MCCPP_HAS_AESNI
+static bool cpu_has_aesni() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("aes") && __builtin_cpu_supports("sse2");
+}
+#else
+static bool cpu_has_aesni() {
+    return false;
+}
+#endif
+
+aes128::aes128(const aes_key &key) {
+    constexpr std::array<uint8_t, 10> RCON = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36 };
+
+    for (size_t i = 0; i < 4; i++) {
+        m_round_keys[i] = load_be(reinterpret_cast<const uint8_t *>(key.data()) + i * 4);
+    }
+    for (size_t i = 4; i < 44; i++) {
+        uint32_t temp = m_round_keys[i - 1];
+        if (i % 4 == 0) {
+            temp = rotr(temp, 24);
+            temp = uint32_t(SBOX[temp >> 24]) << 24 | uint32_t(SBOX[temp >> 16 & 0xff]) << 16
+                 | uint32_t(SBOX[temp >> 8 & 0xff]) << 8 | SBOX[temp & 0xff];
+            temp ^= uint32_t(RCON[i / 4 - 1]) << 24;
+        }
+        m_round_keys[i] = m_round_keys[i - 4] ^ temp;
+    }
+    for (size_t i = 0; i < 44; i++) {
+        store_be(m_round_key_bytes.data() + i * 4, m_round_keys[i]);
+    }
+
+    m_accelerated = cpu_has_aesni();
+    m_xor_first_bytes = m_accelerated ? xor_first_bytes_aesni : xor_first_bytes_portable;
+}
+
+void aes128::disable_acceleration() {
+    m_accelerated = false;
+    m_xor_first_bytes = xor_first_bytes_portable;
+}
+
+void aes128::encrypt_block(const uint8_t *in, uint8_t *out) const {
+    const uint32_t *rk = m_round_keys.data();
+    uint32_t s0 = load_be(in + 0) ^ rk[0];
+    uint32_t s1 = load_be(in + 4) ^ rk[1];
+    uint32_t s2 = load_be(in + 8) ^ rk[2];
+    uint32_t s3 = load_be(in + 12) ^ rk[3];
+
+    for (size_t round = 1; round < 10; round++) {
+        rk += 4;
+        uint32_t t0 = TE[0][s0 >> 24] ^ TE[1][s1 >> 16 & 0xff] ^ TE[2][s2 >> 8 & 0xff] ^ TE[3][s3 & 0xff] ^ rk[0];
+        uint32_t t1 = TE[0][s1 >> 24] ^ TE[1][s2 >> 16 & 0xff] ^ TE[2][s3 >> 8 & 0xff] ^ TE[3][s0 & 0xff] ^ rk[1];
+        uint32_t t2 = TE[0][s2 >> 24] ^ TE[1][s3 >> 16 & 0xff] ^ TE[2][s0 >> 8 & 0xff] ^ TE[3][s1 & 0xff] ^ rk[2];
+        uint32_t t3 = TE[0][s3 >> 24] ^ TE[1][s0 >> 16 & 0xff] ^ TE[2][s1 >> 8 & 0xff] ^ TE[3][s2 & 0xff] ^ rk[3];
+        s0 = t0;
+        s1 = t1;
+        s2 = t2;
+        s3 = t3;
+    }
+
+    // the last round has no MixColumns
+    rk += 4;
+    auto last = [](uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+        return uint32_t(SBOX[a >> 24]) << 24 | uint32_t(SBOX[b >> 16 & 0xff]) << 16
+             | uint32_t(SBOX[c >> 8 & 0xff]) << 8 | SBOX[d & 0xff];
+    };
+    store_be(out + 0, last(s0, s1, s2, s3) ^ rk[0]);
+    store_be(out + 4, last(s1, s2, s3, s0) ^ rk[1]);
+    store_be(out + 8, last(s2, s3, s0, s1) ^ rk[2]);
+    store_be(out + 12, last(s3, s0, s1, s2) ^ rk[3]);
+}
+
+void aes128::xor_first_bytes_portable(const aes128 &aes, const uint8_t *in, uint8_t *out, size_t count) {
+    std::array<uint8_t, 16> block;
+    for (size_t i = count; i-- > 0;) {
+        aes.encrypt_block(in + i, block.data());
+        out[i] ^= block[0];
+    }
+}
+
+#ifdef MCCPP_HAS_AESNI
+__attribute__((target("aes,sse2")))
+void aes128::xor_first_bytes_aesni(const aes128 &aes, const uint8_t *in, uint8_t *out, size_t count) {
+    // aesenc has a latency of several cycles but a throughput of one or two
+    // per cycle, so independent blocks are interleaved to keep it busy
+    constexpr size_t LANES = 8;
+
+    __m128i rk[11];
+    for (size_t i = 0; i < 11; i++) {
+        rk[i] = _mm_load_si128(reinterpret_cast<const __m128i *>(aes.m_round_key_bytes.data() + i * 16));
+    }
+
+    size_t i = count;
+    while (i >= LANES) {
+        i -= LANES;
+        // every input is loaded before any output is written since they can overlap
+        __m128i b[LANES];
+        for (size_t lane = 0; lane < LANES; lane++) {
+            b[lane] = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + lane)), rk[0]);
+        }
+        for (size_t round = 1; round < 10; round++) {
+            for (size_t lane = 0; lane < LANES; lane++) {
+                b[lane] = _mm_aesenc_si128(b[lane], rk[round]);
+            }
+        }
+        for (size_t lane = 0; lane < LANES; lane++) {
+            b[lane] = _mm_aesenclast_si128(b[lane], rk[10]);
+        }
+        for (size_t lane = 0; lane < LANES; lane++) {
+            out[i + lane] ^= uint8_t(_mm_cvtsi128_si32(b[lane]));
+        }
+    }
+    while (i-- > 0) {
+        __m128i b = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i)), rk[0]);
+        for (size_t round = 1; round < 10; round++) {
+            b = _mm_aesenc_si128(b, rk[round]);
+        }
+        b = _mm_aesenclast_si128(b, rk[10]);
+        out[i] ^= uint8_t(_mm_cvtsi128_si32(b));
+    }
+}
+#else
+void aes128::xor_first_bytes_aesni(const aes128 &aes, const uint8_t *in, uint8_t *out, size_t count) {
+    xor_first_bytes_portable(aes, in, out, count);
+}
+#endif
+
+cfb8_encryptor::cfb8_encryptor(const aes_key &key, const aes_key &iv)
+: m_aes(key)
+{
+    std::memcpy(m_register.data(), iv.data(), iv.size());
+}
+
+void cfb8_encryptor::encrypt(std::span<std::byte> data) {
+    constexpr size_t BATCH = 256;
+    // the shift register followed by the ciphertext produced so far
+    std::array<uint8_t, 16 + BATCH> window;
+    std::memcpy(window.data(), m_register.data(), 16);
+
+    uint8_t *p = reinterpret_cast<uint8_t *>(data.data());
+    size_t remaining = data.size();
+    while (remaining > 0) {
+        size_t n = std::min(remaining, BATCH);
+        for (size_t i = 0; i < n; i++) {
+            // each byte needs the previous ciphertext byte, no way around that
+            m_aes.xor_first_bytes(window.data() + i, p + i, 1);
+            window[16 + i] = p[i];
+        }
+        std::memmove(window.data(), window.data() + n, 16);
+        p += n;
+        remaining -= n;
+    }
+    std::memcpy(m_register.data(), window.data(), 16);
+}
+
+cfb8_decryptor::cfb8_decryptor(const aes_key &key, const aes_key &iv)
+: m_aes(key)
+{
+    std::memcpy(m_register.data(), iv.data(), iv.size());
+}
+
+void cfb8_decryptor::decrypt(std::span<std::byte> data) {
+    uint8_t *p = reinterpret_cast<uint8_t *>(data.data());
+    size_t n = data.size();
+    if (n == 0)
+        return;
+
+    // the first 16 bytes depend on ciphertext from before this call
+    size_t head_count = std::min<size_t>(n, 16);
+    std::array<uint8_t, 32> head;
+    std::memcpy(head.data(), m_register.data(), 16);
+    std::memcpy(head.data() + 16, p, head_count);
+
+    std::array<uint8_t, 16> next_register;
+    if (n >= 16) {
+        std::memcpy(next_register.data(), p + n - 16, 16);
+    } else {
+        std::memcpy(next_register.data(), head.data() + n, 16);
+    }
+
+    // decrypting backwards means every input is still ciphertext when read
+    if (n > 16) {
+        m_aes.xor_first_bytes(p, p + 16, n - 16);
+    }
+    m_aes.xor_first_bytes(head.data(), p, head_count);
+
+    m_register = next_register;
+}
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace mccpp::proto {
+
+// AES-128 in CFB8 mode, the protocol uses the shared secret as both the key
+// and the IV once encryption is enabled.
+// https://wiki.vg/index.php?title=Protocol_Encryption&oldid=17941
+using aes_key = std::array<std::byte, 16>;
+
+class aes128 {
+public:
+    explicit aes128(const aes_key &key);
+
+    // Only the first byte of each encrypted block is needed by CFB8.
+    // Computes out[i] ^= AES(in[i .. i + 16])[0] for every i < count, going
+    // backwards so out may overlap in as long as out >= in + 16.
+    void xor_first_bytes(const uint8_t *in, uint8_t *out, size_t count) const {
+        m_xor_first_bytes(*this, in, out, count);
+    }
+
+    void encrypt_block(const uint8_t *in, uint8_t *out) const;
+
+    // false when AES-NI isn't available or was disabled, for tests
+    bool accelerated() const { return m_accelerated; }
+    void disable_acceleration();
+
+private:
+    using xor_first_bytes_fn = void (*)(const aes128 &, const uint8_t *, uint8_t *, size_t);
+
+    static void xor_first_bytes_portable(const aes128 &, const uint8_t *, uint8_t *, size_t);
+    static void xor_first_bytes_aesni(const aes128 &, const uint8_t *, uint8_t *, size_t);
+
+    // round keys as bytes for AES-NI and as big endian words for the tables
+    alignas(16) std::array<uint8_t, 176> m_round_key_bytes;
+    std::array<uint32_t, 44> m_round_keys;
+    xor_first_bytes_fn m_xor_first_bytes;
+    bool m_accelerated;
+};
+
+// Encryption is inherently byte serial, it is only used for the few
+// packets the client sends
+class cfb8_encryptor {
+public:
+    cfb8_encryptor(const aes_key &key, const aes_key &iv);
+
+    void encrypt(std::span<std::byte> data);
+
+private:
+    aes128 m_aes;
+    // the last 16 bytes of ciphertext
+    std::array<uint8_t, 16> m_register;
+};
+
+// Every plaintext byte only depends on the 16 ciphertext bytes before it, so
+// a whole read is decrypted at once with the AES rounds of many bytes
+// interleaved
+class cfb8_decryptor {
+public:
+    cfb8_decryptor(const aes_key &key, const aes_key &iv);
+
+    void decrypt(std::span<std::byte> data);
+
+    aes128 &cipher() { return m_aes; }
+
+private:
+    aes128 m_aes;
+    // the last 16 bytes of ciphertext
+    std::array<uint8_t, 16> m_register;
+};
+
+}
@@ -1,11 +1,71 @@
 #include "packet.hh"
 
+#include <algorithm>
+#include <array>
+#include <bit>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MCCPP_HAS_SSSE3 1
+#include <immintrin.h>
+#endif
+
 // https://wiki.vg/Protocol
 
 #include "varint.hh"
 
 namespace mccpp::proto {
 
+#ifdef MCCPP_HAS_SSSE3
+static bool cpu_has_ssse3() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3");
+}
+
+// Reverses every Size byte lane, 16 bytes per shuffle
+template<size_t Size>
+__attribute__((target("ssse3")))
+static size_t byteswap_ssse3(std::byte *data, size_t n) {
+    alignas(16) std::array<uint8_t, 16> order {};
+    for (size_t i = 0; i < 16; i++) {
+        order[i] = uint8_t(i - i % Size + Size - 1 - i % Size);
+    }
+    __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i *>(order.data()));
+    size_t done = 0;
+    for (; done + 16 <= n; done += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + done));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(data + done), _mm_shuffle_epi8(v, mask));
+    }
+    return done;
+}
+#else
+static bool cpu_has_ssse3() {
+    return false;
+}
+
+template<size_t Size>
+static size_t byteswap_ssse3(std::byte *, size_t) {
+    return 0;
+}
+#endif
+
+// Converts big endian elements to native order in place
+template<typename T>
+static void from_big_endian(std::span<T> values) {
+    if constexpr (std::endian::native == std::endian::big)
+        return;
+
+    static const bool ssse3 = cpu_has_ssse3();
+    size_t done = 0;
+    if (ssse3)
+        done = byteswap_ssse3<sizeof(T)>(reinterpret_cast<std::byte *>(values.data()), values.size_bytes()) / sizeof(T);
+    for (T &v : values.subspan(done)) {
+        if constexpr (sizeof(T) == 4)
+            v = static_cast<T>(__builtin_bswap32(static_cast<uint32_t>(v)));
+        else
+            v = static_cast<T>(__builtin_bswap64(static_cast<uint64_t>(v)));
+    }
+}
+
 void packet_writer::write_varint(int32_t value) {
     varint::write(value, [this](std::byte byte) {
         m_buffer.emplace_back(byte);
@@ -81,23 +141,35 @@ void packet_writer::write_string(std::string_view value, size_t max_code_points)
 }
 
 void packet_reader::discard(size_t n) {
-    assert(m_remaining >= n);
+    if (m_remaining < n) {
+        throw decode_error("packet too short");
+    }
     m_remaining -= n;
+    if (m_data) {
+        m_data += n;
+        return;
+    }
     while (n-- > 0) {
         m_read_byte();
     }
 }
 
 std::byte packet_reader::read_byte() {
-    assert(m_remaining > 0);
+    if (m_remaining == 0) {
+        throw decode_error("packet too short");
+    }
     m_remaining--;
-    return m_read_byte();
+    return next_byte();
 }
 
 int32_t packet_reader::read_varint() {
     return varint::read([this] { return read_byte(); });
 }
 
+int64_t packet_reader::read_varlong() {
+    return varlong::read([this] { return read_byte(); });
+}
+
 bool packet_reader::read_bool() {
     std::byte b = read_byte();
     if (b == std::byte(0x00)) {
@@ -150,8 +222,15 @@ double packet_reader::read_double() {
 }
 
 std::vector<std::byte> packet_reader::read_byte_array(size_t n) {
-    assert(m_remaining >= n);
+    if (m_remaining < n) {
+        throw decode_error("packet too short");
+    }
     m_remaining -= n;
+    if (m_data) {
+        std::vector<std::byte> data(m_data, m_data + n);
+        m_data += n;
+        return data;
+    }
     std::vector<std::byte> data {};
     data.reserve(n);
     while (n-- > 0)
@@ -159,6 +238,43 @@ std::vector<std::byte> packet_reader::read_byte_array(size_t n) {
     return data;
 }
 
+void packet_reader::read_bytes(std::span<std::byte> out) {
+    if (m_remaining < out.size()) {
+        throw decode_error("packet too short");
+    }
+    m_remaining -= out.size();
+    if (m_data) {
+        std::copy_n(m_data, out.size(), out.begin());
+        m_data += out.size();
+        return;
+    }
+    for (std::byte &b : out)
+        b = m_read_byte();
+}
+
+void packet_reader::read_i32_array(std::span<int32_t> out) {
+    read_bytes(std::as_writable_bytes(out));
+    from_big_endian(out);
+}
+
+void packet_reader::read_i64_array(std::span<int64_t> out) {
+    read_bytes(std::as_writable_bytes(out));
+    from_big_endian(out);
+}
+
+packet_reader packet_reader::take(size_t n) {
+    if (m_remaining < n) {
+        throw decode_error("packet too short");
+    }
+    m_remaining -= n;
+    if (m_data) {
+        packet_reader reader({ m_data, n });
+        m_data += n;
+        return reader;
+    }
+    return { [this] { return m_read_byte(); }, n };
+}
+
 template<typename T>
 T packet_reader::read_int_n() {
     using TU = std::make_unsigned_t<T>;
@@ -172,18 +288,29 @@ T packet_reader::read_int_n() {
 
 template<typename T>
 T packet_reader::read_float_n() {
-    assert(m_remaining >= sizeof(T));
+    if (m_remaining < sizeof(T)) {
+        throw decode_error("packet too short");
+    }
     m_remaining -= sizeof(T);
 
     std::byte bytes[sizeof(T)];
     for (size_t i = 0; i < sizeof(T); i++) {
-        bytes[sizeof(T) - i - 1] = m_read_byte();
+        bytes[sizeof(T) - i - 1] = next_byte();
     }
     return std::bit_cast<T>(bytes);
 }
 
 std::string packet_reader::read_char_array(size_t length) {
     // FIXME: Correctly verify that each length in code points doesn't exceed the max
+    if (m_data) {
+        if (m_remaining < length) {
+            throw decode_error("packet too short");
+        }
+        std::string s(reinterpret_cast<const char *>(m_data), length);
+        m_data += length;
+        m_remaining -= length;
+        return s;
+    }
     std::string s;
     s.reserve(length);
     for (; length > 0; length--) {
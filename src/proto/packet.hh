@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <functional>
+#include <optional>
 #include <span>
 #include <string_view>
 #include <string>
@@ -91,6 +92,17 @@ public:
         write_string(str, MaxCodePoints);
     }
 
+    void reserve(size_t n) {
+        m_buffer.reserve(m_buffer.size() + n);
+    }
+
+    // Grows the packet by n bytes for the caller to fill in
+    std::span<std::byte> append(size_t n) {
+        size_t offset = m_buffer.size();
+        m_buffer.resize(offset + n);
+        return std::span(m_buffer).subspan(offset);
+    }
+
     operator std::span<const std::byte>() const {
         return m_buffer;
     }
@@ -116,6 +128,13 @@ public:
     , m_read_byte(std::move(read_byte))
     {}
 
+    // Reads straight from memory, discarding and bulk reads don't go byte by
+    // byte. data must outlive the reader.
+    explicit packet_reader(std::span<const std::byte> data)
+    : m_remaining(data.size())
+    , m_data(data.data())
+    {}
+
     size_t remaining() { return m_remaining; }
     void discard(size_t);
     void discard_bitset() {
@@ -123,11 +142,12 @@ public:
         if (count < 0) {
             throw decode_error("invalid count for bitset");
         }
-        discard(count * 8);
+        discard(static_cast<size_t>(count) * 8);
     }
 
     std::byte read_byte();
     int32_t read_varint();
+    int64_t read_varlong();
     bool read_bool();
     uint8_t read_u8();
     uint16_t read_u16();
@@ -142,6 +162,8 @@ public:
 
     std::string read_identifier() { return read_string<32767>(); }
     position read_position() { return { read_u64() }; }
+    // Steps of 1/256 of a turn, in degrees
+    float read_angle() { return read_u8() * (360.f / 256.f); }
 
     uuid read_uuid() {
         uint64_t high = read_u64();
@@ -157,6 +179,22 @@ public:
 
     std::vector<std::byte> read_byte_array(size_t n);
     std::string read_char_array(size_t n);
+    // Throws a decode_error if fewer than out.size() bytes are left
+    void read_bytes(std::span<std::byte> out);
+    // Bulk reads of big endian arrays, same errors as read_bytes()
+    void read_i32_array(std::span<int32_t> out);
+    void read_i64_array(std::span<int64_t> out);
+
+    // Splits the next n bytes off into a reader of their own which must not
+    // outlive this one
+    packet_reader take(size_t n);
+
+    // Everything not read yet, only available when reading from memory
+    std::optional<std::span<const std::byte>> unread() const {
+        if (!m_data)
+            return std::nullopt;
+        return std::span(m_data, m_remaining);
+    }
 
 private:
     template<typename T>
@@ -167,7 +205,14 @@ private:
 
     std::string read_string(size_t max_code_points);
 
+    // Callers check m_remaining first
+    std::byte next_byte() {
+        return m_data ? *m_data++ : m_read_byte();
+    }
+
     size_t m_remaining;
+    // set when reading from memory, m_read_byte is used otherwise
+    const std::byte *m_data = nullptr;
     read_byte_fn m_read_byte;
 };
 
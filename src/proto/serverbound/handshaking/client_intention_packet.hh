@@ -5,7 +5,7 @@
 
 #include "generated/proto/misc.hh"
 #include "generated/proto/serverbound/types.hh"
-#include "../../packet.hh"
+#include "../../codec.hh"
 
 namespace mccpp::proto {
 
@@ -25,12 +25,12 @@ struct packet<generated::serverbound::handshaking::client_intention_packet> {
     uint16_t server_port;
     next_state next_state;
 
-    void write(packet_writer &s) const {
-        s.write_varint(protocol_version);
-        s.write_string<255>(server_address);
-        s.write_u16(server_port);
-        s.write_varint(next_state);
-    }
+    static constexpr std::tuple fields {
+        field<wire::varint>(&packet::protocol_version),
+        field<wire::string<255>>(&packet::server_address),
+        field<wire::u16>(&packet::server_port),
+        field<wire::varint>(&packet::next_state),
+    };
 };
 
 }
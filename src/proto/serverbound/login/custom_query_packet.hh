@@ -5,7 +5,7 @@
 
 #include "generated/proto/misc.hh"
 #include "generated/proto/serverbound/types.hh"
-#include "../../packet.hh"
+#include "../../codec.hh"
 
 namespace mccpp::proto {
 
@@ -15,11 +15,13 @@ struct packet<generated::serverbound::login::custom_query_packet> {
     using packet_type = generated::serverbound::login::custom_query_packet;
 
     int32_t message_id;
+    // empty when the channel isn't understood
+    std::optional<std::vector<std::byte>> data;
 
-    void write(packet_writer &s) const {
-        s.write_varint(message_id);
-        s.write_bool(false);
-    }
+    static constexpr std::tuple fields {
+        field<wire::varint>(&packet::message_id),
+        field<wire::optional<wire::rest>>(&packet::data),
+    };
 };
 
 }
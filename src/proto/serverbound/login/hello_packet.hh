@@ -5,7 +5,7 @@
 
 #include "generated/proto/misc.hh"
 #include "generated/proto/serverbound/types.hh"
-#include "../../packet.hh"
+#include "../../codec.hh"
 
 namespace mccpp::proto {
 
@@ -17,12 +17,10 @@ struct packet<generated::serverbound::login::hello_packet> {
     std::string name;
     std::optional<class uuid> uuid;
 
-    void write(packet_writer &s) const {
-        s.write_string<16>(name);
-        s.write_bool(uuid.has_value());
-        if (uuid.has_value())
-            s.write_uuid(*uuid);
-    }
+    static constexpr std::tuple fields {
+        field<wire::string<16>>(&packet::name),
+        field<wire::optional<wire::uuid>>(&packet::uuid),
+    };
 };
 
 }
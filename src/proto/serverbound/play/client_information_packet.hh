@@ -2,7 +2,7 @@
 
 #include "generated/proto/misc.hh"
 #include "generated/proto/serverbound/types.hh"
-#include "../../packet.hh"
+#include "../../codec.hh"
 
 namespace mccpp::proto {
 
@@ -20,16 +20,16 @@ struct packet<generated::serverbound::play::client_information_packet> {
     bool enable_text_filtering;
     bool allow_server_listings;
 
-    void write(packet_writer &s) const {
-        s.write_string<16>(locale);
-        s.write_i8(view_distance);
-        s.write_varint(chat_mode);
-        s.write_bool(chat_colors);
-        s.write_u8(displayed_skin_parts);
-        s.write_varint(main_hand);
-        s.write_bool(enable_text_filtering);
-        s.write_bool(allow_server_listings);
-    }
+    static constexpr std::tuple fields {
+        field<wire::string<16>>(&packet::locale),
+        field<wire::i8>(&packet::view_distance),
+        field<wire::varint>(&packet::chat_mode),
+        field<wire::boolean>(&packet::chat_colors),
+        field<wire::u8>(&packet::displayed_skin_parts),
+        field<wire::varint>(&packet::main_hand),
+        field<wire::boolean>(&packet::enable_text_filtering),
+        field<wire::boolean>(&packet::allow_server_listings),
+    };
 };
 
 }
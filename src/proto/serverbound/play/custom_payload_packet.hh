@@ -2,7 +2,7 @@
 
 #include "generated/proto/misc.hh"
 #include "generated/proto/serverbound/types.hh"
-#include "../../packet.hh"
+#include "../../codec.hh"
 
 namespace mccpp::proto {
 
@@ -14,10 +14,10 @@ struct packet<generated::serverbound::play::custom_payload_packet> {
     std::string channel;
     std::vector<std::byte> data;
 
-    void write(packet_writer &s) const {
-        s.write_identifier(channel);
-        s.write_bytes(data);
-    }
+    static constexpr std::tuple fields {
+        field<wire::identifier>(&packet::channel),
+        field<wire::rest>(&packet::data),
+    };
 };
 
 }
@@ -2,7 +2,7 @@
 
 #include "generated/proto/misc.hh"
 #include "generated/proto/serverbound/types.hh"
-#include "../../packet.hh"
+#include "../../codec.hh"
 
 namespace mccpp::proto {
 
@@ -13,9 +13,9 @@ struct packet<generated::serverbound::play::keep_alive_packet> {
 
     int64_t keep_alive_id;
 
-    void write(packet_writer &s) const {
-        s.write_i64(keep_alive_id);
-    }
+    static constexpr std::tuple fields {
+        field<wire::i64>(&packet::keep_alive_id),
+    };
 };
 
 }
@@ -2,7 +2,7 @@
 
 #include "generated/proto/misc.hh"
 #include "generated/proto/serverbound/types.hh"
-#include "../../packet.hh"
+#include "../../codec.hh"
 
 namespace mccpp::proto {
 
@@ -13,9 +13,9 @@ struct packet<generated::serverbound::status::ping_request_packet> {
 
     int64_t payload;
 
-    void write(packet_writer &s) const {
-        s.write_i64(payload);
-    }
+    static constexpr std::tuple fields {
+        field<wire::i64>(&packet::payload),
+    };
 };
 
 }
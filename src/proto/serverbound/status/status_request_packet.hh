@@ -2,7 +2,7 @@
 
 #include "generated/proto/misc.hh"
 #include "generated/proto/serverbound/types.hh"
-#include "../../packet.hh"
+#include "../../codec.hh"
 
 namespace mccpp::proto {
 
@@ -11,8 +11,7 @@ template<>
 struct packet<generated::serverbound::status::status_request_packet> {
     using packet_type = generated::serverbound::status::status_request_packet;
 
-    void write(packet_writer &) const {
-    }
+    static constexpr std::tuple<> fields {};
 };
 
 }
@@ -1,18 +1,49 @@
 #include "tcp_client.hh"
 
+#include <algorithm>
+
 #include "../logger.hh"
 
 namespace mccpp::proto {
 
 void tcp_client::connect(asio::io_context &io, tcp::endpoint endpoint) {
-    m_socket.emplace(io);
-    // TODO: Make async
-    m_socket->connect(endpoint);
+    // Every handler of this connection goes through the strand so that the
+    // io_context can be run from multiple threads
+    m_socket.emplace(asio::make_strand(io));
+    m_socket->async_connect(endpoint, [this](const asio::error_code &error) {
+        if (error) {
+            on_tcp_error(error);
+            return;
+        }
+        on_tcp_connect();
+    });
+}
+
+void tcp_client::connect_offline() {
+    assert(!m_socket);
     on_tcp_connect();
 }
 
+void tcp_client::feed(std::span<const std::byte> data) {
+    assert(offline());
+    while (!data.empty()) {
+        if (m_read_buffer.m_buffer.writable() == 0) {
+            // only happens when nothing is waiting for the data
+            m_read_buffer.m_buffer.reserve(std::max(m_read_buffer.m_buffer.capacity() * 2, buffer::INITIAL_CAPACITY));
+        }
+        std::span<std::byte> front = m_read_buffer.m_buffer.write_front();
+        std::span<std::byte> back = m_read_buffer.m_buffer.write_back();
+        size_t front_count = std::min(front.size(), data.size());
+        size_t back_count = std::min(back.size(), data.size() - front_count);
+        std::copy_n(data.begin(), front_count, front.begin());
+        std::copy_n(data.begin() + front_count, back_count, back.begin());
+        data = data.subspan(front_count + back_count);
+        m_read_buffer.on_received(front_count + back_count);
+    }
+}
+
 task<> tcp_client::async_recv_until(size_t n) {
-    assert(n <= m_read_buffer.capacity());
+    m_read_buffer.require(n);
 
     struct {
         constexpr bool await_ready() noexcept { return false; }
@@ -27,27 +58,73 @@ task<> tcp_client::async_recv_until(size_t n) {
     while (m_read_buffer.readable() < n) {
         co_await awaiter;
     }
+    m_read_buffer.require(0);
 }
 
-void tcp_client::write_bytes(std::span<const std::byte> bytes) {
-    m_write_buffer.insert(m_write_buffer.end(), bytes.begin(), bytes.end());
+void tcp_client::enable_encryption(const aes_key &shared_secret) {
+    // captures are already decrypted
+    if (offline())
+        return;
+    // Posted like send() so that anything queued before is still sent in the clear
+    asio::post(m_socket->get_executor(), [this, shared_secret] {
+        m_encryptor = std::make_unique<cfb8_encryptor>(shared_secret, shared_secret);
+        m_decryptor = std::make_unique<cfb8_decryptor>(shared_secret, shared_secret);
+    });
 }
 
-void tcp_client::write_flush() {
-    // FIXME: Flush write buffer asynchronously
-    for (size_t offset = 0; offset < m_write_buffer.size();) {
-        offset += m_socket->write_some(asio::buffer(m_write_buffer.data() + offset, m_write_buffer.size() - offset));
-    }
-    m_write_buffer.clear();
+void tcp_client::send(std::vector<std::byte> &&data) {
+    if (offline())
+        return;
+    asio::post(m_socket->get_executor(), [this, data = std::move(data)]() mutable {
+        if (m_encryptor) {
+            m_encryptor->encrypt(data);
+        }
+        m_write_queue.emplace_back(std::move(data));
+        if (m_write_queue.size() == 1) {
+            start_write();
+        }
+    });
+}
+
+void tcp_client::start_write() {
+    assert(!m_write_queue.empty());
+    asio::async_write(*m_socket, asio::buffer(m_write_queue.front()),
+        [this](const asio::error_code &error, std::size_t)
+    {
+        if (error) {
+            // nothing queued after this can be sent either
+            m_write_queue.clear();
+            asio::error_code ignored;
+            m_socket->close(ignored);
+            on_tcp_error(error);
+            return;
+        }
+        m_write_queue.pop_front();
+        if (!m_write_queue.empty()) {
+            start_write();
+        }
+    });
 }
 
 static asio::mutable_buffer span_to_asio(std::span<std::byte> buf) {
     return { buf.data(), buf.size() };
 }
 
+void tcp_client::buffer::require(size_t n) {
+    m_required = n;
+    m_buffer.reserve(n);
+}
+
 void tcp_client::buffer::resume_on_readable(std::coroutine_handle<> h) {
     assert(!m_resume);
     m_resume = h;
+    if (m_buffer.capacity() == 0) {
+        m_buffer.reserve(INITIAL_CAPACITY);
+    } else {
+        m_buffer.shrink(std::max(m_required, INITIAL_CAPACITY));
+    }
+    if (m_client.offline())
+        return;
     asio::mutable_buffer front = span_to_asio(m_buffer.write_front());
     asio::mutable_buffer back = span_to_asio(m_buffer.write_back());
     m_client.m_socket->async_read_some(std::array {front, back},
@@ -60,21 +137,48 @@ void tcp_client::buffer::resume_on_readable(std::coroutine_handle<> h) {
             MCCPP_E("read failed: {}", error.message());
             // FIXME: throw error
         } else {
-            m_buffer.mark_write(bytes_read);
-            if (m_resume) {
-                std::coroutine_handle<> handle = m_resume;
-                m_resume = nullptr;
-                handle.resume();
+            std::span<std::byte> front = m_buffer.write_front();
+            size_t front_count = std::min(front.size(), bytes_read);
+            front = front.first(front_count);
+            std::span<std::byte> back = m_buffer.write_back().first(bytes_read - front_count);
+            if (m_client.m_decryptor) {
+                m_client.m_decryptor->decrypt(front);
+                m_client.m_decryptor->decrypt(back);
+            }
+            // captures are stored decrypted so they replay without the secret
+            if (m_client.m_capture) {
+                m_client.m_capture->write(front, back);
             }
-            m_client.on_readable();
+            on_received(bytes_read);
         }
     });
 }
 
+void tcp_client::buffer::on_received(size_t n) {
+    m_buffer.mark_write(n);
+    m_client.m_bytes_received.fetch_add(n, std::memory_order_relaxed);
+    m_client.m_reads_completed.fetch_add(1, std::memory_order_relaxed);
+    if (m_resume) {
+        std::coroutine_handle<> handle = m_resume;
+        m_resume = nullptr;
+        handle.resume();
+    }
+    m_client.on_readable();
+}
+
 std::byte tcp_client::buffer::pop_front() {
     std::byte b = m_buffer.front();
     m_buffer.erase(1);
     return b;
 }
 
+void tcp_client::buffer::pop_front(std::span<std::byte> out) {
+    assert(m_buffer.readable() >= out.size());
+    std::span<const std::byte> front = m_buffer.read_front();
+    size_t front_count = std::min(front.size(), out.size());
+    std::copy_n(front.begin(), front_count, out.begin());
+    std::copy_n(m_buffer.read_back().begin(), out.size() - front_count, out.begin() + front_count);
+    m_buffer.erase(out.size());
+}
+
 }
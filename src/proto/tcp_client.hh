@@ -1,11 +1,17 @@
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <span>
+#include <vector>
 
 #include <asio.hpp>
 
 #include "../utility/coro.hh"
 #include "../utility/ring_buffer.hh"
+#include "capture.hh"
+#include "encryption.hh"
 
 namespace mccpp::proto {
 
@@ -35,15 +41,43 @@ public:
 
     void connect(asio::io_context &, tcp::endpoint);
 
+    // Acts as if connected without a socket, received data then only comes
+    // from feed() and everything sent is dropped. Used to replay captures.
+    void connect_offline();
+    void feed(std::span<const std::byte>);
+
+    // Everything sent and received after this call is AES/CFB8 encrypted with
+    // the shared secret as key and IV, safe to call from any thread
+    void enable_encryption(const aes_key &shared_secret);
+
+    // Writes all received data to a capture file, must be set before connecting
+    void capture_to(std::unique_ptr<capture_writer> capture) {
+        m_capture = std::move(capture);
+    }
+
     std::byte read_byte() { return m_read_buffer.pop_front(); }
+    void read_bytes(std::span<std::byte> out) { m_read_buffer.pop_front(out); }
     reader async_read_byte() { return { *this }; }
     task<> async_recv_until(size_t n);
 
-    void write_bytes(std::span<const std::byte>);
-    void write_byte(std::byte b) { write_bytes({ &b, 1 }); }
-    void write_flush();
+    // Queues data to be written from the io_context, safe to call from any thread
+    void send(std::vector<std::byte> &&);
+
+    tcp::socket::executor_type executor() { return m_socket->get_executor(); }
+    bool offline() const { return !m_socket; }
+
+    uint64_t bytes_received() const {
+        return m_bytes_received.load(std::memory_order_relaxed);
+    }
+
+    // completed socket reads, bytes_received() / reads_completed() is how
+    // much each wakeup delivered on average
+    uint64_t reads_completed() const {
+        return m_reads_completed.load(std::memory_order_relaxed);
+    }
 
 protected:
+    // Connecting or writing failed, after a write error the socket is closed
     virtual void on_tcp_error(asio::error_code) = 0;
     virtual void on_tcp_connect() = 0;
     virtual void on_readable() = 0;
@@ -51,10 +85,17 @@ protected:
 private:
     class buffer {
     public:
+        // Receive buffers start out at this size and only grow while a
+        // larger async_recv_until is pending, shrinking back afterwards
+        static constexpr size_t INITIAL_CAPACITY = 64 * 1024;
+
         size_t capacity() { return m_buffer.capacity(); }
         size_t readable() { return m_buffer.readable(); }
+        void require(size_t n);
         void resume_on_readable(std::coroutine_handle<> h);
         std::byte pop_front();
+        void pop_front(std::span<std::byte>);
+        void on_received(size_t n);
 
         buffer(tcp_client &c)
         : m_client(c)
@@ -63,13 +104,23 @@ private:
     private:
         tcp_client &m_client;
 
-        ring_buffer<2097151> m_buffer;
+        ring_buffer m_buffer;
+        size_t m_required = 0;
         std::coroutine_handle<> m_resume = nullptr;
         friend class tcp_client;
     } m_read_buffer = { *this };
 
+    void start_write();
+
     std::optional<tcp::socket> m_socket;
-    std::vector<std::byte> m_write_buffer;
+    std::unique_ptr<capture_writer> m_capture;
+    // only accessed from the io_context
+    std::unique_ptr<cfb8_encryptor> m_encryptor;
+    std::unique_ptr<cfb8_decryptor> m_decryptor;
+    std::atomic<uint64_t> m_bytes_received = 0;
+    std::atomic<uint64_t> m_reads_completed = 0;
+    // only accessed from the io_context
+    std::deque<std::vector<std::byte>> m_write_queue;
 };
 
 }
@@ -81,6 +81,17 @@ namespace varint_impl {
 }
 
 namespace varint {
+    // Number of bytes write() produces
+    constexpr size_t size(int32_t value) {
+        uint32_t v = std::bit_cast<uint32_t>(value);
+        size_t size = 1;
+        while (v & ~uint32_t(varint_impl::SEGMENT_BITS)) {
+            v >>= 7;
+            size++;
+        }
+        return size;
+    }
+
     template<typename T>
     void write(int32_t value, T &&write_byte_callback) {
         varint_impl::write_impl<int32_t>(value, std::move(write_byte_callback));
@@ -21,6 +21,7 @@
 #include "../resource/texture.hh"
 #include "../utility/misc.hh"
 #include "../utility/scope_guard.hh"
+#include "../world/biome.hh"
 #include "../world/chunk.hh"
 #include "../cvar.hh"
 #include "shader.hh"
@@ -101,7 +102,15 @@ static bool should_draw_face(const resource::model_face &face) {
     return face.cullface != resource::model_cullface::ALWAYS;
 }
 
-static void generate_model_mesh(resource::model model, std::vector<vertex> &vertices, std::vector<unsigned> &indicies) {
+// Faces with a tintindex get the colour the block's colour handler picks,
+// which tint stands in for
+static glm::vec3 face_color(const resource::model_face &face, glm::vec3 normal, glm::vec3 tint) {
+    glm::vec3 color(normal * 0.5f + 0.5f);
+    return face.tintindex >= 0 ? color * tint : color;
+}
+
+static void generate_model_mesh(resource::model model, std::vector<vertex> &vertices, std::vector<unsigned> &indicies,
+                                glm::vec3 tint = glm::vec3(1.f)) {
     using namespace resource;
 
     model->debug_dump();
@@ -130,7 +139,7 @@ static void generate_model_mesh(resource::model model, std::vector<vertex> &vert
         };
         if (should_draw_face(elem.down)) {
             glm::vec3 normal = transform(0, -1, 0);
-            glm::vec3 color(normal * 0.5f + 0.5f);
+            glm::vec3 color = face_color(elem.down, normal, tint);
             vertices.emplace_back(transform(from.x, from.y, from.z), normal, color, glm::vec2(0, 0));
             vertices.emplace_back(transform(to.x,   from.y, from.z), normal, color, glm::vec2(1, 0));
             vertices.emplace_back(transform(from.x, from.y, to.z),   normal, color, glm::vec2(0, 1));
@@ -145,7 +154,7 @@ static void generate_model_mesh(resource::model model, std::vector<vertex> &vert
         }
         if (should_draw_face(elem.up)) {
             glm::vec3 normal = transform(0, 1, 0);
-            glm::vec3 color(normal * 0.5f + 0.5f);
+            glm::vec3 color = face_color(elem.up, normal, tint);
             vertices.emplace_back(transform(from.x, to.y, from.z), normal, color, glm::vec2(0, 0));
             vertices.emplace_back(transform(from.x, to.y, to.z),   normal, color, glm::vec2(0, 1));
             vertices.emplace_back(transform(to.x,   to.y, from.z), normal, color, glm::vec2(1, 0));
@@ -160,7 +169,7 @@ static void generate_model_mesh(resource::model model, std::vector<vertex> &vert
         }
         if (should_draw_face(elem.north)) {
             glm::vec3 normal = transform(0, 0, -1);
-            glm::vec3 color(normal * 0.5f + 0.5f);
+            glm::vec3 color = face_color(elem.north, normal, tint);
             vertices.emplace_back(transform(from.x, from.y, from.z), normal, color, glm::vec2(0, 0));
             vertices.emplace_back(transform(from.x, to.y,   from.z), normal, color, glm::vec2(1, 0));
             vertices.emplace_back(transform(to.x,   from.y, from.z), normal, color, glm::vec2(0, 1));
@@ -175,7 +184,7 @@ static void generate_model_mesh(resource::model model, std::vector<vertex> &vert
         }
         if (should_draw_face(elem.south)) {
             glm::vec3 normal = transform(0, 0, 1);
-            glm::vec3 color(normal * 0.5f + 0.5f);
+            glm::vec3 color = face_color(elem.south, normal, tint);
             vertices.emplace_back(transform(from.x, from.y, to.z), normal, color, glm::vec2(0, 0));
             vertices.emplace_back(transform(to.x,   from.y, to.z), normal, color, glm::vec2(0, 1));
             vertices.emplace_back(transform(from.x, to.y,   to.z), normal, color, glm::vec2(1, 0));
@@ -190,7 +199,7 @@ static void generate_model_mesh(resource::model model, std::vector<vertex> &vert
         }
         if (should_draw_face(elem.east)) {
             glm::vec3 normal = transform(1, 0, 0);
-            glm::vec3 color(normal * 0.5f + 0.5f);
+            glm::vec3 color = face_color(elem.east, normal, tint);
             vertices.emplace_back(transform(to.x, from.y, from.z), normal, color, glm::vec2(0, 0));
             vertices.emplace_back(transform(to.x, to.y,   from.z), normal, color, glm::vec2(1, 0));
             vertices.emplace_back(transform(to.x, from.y, to.z),   normal, color, glm::vec2(0, 1));
@@ -205,7 +214,7 @@ static void generate_model_mesh(resource::model model, std::vector<vertex> &vert
         }
         if (should_draw_face(elem.west)) {
             glm::vec3 normal = transform(-1, 0, 0);
-            glm::vec3 color(normal * 0.5f + 0.5f);
+            glm::vec3 color = face_color(elem.west, normal, tint);
             vertices.emplace_back(transform(from.x, from.y, from.z), normal, color, glm::vec2(0, 0));
             vertices.emplace_back(transform(from.x, from.y, to.z),   normal, color, glm::vec2(0, 1));
             vertices.emplace_back(transform(from.x, to.y,   from.z), normal, color, glm::vec2(1, 0));
@@ -347,7 +356,9 @@ renderer_impl::renderer_impl(application &app)
     for (vertex &vert : m_vertices) {
         vert.position.y -= 1;
     }
-    generate_model_mesh(m_resource_manager.models()["block/fern"], m_vertices, m_indicies);
+    // ferns are tinted like grass
+    generate_model_mesh(m_resource_manager.models()["block/fern"], m_vertices, m_indicies,
+                        world::unpack_color(world::grass_color(world::biome {})));
 
     SDL_ShowWindow(m_window);
 }
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace mccpp {
+
+// Open addressing hash map from 64 bit keys, linear probing over one flat
+// array so a lookup is a hash and usually a single cache line. Values must be
+// default constructible and cheap to move, pointers to them are invalidated
+// by insertion and erasure.
+template<typename T>
+class flat_u64_map {
+public:
+    flat_u64_map() = default;
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    size_t capacity() const { return m_slots.size(); }
+
+    T *find(uint64_t key) {
+        if (m_size == 0)
+            return nullptr;
+        for (size_t i = home(key);; i = next(i)) {
+            slot &s = m_slots[i];
+            if (!s.used)
+                return nullptr;
+            if (s.key == key)
+                return &s.value;
+        }
+    }
+
+    // Returns the value for key and whether it was inserted
+    std::pair<T *, bool> emplace(uint64_t key, T &&value) {
+        if ((m_size + 1) * 8 > m_slots.size() * 7)
+            rehash(m_slots.empty() ? 16 : m_slots.size() * 2);
+        size_t i = home(key);
+        for (; m_slots[i].used; i = next(i)) {
+            if (m_slots[i].key == key)
+                return { &m_slots[i].value, false };
+        }
+        m_slots[i].used = true;
+        m_slots[i].key = key;
+        m_slots[i].value = std::move(value);
+        m_size++;
+        return { &m_slots[i].value, true };
+    }
+
+    // Moves the value out and removes the entry, default value when missing
+    T take(uint64_t key) {
+        if (m_size == 0)
+            return T {};
+        size_t i = home(key);
+        for (; m_slots[i].used; i = next(i)) {
+            if (m_slots[i].key == key)
+                break;
+        }
+        if (!m_slots[i].used)
+            return T {};
+        T value = std::move(m_slots[i].value);
+
+        // shift the rest of the cluster back so no tombstones are needed
+        for (size_t j = next(i); m_slots[j].used; j = next(j)) {
+            // j can fill the hole unless its home is cyclically within (i, j]
+            size_t h = home(m_slots[j].key);
+            bool stays = i <= j ? (i < h && h <= j) : (i < h || h <= j);
+            if (!stays) {
+                m_slots[i].key = m_slots[j].key;
+                m_slots[i].value = std::move(m_slots[j].value);
+                i = j;
+            }
+        }
+        m_slots[i].used = false;
+        m_slots[i].value = T {};
+        m_size--;
+        return value;
+    }
+
+    bool erase(uint64_t key) {
+        size_t before = m_size;
+        take(key);
+        return m_size != before;
+    }
+
+    template<typename F>
+    void for_each(F &&f) {
+        for (slot &s : m_slots) {
+            if (s.used)
+                f(s.key, s.value);
+        }
+    }
+
+private:
+    struct slot {
+        uint64_t key = 0;
+        T value {};
+        bool used = false;
+    };
+
+    size_t home(uint64_t key) const {
+        // the splitmix64 finalizer, packed coordinates differ only in few bits
+        key ^= key >> 30;
+        key *= 0xbf58476d1ce4e5b9;
+        key ^= key >> 27;
+        key *= 0x94d049bb133111eb;
+        key ^= key >> 31;
+        return key & (m_slots.size() - 1);
+    }
+
+    size_t next(size_t i) const { return (i + 1) & (m_slots.size() - 1); }
+
+    void rehash(size_t capacity) {
+        std::vector<slot> old = std::exchange(m_slots, std::vector<slot>(std::bit_ceil(capacity)));
+        m_size = 0;
+        for (slot &s : old) {
+            if (s.used)
+                emplace(s.key, std::move(s.value));
+        }
+    }
+
+    std::vector<slot> m_slots;
+    size_t m_size = 0;
+};
+
+}
@@ -1,21 +1,28 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <span>
 
+#include "slab_pool.hh"
+
 namespace mccpp {
 
-template<size_t N>
+// Byte ring buffer backed by a slab_pool allocation, the capacity is always
+// a power of two and only changes through reserve() and shrink().
 class ring_buffer {
 public:
     ring_buffer() = default;
-    ~ring_buffer() = default;
+
+    ~ring_buffer() {
+        slab_pool::shared().deallocate(m_data);
+    }
 
     ring_buffer(const ring_buffer &) = delete;
 
     size_t capacity() const {
-        return N;
+        return m_data.size();
     }
 
     size_t readable() const {
@@ -23,40 +30,40 @@ public:
     }
 
     size_t writable() const {
-        return N - readable();
+        return capacity() - readable();
     }
 
     std::byte front() const {
         assert(readable() >= 1);
-        return m_data[m_read % N];
+        return m_data[wrap(m_read)];
     }
 
     std::span<const std::byte> read_front() const {
-        size_t start = m_read % N;
+        size_t start = wrap(m_read);
         size_t total = readable();
-        size_t count = clamp(total, N - start);
-        return { &m_data[start], count };
+        size_t count = clamp(total, capacity() - start);
+        return { m_data.data() + start, count };
     }
 
     std::span<const std::byte> read_back() const {
-        size_t start = m_read % N;
+        size_t start = wrap(m_read);
         size_t total = readable();
-        size_t count = clamp(total, N - start);
-        return { &m_data[0], total - count };
+        size_t count = clamp(total, capacity() - start);
+        return { m_data.data(), total - count };
     }
 
     std::span<std::byte> write_front() {
-        size_t start = m_written % N;
+        size_t start = wrap(m_written);
         size_t total = writable();
-        size_t count = clamp(total, N - start);
-        return { &m_data[start], count };
+        size_t count = clamp(total, capacity() - start);
+        return { m_data.data() + start, count };
     }
 
     std::span<std::byte> write_back() {
-        size_t start = m_written % N;
+        size_t start = wrap(m_written);
         size_t total = writable();
-        size_t count = clamp(total, N - start);
-        return { &m_data[0], total - count };
+        size_t count = clamp(total, capacity() - start);
+        return { m_data.data(), total - count };
     }
 
     void mark_write(size_t n) {
@@ -69,14 +76,47 @@ public:
         m_read += n;
     }
 
+    // Grows the buffer so that at least n bytes fit
+    void reserve(size_t n) {
+        if (n > capacity()) {
+            reallocate(slab_pool::slab_size(n));
+        }
+    }
+
+    // Gives memory back to the pool once the buffer is at least four times
+    // larger than what is needed to hold n bytes and the current contents
+    void shrink(size_t n) {
+        size_t wanted = slab_pool::slab_size(std::max(n, readable()));
+        if (capacity() >= wanted * 4) {
+            reallocate(wanted);
+        }
+    }
+
 private:
     static size_t clamp(size_t v, size_t h) {
         return v > h ? h : v;
     }
 
+    size_t wrap(size_t offset) const {
+        return offset & (capacity() - 1);
+    }
+
+    void reallocate(size_t new_capacity) {
+        assert(new_capacity >= readable());
+        std::span<std::byte> data = slab_pool::shared().allocate(new_capacity);
+        std::span<const std::byte> front = read_front();
+        std::span<const std::byte> back = read_back();
+        std::copy(front.begin(), front.end(), data.begin());
+        std::copy(back.begin(), back.end(), data.begin() + front.size());
+        slab_pool::shared().deallocate(m_data);
+        m_data = data;
+        m_written = readable();
+        m_read = 0;
+    }
+
     size_t m_read = 0;
     size_t m_written = 0;
-    std::byte m_data[N];
+    std::span<std::byte> m_data;
 };
 
 }
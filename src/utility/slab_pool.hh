@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <span>
+#include <vector>
+
+namespace mccpp {
+
+// Thread safe cache of large power of two sized allocations, used for buffers
+// that grow and shrink often so that many connections can share the memory
+// instead of each one holding on to its peak size. Slabs larger than
+// MAX_SLAB_SIZE are plain allocations that aren't cached.
+class slab_pool {
+public:
+    static constexpr size_t MIN_SLAB_SIZE = 64 * 1024;
+    static constexpr size_t MAX_SLAB_SIZE = 4 * 1024 * 1024;
+    // free slabs kept around per size class before memory is given back
+    static constexpr size_t MAX_CACHED_BYTES = 16 * 1024 * 1024;
+
+    slab_pool() = default;
+    slab_pool(const slab_pool &) = delete;
+
+    ~slab_pool() {
+        for (size_t i = 0; i < CLASS_COUNT; i++) {
+            for (std::byte *slab : m_free[i]) {
+                ::operator delete(slab, class_size(i), SLAB_ALIGNMENT);
+            }
+        }
+    }
+
+    static slab_pool &shared() {
+        static slab_pool pool;
+        return pool;
+    }
+
+    // Size of the slab that allocate(size) would return
+    static size_t slab_size(size_t size) {
+        if (size > MAX_SLAB_SIZE)
+            return std::bit_ceil(size);
+        return class_size(size_to_class(size));
+    }
+
+    std::span<std::byte> allocate(size_t size) {
+        if (size > MAX_SLAB_SIZE) {
+            size = std::bit_ceil(size);
+            return { static_cast<std::byte *>(::operator new(size, SLAB_ALIGNMENT)), size };
+        }
+        size_t index = size_to_class(size);
+        {
+            std::lock_guard lock(m_mutex);
+            std::vector<std::byte *> &free = m_free[index];
+            if (!free.empty()) {
+                std::byte *slab = free.back();
+                free.pop_back();
+                return { slab, class_size(index) };
+            }
+        }
+        void *slab = ::operator new(class_size(index), SLAB_ALIGNMENT);
+        return { static_cast<std::byte *>(slab), class_size(index) };
+    }
+
+    void deallocate(std::span<std::byte> slab) {
+        if (slab.empty())
+            return;
+        if (slab.size() > MAX_SLAB_SIZE) {
+            ::operator delete(slab.data(), slab.size(), SLAB_ALIGNMENT);
+            return;
+        }
+        size_t index = size_to_class(slab.size());
+        assert(class_size(index) == slab.size());
+        {
+            std::lock_guard lock(m_mutex);
+            std::vector<std::byte *> &free = m_free[index];
+            if ((free.size() + 1) * slab.size() <= MAX_CACHED_BYTES) {
+                free.emplace_back(slab.data());
+                return;
+            }
+        }
+        ::operator delete(slab.data(), slab.size(), SLAB_ALIGNMENT);
+    }
+
+private:
+    static constexpr std::align_val_t SLAB_ALIGNMENT { 64 };
+    static constexpr size_t CLASS_COUNT = std::countr_zero(MAX_SLAB_SIZE / MIN_SLAB_SIZE) + 1;
+
+    static size_t size_to_class(size_t size) {
+        assert(size <= MAX_SLAB_SIZE);
+        if (size <= MIN_SLAB_SIZE)
+            return 0;
+        return std::countr_zero(std::bit_ceil(size) / MIN_SLAB_SIZE);
+    }
+
+    static constexpr size_t class_size(size_t index) {
+        return MIN_SLAB_SIZE << index;
+    }
+
+    std::mutex m_mutex;
+    std::array<std::vector<std::byte *>, CLASS_COUNT> m_free;
+};
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+namespace mccpp {
+
+// Bounded lock-free queue for handing values from exactly one producer
+// thread to exactly one consumer thread
+template<typename T>
+class spsc_queue {
+public:
+    explicit spsc_queue(size_t capacity)
+    : m_capacity(capacity)
+    , m_data(std::make_unique<std::optional<T>[]>(capacity))
+    {
+        assert(capacity > 0);
+    }
+
+    spsc_queue(const spsc_queue &) = delete;
+
+    size_t capacity() const {
+        return m_capacity;
+    }
+
+    // only exact when called from either the producer or the consumer
+    size_t size() const {
+        return m_written.load(std::memory_order_acquire) - m_read.load(std::memory_order_acquire);
+    }
+
+    bool full() const {
+        return size() >= m_capacity;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    // producer only
+    bool try_push(T &&value) {
+        size_t written = m_written.load(std::memory_order_relaxed);
+        if (written - m_read.load(std::memory_order_acquire) >= m_capacity)
+            return false;
+        m_data[written % m_capacity].emplace(std::move(value));
+        m_written.store(written + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer only
+    std::optional<T> try_pop() {
+        size_t read = m_read.load(std::memory_order_relaxed);
+        if (read == m_written.load(std::memory_order_acquire))
+            return std::nullopt;
+        std::optional<T> &slot = m_data[read % m_capacity];
+        std::optional<T> value = std::move(slot);
+        slot.reset();
+        m_read.store(read + 1, std::memory_order_release);
+        return value;
+    }
+
+private:
+    // keep the producer and consumer counters on separate cache lines
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    const size_t m_capacity;
+    std::unique_ptr<std::optional<T>[]> m_data;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_read = 0;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_written = 0;
+};
+
+}
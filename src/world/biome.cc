@@ -0,0 +1,136 @@
+#include "biome.hh"
+
+#include <algorithm>
+
+namespace mccpp::world {
+
+// What water without a colour from the server looks like
+static constexpr uint32_t DEFAULT_WATER_COLOR = 0x3f76e4;
+
+// The colormaps are a triangle, hot and wet, hot and dry and cold corners,
+// everything in between is close to a blend of those
+static uint32_t colormap(float temperature, float downfall, uint32_t hot_wet, uint32_t hot_dry, uint32_t cold) {
+    float t = std::min(std::max(temperature, 0.f), 1.f);
+    float d = std::min(std::max(downfall, 0.f), 1.f) * t;
+    glm::vec3 color = d * unpack_color(hot_wet) + (t - d) * unpack_color(hot_dry) + (1.f - t) * unpack_color(cold);
+    uint32_t rgb = 0;
+    for (int c = 0; c < 3; c++) {
+        rgb = rgb << 8 | static_cast<uint32_t>(color[c] * 255.f + 0.5f);
+    }
+    return rgb;
+}
+
+uint32_t grass_color(const biome &b) {
+    if (b.grass_color)
+        return *b.grass_color;
+    return colormap(b.temperature, b.downfall, 0x47cd33, 0xbfb755, 0x80b497);
+}
+
+uint32_t foliage_color(const biome &b) {
+    if (b.foliage_color)
+        return *b.foliage_color;
+    return colormap(b.temperature, b.downfall, 0x1abf00, 0xaea42a, 0x60a17b);
+}
+
+biome_blender::biome_blender(std::span<const biome> biomes) {
+    biome plains {};
+    m_fallback = { grass_color(plains), foliage_color(plains), DEFAULT_WATER_COLOR };
+    m_colors.reserve(biomes.size());
+    for (const biome &b : biomes) {
+        if (b.name.empty())
+            m_colors.emplace_back(m_fallback);
+        else
+            m_colors.emplace_back(colors { grass_color(b), foliage_color(b), b.water_color });
+    }
+}
+
+void biome_blender::set_radius(int radius) {
+    m_radius = std::min(std::max(radius, 0), MAX_RADIUS);
+}
+
+// Biome of the top block, or of the bottom of the world when there is none
+static biome_id surface_biome(chunk_column &column, int x, int z) {
+    int y = std::max<int>(column.heightmaps().world_surface.at(x, z), 1) - 1;
+    return column[y >> 4].biome_at(x, y & 15, z);
+}
+
+column_tints biome_blender::blend(chunk_manager &chunks, int32_t chunk_x, int32_t chunk_z) const {
+    // Summed area tables over the blocks within reach, one plane per channel:
+    // red, green and blue of every colour and the number of blocks from
+    // loaded columns. Planes keep the passes over them plain loops.
+    constexpr size_t CHANNELS = 10;
+    int r = m_radius;
+    size_t stride = 16 + 2 * r + 1;
+    size_t plane = stride * stride;
+    std::vector<int32_t> table(CHANNELS * plane);
+
+    int reach = r == 0 ? 0 : 1;
+    for (int dz = -reach; dz <= reach; dz++) {
+        for (int dx = -reach; dx <= reach; dx++) {
+            chunk_column *column = chunks.try_get(chunk_x + dx, chunk_z + dz);
+            if (!column)
+                continue;
+            // the blocks of the column that are within reach
+            int min_x = std::max(0, -r - dx * 16);
+            int max_x = std::min(15, 15 + r - dx * 16);
+            int min_z = std::max(0, -r - dz * 16);
+            int max_z = std::min(15, 15 + r - dz * 16);
+            for (int z = min_z; z <= max_z; z++) {
+                for (int x = min_x; x <= max_x; x++) {
+                    const colors &c = colors_of(surface_biome(*column, x, z));
+                    int32_t *sample = &table[size_t(dz * 16 + z + r + 1) * stride + size_t(dx * 16 + x + r + 1)];
+                    size_t i = 0;
+                    for (uint32_t rgb : { c.grass, c.foliage, c.water }) {
+                        sample[i++ * plane] = rgb >> 16 & 0xff;
+                        sample[i++ * plane] = rgb >> 8 & 0xff;
+                        sample[i++ * plane] = rgb & 0xff;
+                    }
+                    sample[i * plane] = 1;
+                }
+            }
+        }
+    }
+    for (size_t c = 0; c < CHANNELS; c++) {
+        int32_t *t = &table[c * plane];
+        for (size_t z = 1; z < stride; z++) {
+            int32_t row = 0;
+            for (size_t x = 1; x < stride; x++) {
+                row += t[z * stride + x];
+                t[z * stride + x] = row + t[(z - 1) * stride + x];
+            }
+        }
+    }
+
+    // sums over the square around every block
+    size_t side = 2 * r + 1;
+    std::array<std::array<int32_t, 256>, CHANNELS> sums;
+    for (size_t c = 0; c < CHANNELS; c++) {
+        const int32_t *t = &table[c * plane];
+        for (size_t z = 0; z < 16; z++) {
+            const int32_t *low = t + z * stride;
+            const int32_t *high = t + (z + side) * stride;
+            for (size_t x = 0; x < 16; x++) {
+                sums[c][z * 16 + x] = high[x + side] - high[x] - low[x + side] + low[x];
+            }
+        }
+    }
+
+    column_tints tints;
+    for (size_t i = 0; i < 256; i++) {
+        // the block itself is always counted, floats hold the sums exactly
+        float scale = 1.f / float(sums[CHANNELS - 1][i]);
+        auto average = [&](size_t first) {
+            uint32_t rgb = 0;
+            for (size_t c = first; c < first + 3; c++) {
+                rgb = rgb << 8 | static_cast<uint32_t>(float(sums[c][i]) * scale + 0.5f);
+            }
+            return rgb;
+        };
+        tints.grass[i] = average(0);
+        tints.foliage[i] = average(3);
+        tints.water[i] = average(6);
+    }
+    return tints;
+}
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "chunk.hh"
+
+namespace mccpp::world {
+
+// Entry of the minecraft:worldgen/biome registry sent on login
+struct biome {
+    std::string name;
+    float temperature = 0.8f;
+    float downfall = 0.4f;
+    // 0xRRGGBB
+    uint32_t sky_color = 0;
+    uint32_t fog_color = 0;
+    uint32_t water_color = 0;
+    uint32_t water_fog_color = 0;
+    // Derived from temperature and downfall when not overridden
+    std::optional<uint32_t> grass_color;
+    std::optional<uint32_t> foliage_color;
+};
+
+// Colours of the biome's climate in the grass and foliage colormaps, or the
+// override when there is one. 0xRRGGBB.
+uint32_t grass_color(const biome &);
+uint32_t foliage_color(const biome &);
+
+// 0xRRGGBB to 0 to 1 per channel
+inline glm::vec3 unpack_color(uint32_t rgb) {
+    return glm::vec3 { float(rgb >> 16 & 0xff), float(rgb >> 8 & 0xff), float(rgb & 0xff) } / 255.f;
+}
+
+// What a face with a tintindex is coloured with
+enum class tint {
+    GRASS,
+    FOLIAGE,
+    WATER,
+};
+
+// Biome colours of every x and z of a column, blended with the biomes around
+// them. Index z * 16 + x, 0xRRGGBB.
+struct column_tints {
+    std::array<uint32_t, 256> grass;
+    std::array<uint32_t, 256> foliage;
+    std::array<uint32_t, 256> water;
+
+    uint32_t at(tint t, int x, int z) const {
+        switch (t) {
+        case tint::GRASS:
+            return grass[z * 16 + x];
+        case tint::FOLIAGE:
+            return foliage[z * 16 + x];
+        case tint::WATER:
+            break;
+        }
+        return water[z * 16 + x];
+    }
+};
+
+// Averages the colours of the biomes at the surface over a square of
+// radius blocks around every block, like the biome blend option does.
+// The colours of every biome are worked out once up front.
+class biome_blender {
+public:
+    static constexpr int DEFAULT_RADIUS = 2;
+    // Only the columns right next to one are needed
+    static constexpr int MAX_RADIUS = 15;
+
+    explicit biome_blender(std::span<const biome> biomes);
+
+    int radius() const { return m_radius; }
+    // Clamped to 0 to MAX_RADIUS
+    void set_radius(int radius);
+
+    // The column has to be loaded, the missing ones around it are left out
+    column_tints blend(chunk_manager &, int32_t chunk_x, int32_t chunk_z) const;
+
+private:
+    struct colors {
+        uint32_t grass;
+        uint32_t foliage;
+        uint32_t water;
+    };
+
+    // Unknown ids and the entries the server left out get plains colours
+    const colors &colors_of(biome_id id) const {
+        return id < m_colors.size() ? m_colors[id] : m_fallback;
+    }
+
+    std::vector<colors> m_colors;
+    colors m_fallback;
+    int m_radius = DEFAULT_RADIUS;
+};
+
+}
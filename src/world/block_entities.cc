@@ -0,0 +1,186 @@
+#include "block_entities.hh"
+
+#include <algorithm>
+#include <limits>
+
+#include "../nbt.hh"
+#include "../proto/exceptions.hh"
+
+namespace mccpp::world {
+
+void column_block_entities::load(proto::packet_reader &s) {
+    clear();
+    int32_t count = s.read_varint();
+    if (count < 0)
+        throw proto::decode_error("invalid block entity count");
+    // at least 4 bytes each, don't let the count alone allocate
+    m_entries.reserve(std::min<size_t>(count, s.remaining() / 4));
+    for (int32_t i = 0; i < count; i++) {
+        uint8_t packed_xz = s.read_u8();
+        int16_t y = s.read_i16();
+        entry &e = m_entries.emplace_back();
+        e.position = pack(packed_xz >> 4, y, packed_xz & 15);
+        e.type = s.read_varint();
+        read_nbt(s, e);
+    }
+
+    // servers send them in no particular order, the last one of a position wins
+    std::stable_sort(m_entries.begin(), m_entries.end(), [](const entry &a, const entry &b) {
+        return a.position < b.position;
+    });
+    auto last = std::unique(m_entries.rbegin(), m_entries.rend(), [](const entry &a, const entry &b) {
+        return a.position == b.position;
+    });
+    size_t duplicates = static_cast<size_t>(m_entries.rend() - last);
+    if (duplicates > 0) {
+        m_entries.erase(m_entries.begin(), m_entries.begin() + duplicates);
+        m_garbage = m_data.size();
+        for (const entry &e : m_entries) {
+            m_garbage -= e.length;
+        }
+        compact();
+    }
+    if (m_data.capacity() > m_data.size() + m_data.size() / 8)
+        m_data.shrink_to_fit();
+}
+
+void column_block_entities::clear() {
+    // = {} would keep the capacity
+    m_entries = std::vector<entry> {};
+    m_data = std::vector<std::byte> {};
+    m_garbage = 0;
+    m_documents = {};
+    m_document_bytes = 0;
+}
+
+void column_block_entities::set(int x, int y, int z, int32_t type, proto::packet_reader &nbt) {
+    entry added { pack(x, y, z), type, 0, 0 };
+    read_nbt(nbt, added);
+    // m_data may have moved
+    m_documents = {};
+    m_document_bytes = 0;
+
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), added.position, [](const entry &e, uint32_t p) {
+        return e.position < p;
+    });
+    if (it != m_entries.end() && it->position == added.position) {
+        // a lone TAG_End leaves the data alone, like vanilla does
+        if (added.length == 1) {
+            m_garbage += added.length;
+            added.offset = it->offset;
+            added.length = it->length;
+        } else {
+            m_garbage += it->length;
+        }
+        *it = added;
+        compact();
+    } else if (added.length == 1) {
+        // nor does it make a block entity out of nothing, its byte is garbage
+        m_garbage += added.length;
+        compact();
+    } else {
+        m_entries.insert(it, added);
+    }
+}
+
+bool column_block_entities::remove(int x, int y, int z) {
+    uint32_t position = pack(x, y, z);
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), position, [](const entry &e, uint32_t p) {
+        return e.position < p;
+    });
+    if (it == m_entries.end() || it->position != position)
+        return false;
+    m_garbage += it->length;
+    m_entries.erase(it);
+    if (std::unique_ptr<nbt::document> document = m_documents.take(position))
+        m_document_bytes -= document_bytes(*document);
+    compact();
+    return true;
+}
+
+std::optional<int32_t> column_block_entities::type(int x, int y, int z) const {
+    const entry *e = find(pack(x, y, z));
+    if (!e)
+        return std::nullopt;
+    return e->type;
+}
+
+std::span<const std::byte> column_block_entities::raw_nbt(int x, int y, int z) const {
+    const entry *e = find(pack(x, y, z));
+    if (!e)
+        return {};
+    return std::span(m_data).subspan(e->offset, e->length);
+}
+
+const nbt::document *column_block_entities::nbt(int x, int y, int z) {
+    uint32_t position = pack(x, y, z);
+    const entry *e = find(position);
+    if (!e)
+        return nullptr;
+    if (std::unique_ptr<nbt::document> *found = m_documents.find(position))
+        return found->get();
+
+    proto::packet_reader s { std::span(m_data).subspan(e->offset, e->length) };
+    auto document = std::make_unique<nbt::document>(s);
+    m_document_bytes += document_bytes(*document);
+    return m_documents.emplace(position, std::move(document)).first->get();
+}
+
+size_t column_block_entities::allocated_bytes() const {
+    return m_entries.capacity() * sizeof(entry) + m_data.capacity()
+        + m_documents.capacity() * (sizeof(uint64_t) + sizeof(std::unique_ptr<nbt::document>)) + m_document_bytes;
+}
+
+const column_block_entities::entry *column_block_entities::find(uint32_t position) const {
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), position, [](const entry &e, uint32_t p) {
+        return e.position < p;
+    });
+    if (it == m_entries.end() || it->position != position)
+        return nullptr;
+    return &*it;
+}
+
+void column_block_entities::read_nbt(proto::packet_reader &s, entry &e) {
+    size_t offset = m_data.size();
+    if (std::optional<std::span<const std::byte>> unread = s.unread()) {
+        size_t before = s.remaining();
+        nbt::skip(s);
+        std::span<const std::byte> bytes = unread->first(before - s.remaining());
+        m_data.insert(m_data.end(), bytes.begin(), bytes.end());
+    } else {
+        // copy the bytes on the way through
+        proto::packet_reader tee { [&] {
+            std::byte b = s.read_byte();
+            m_data.push_back(b);
+            return b;
+        }, s.remaining() };
+        nbt::skip(tee);
+    }
+    if (m_data.size() > std::numeric_limits<uint32_t>::max())
+        throw proto::decode_error("too much block entity data");
+    e.offset = static_cast<uint32_t>(offset);
+    e.length = static_cast<uint32_t>(m_data.size() - offset);
+}
+
+void column_block_entities::compact() {
+    if (m_garbage == 0 || m_garbage < m_data.size() / 2)
+        return;
+    std::vector<std::byte> data {};
+    data.reserve(m_data.size() - m_garbage);
+    for (entry &e : m_entries) {
+        auto from = m_data.begin() + e.offset;
+        e.offset = static_cast<uint32_t>(data.size());
+        data.insert(data.end(), from, from + e.length);
+    }
+    m_data = std::move(data);
+    m_garbage = 0;
+    m_documents = {};
+    m_document_bytes = 0;
+}
+
+size_t column_block_entities::document_bytes(const nbt::document &document) {
+    // 16 bytes per node
+    return sizeof(nbt::document) + document.node_count() * 16;
+}
+
+}
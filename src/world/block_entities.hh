@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "../nbt_document.hh"
+#include "../proto/packet.hh"
+#include "../utility/flat_map.hh"
+
+namespace mccpp::world {
+
+// The block entities of a column, signs, chests, banners and so on. Entries
+// are sorted by packed position and their NBT stays the bytes the server sent,
+// all in one buffer, so entities nobody looks at cost their wire size plus 16
+// bytes. The NBT is parsed into a document the first time it's asked for.
+// Positions are x and z within the column and the block y.
+class column_block_entities {
+public:
+    // Number of block entities
+    size_t size() const { return m_entries.size(); }
+    bool empty() const { return m_entries.empty(); }
+
+    // Reads the block entity array of a chunk packet, replacing what was
+    // there. Throws a decode_error or parse_error on bad data.
+    void load(proto::packet_reader &);
+    void clear();
+
+    // From the block entity data packet, reads the NBT and adds the block
+    // entity or replaces the one at the position. Empty NBT only changes the
+    // type of an existing one.
+    void set(int x, int y, int z, int32_t type, proto::packet_reader &nbt);
+    // False when there was none
+    bool remove(int x, int y, int z);
+
+    // minecraft:block_entity_type registry id, nullopt when there's none
+    std::optional<int32_t> type(int x, int y, int z) const;
+    // NBT as sent, empty when there's no block entity
+    std::span<const std::byte> raw_nbt(int x, int y, int z) const;
+    // Parses on first access, null when there's no block entity. Valid until
+    // the block entities change.
+    const nbt::document *nbt(int x, int y, int z);
+
+    // Calls f(x, y, z, type) in position order, bottom to top
+    template<typename F>
+    void for_each(F &&f) const {
+        for (const entry &e : m_entries) {
+            f(int(e.position >> 4 & 15), unpack_y(e.position), int(e.position & 15), e.type);
+        }
+    }
+
+    // Bytes held besides the object itself
+    size_t allocated_bytes() const;
+
+private:
+    struct entry {
+        uint32_t position;
+        int32_t type;
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    // y above x and z, like the packet packs them, biased so the order of the
+    // keys is the order of the positions
+    static uint32_t pack(int x, int y, int z) {
+        return uint32_t(static_cast<uint16_t>(y) ^ 0x8000) << 8 | uint32_t(x & 15) << 4 | uint32_t(z & 15);
+    }
+    static int unpack_y(uint32_t position) {
+        return static_cast<int16_t>(static_cast<uint16_t>(position >> 8 ^ 0x8000));
+    }
+
+    const entry *find(uint32_t position) const;
+    // Appends the next tag of s to m_data
+    void read_nbt(proto::packet_reader &s, entry &);
+    // Drops the bytes of replaced and removed entries once they are the
+    // bigger part of the buffer
+    void compact();
+    static size_t document_bytes(const nbt::document &);
+
+    std::vector<entry> m_entries;
+    std::vector<std::byte> m_data;
+    // Bytes in m_data no entry refers to anymore
+    size_t m_garbage = 0;
+    // By position, they point into m_data and are dropped whenever it changes
+    flat_u64_map<std::unique_ptr<nbt::document>> m_documents;
+    size_t m_document_bytes = 0;
+};
+
+}
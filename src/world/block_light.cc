@@ -0,0 +1,23 @@
+// Kept apart from light_engine.cc so that code setting its own properties
+// doesn't have to link the generated block data
+
+#include "light_engine.hh"
+
+#include "data/block_impl.hh"
+
+namespace mccpp::world {
+
+const std::vector<light_properties> &light_engine::baked_properties() {
+    static const std::vector<light_properties> properties = [] {
+        using namespace data::impl;
+        std::vector<light_properties> properties {};
+        properties.reserve(state::count);
+        for (size_t i = 0; i < state::count; i++) {
+            properties.push_back({ static_cast<uint8_t>(state::light[i] >> 4), static_cast<uint8_t>(state::light[i] & 15) });
+        }
+        return properties;
+    }();
+    return properties;
+}
+
+}
@@ -0,0 +1,26 @@
+// Kept apart from collision.cc so that code using its own shapes doesn't
+// have to link the generated block data
+
+#include "collision.hh"
+
+#include "data/block_impl.hh"
+
+namespace mccpp::world {
+
+const collision_shapes &collision_shapes::baked() {
+    static const collision_shapes shapes = [] {
+        using namespace data::impl;
+        std::vector<uint16_t> state_shapes { state::collision_shape, state::collision_shape + state::count };
+        std::vector<uint32_t> box_offsets { shape::box_offset, shape::box_offset + shape::count + 1 };
+        std::vector<aabb> boxes {};
+        boxes.reserve(box_offsets.back());
+        for (uint32_t i = 0; i < box_offsets.back(); i++) {
+            const double *box = shape::boxes + i * 6;
+            boxes.push_back({ { box[0], box[1], box[2] }, { box[3], box[4], box[5] } });
+        }
+        return collision_shapes { std::move(state_shapes), std::move(box_offsets), std::move(boxes) };
+    }();
+    return shapes;
+}
+
+}
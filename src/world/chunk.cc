@@ -1,6 +1,7 @@
 #include "chunk.hh"
 
-#include "../utility/extract_bits.hh"
+#include <algorithm>
+#include <limits>
 
 namespace mccpp::world {
 
@@ -12,18 +13,63 @@ bool chunk::is_air_at(int x, int y, int z) const
         return blocks[z * 256 + x * 16 + y].is_air;
 }
 
-static const block &block_from_global_palette(int32_t) {
-    static block b { false, { 0, 0, 0 } };
-    return b;
+static std::vector<int32_t> read_palette(proto::packet_reader &s) {
+    int32_t palette_length = s.read_varint();
+    if (palette_length < 0 || size_t(palette_length) > s.remaining())
+        throw proto::decode_error("invalid palette length");
+    std::vector<int32_t> palette = {};
+    palette.reserve(palette_length);
+    while (palette_length-- > 0) {
+        palette.emplace_back(s.read_varint());
+    }
+    return palette;
+}
+
+static std::vector<int64_t> read_data_array(proto::packet_reader &s) {
+    int32_t data_array_length = s.read_varint();
+    if (data_array_length < 0 || size_t(data_array_length) > s.remaining() / 8)
+        throw proto::decode_error("invalid data array length");
+    std::vector<int64_t> data_array(data_array_length);
+    s.read_i64_array(data_array);
+    return data_array;
+}
+
+// Calls f(i, value) for the Count entries, which don't span across longs
+template<size_t Count, typename F>
+static void unpack_entries(const std::vector<int64_t> &data_array, unsigned bits_per_entry, F &&f) {
+    if (bits_per_entry > 32)
+        throw proto::decode_error("invalid bits per entry");
+    size_t per_long = 64 / bits_per_entry;
+    if (data_array.size() < (Count + per_long - 1) / per_long)
+        throw proto::decode_error("data array too short");
+    uint64_t mask = (uint64_t(1) << bits_per_entry) - 1;
+    size_t i = 0;
+    for (int64_t word : data_array) {
+        uint64_t v = static_cast<uint64_t>(word);
+        for (size_t j = 0; j < per_long && i < Count; j++, i++) {
+            f(i, v & mask);
+            v >>= bits_per_entry;
+        }
+    }
+}
+
+static void set_loaded_state(chunk &c, size_t i, uint64_t state) {
+    if (state > std::numeric_limits<block_state>::max())
+        throw proto::decode_error("invalid block state");
+    c.states[i] = static_cast<block_state>(state);
+    // blocks is indexed by z, x and then y
+    c.blocks[(i >> 4 & 15) * 256 + (i & 15) * 16 + (i >> 8)].is_air = state == AIR;
 }
 
 static void load_blocks(chunk &c, proto::packet_reader &s) {
     uint8_t bits_per_entry = s.read_u8();
     if (bits_per_entry == 0) {
         int32_t value = s.read_varint();
-        const block &gpb = block_from_global_palette(value);
+        if (value < 0 || value > std::numeric_limits<block_state>::max())
+            throw proto::decode_error("invalid block state");
+        c.states.fill(static_cast<block_state>(value));
         for (block &b : c.blocks) {
-            b = gpb;
+            b.is_air = value == AIR;
         }
         /* data_array_length */ s.read_varint();
         return;
@@ -34,47 +80,201 @@ static void load_blocks(chunk &c, proto::packet_reader &s) {
             bits_per_entry = 4;
         }
 
-        int32_t palette_length = s.read_varint();
-        if (palette_length < 0)
-            throw proto::decode_error("invalid palette length");
-        std::vector<int32_t> palette = {};
-        palette.reserve(palette_length);
-        while (palette_length-- > 0) {
-            palette.emplace_back(s.read_varint());
-        }
+        std::vector<int32_t> palette = read_palette(s);
+        std::vector<int64_t> data_array = read_data_array(s);
+        unpack_entries<4096>(data_array, bits_per_entry, [&](size_t i, uint64_t entry) {
+            if (entry >= palette.size())
+                throw proto::decode_error("invalid palette index");
+            set_loaded_state(c, i, static_cast<uint32_t>(palette[entry]));
+        });
+        return;
+    }
 
-        /* data_array_length */ s.read_varint();
-        std::vector<uint64_t> data_array {};
-        // 4096 blocks * bits per entry = total bits
-        // total bits / 64 = u64 count
-        size_t u64_count = 4096 * bits_per_entry / 64;
-        data_array.reserve(u64_count + 1);
-        for (size_t i = 0; i < u64_count; i++) {
-            data_array.emplace_back(s.read_u64());
-        }
-        // add an extra unused value to make parsing easier
-        data_array.emplace_back(0);
+    // direct palette, the entries are global palette ids
+    std::vector<int64_t> data_array = read_data_array(s);
+    unpack_entries<4096>(data_array, bits_per_entry, [&](size_t i, uint64_t entry) {
+        set_loaded_state(c, i, entry);
+    });
+}
 
-        for (size_t i = 0; i < 4096; i++) {
-            uint64_t entry = extract_bits(data_array, i * bits_per_entry, bits_per_entry);
-            (void)entry;
-        }
+static biome_id checked_biome(uint64_t id) {
+    if (id > std::numeric_limits<biome_id>::max())
+        throw proto::decode_error("invalid biome");
+    return static_cast<biome_id>(id);
+}
 
+static void load_biomes(chunk &c, proto::packet_reader &s) {
+    // the same paletted container with 4x4x4 entries, up to 3 bits use a
+    // palette, more are registry ids
+    uint8_t bits_per_entry = s.read_u8();
+    if (bits_per_entry == 0) {
+        int32_t value = s.read_varint();
+        c.biomes.fill(checked_biome(static_cast<uint32_t>(value)));
+        /* data_array_length */ s.read_varint();
         return;
     }
-}
 
-static void load_biomes(chunk &c, proto::packet_reader &s) {
-    (void)c;
-    (void)s;
+    if (bits_per_entry <= 3) {
+        std::vector<int32_t> palette = read_palette(s);
+        std::vector<int64_t> data_array = read_data_array(s);
+        unpack_entries<64>(data_array, bits_per_entry, [&](size_t i, uint64_t entry) {
+            if (entry >= palette.size())
+                throw proto::decode_error("invalid palette index");
+            c.biomes[i] = checked_biome(static_cast<uint32_t>(palette[entry]));
+        });
+        return;
+    }
+
+    std::vector<int64_t> data_array = read_data_array(s);
+    unpack_entries<64>(data_array, bits_per_entry, [&](size_t i, uint64_t entry) {
+        c.biomes[i] = checked_biome(entry);
+    });
 }
 
 void chunk::load(proto::packet_reader &s) {
+    // recounted instead of trusting the server, set_state keeps it up to date
     /* block_count */ s.read_i16();
     load_blocks(*this, s);
+    non_air = static_cast<uint16_t>(std::count_if(states.begin(), states.end(),
+                                                  [](block_state state) { return state != AIR; }));
     load_biomes(*this, s);
 }
 
+bool chunk::set_state(int x, int y, int z, block_state state) {
+    block_state &current = states[(y * 16 + z) * 16 + x];
+    if (current == state)
+        return false;
+    non_air += (state != AIR) - (current != AIR);
+    current = state;
+    blocks[z * 256 + x * 16 + y].is_air = state == AIR;
+    return true;
+}
+
+chunk_column *chunk_manager::try_get_overflow(int32_t x, int32_t z) {
+    std::unique_ptr<chunk_column> *column = m_overflow.find(chunk_pos_to_idx(x, z));
+    return column ? column->get() : nullptr;
+}
+
+chunk_column &chunk_manager::insert(int32_t x, int32_t z, std::unique_ptr<chunk_column> column) {
+    chunk_column &result = *column;
+    m_size++;
+    slot &s = m_grid[slot_index(x, z)];
+    if (s.column && distance(s.x, s.z) <= distance(x, z)) {
+        m_overflow.emplace(chunk_pos_to_idx(x, z), std::move(column));
+        return result;
+    }
+    // the column in the slot is further away, it has to make room
+    if (s.column)
+        m_overflow.emplace(chunk_pos_to_idx(s.x, s.z), std::move(s.column));
+    s.x = x;
+    s.z = z;
+    s.column = std::move(column);
+    return result;
+}
+
+bool chunk_manager::remove(int32_t x, int32_t z) {
+    slot &s = m_grid[slot_index(x, z)];
+    if (s.x == x && s.z == z && s.column) {
+        s.column.reset();
+    } else if (!m_overflow.erase(chunk_pos_to_idx(x, z))) {
+        return false;
+    }
+    m_size--;
+    return true;
+}
+
+void chunk_manager::unload(int32_t x, int32_t z) {
+    if (remove(x, z))
+        m_stats.forgotten++;
+}
+
+void chunk_manager::evict(std::vector<glm::ivec2> &evicted) {
+    // columns this close to the center are what the player stands on
+    const int32_t KEEP_DISTANCE = 2;
+
+    struct candidate {
+        int32_t x;
+        int32_t z;
+        int32_t distance;
+        uint64_t last_access;
+        size_t bytes;
+    };
+    std::vector<candidate> candidates {};
+    size_t bytes = 0;
+    for_each_column([&](int32_t x, int32_t z, chunk_column &column) {
+        candidate c { x, z, distance(x, z), column.last_access(), column.memory_usage() };
+        bytes += c.bytes;
+        if (c.distance > KEEP_DISTANCE)
+            candidates.emplace_back(c);
+    });
+    m_clock++;
+
+    std::sort(candidates.begin(), candidates.end(), [](const candidate &a, const candidate &b) {
+        if (a.distance != b.distance)
+            return a.distance > b.distance;
+        return a.last_access < b.last_access;
+    });
+    for (const candidate &c : candidates) {
+        bool stale = c.distance > m_radius;
+        if (!stale && (m_stats.budget == 0 || bytes <= m_stats.budget))
+            break;
+        remove(c.x, c.z);
+        bytes -= c.bytes;
+        evicted.emplace_back(c.x, c.z);
+        m_stats.evicted++;
+    }
+    m_stats.bytes = bytes;
+}
+
+void chunk_manager::set_center(int32_t x, int32_t z) {
+    m_center_x = x;
+    m_center_z = z;
+    if (m_overflow.empty())
+        return;
+
+    std::vector<uint64_t> closer {};
+    m_overflow.for_each([&](uint64_t key, std::unique_ptr<chunk_column> &) {
+        int32_t cx = std::bit_cast<int32_t>(uint32_t(key >> 32));
+        int32_t cz = std::bit_cast<int32_t>(uint32_t(key));
+        const slot &s = m_grid[slot_index(cx, cz)];
+        if (!s.column || distance(cx, cz) < distance(s.x, s.z))
+            closer.emplace_back(key);
+    });
+    for (uint64_t key : closer) {
+        int32_t cx = std::bit_cast<int32_t>(uint32_t(key >> 32));
+        int32_t cz = std::bit_cast<int32_t>(uint32_t(key));
+        m_size--;
+        insert(cx, cz, m_overflow.take(key));
+    }
+}
+
+void chunk_manager::set_view_distance(int32_t view_distance) {
+    std::vector<slot> columns = std::move(m_grid);
+    m_overflow.for_each([&](uint64_t key, std::unique_ptr<chunk_column> &column) {
+        columns.emplace_back(slot {
+            std::bit_cast<int32_t>(uint32_t(key >> 32)),
+            std::bit_cast<int32_t>(uint32_t(key)),
+            std::move(column),
+        });
+    });
+    m_overflow = {};
+    resize(view_distance);
+    m_size = 0;
+    for (slot &s : columns) {
+        if (s.column)
+            insert(s.x, s.z, std::move(s.column));
+    }
+}
+
+void chunk_manager::resize(int32_t view_distance) {
+    // the server keeps a few columns past the view distance loaded, with
+    // room for those all columns in range of the center get distinct slots
+    m_radius = std::clamp(view_distance, 2, 64) + 3;
+    m_width = static_cast<int32_t>(std::bit_ceil(uint32_t(m_radius * 2 + 1)));
+    m_mask = m_width - 1;
+    m_grid = std::vector<slot>(size_t(m_width) * size_t(m_width));
+}
+
 // glm::cross has a pointless assert for floating point only
 static glm::ivec3 ivec3_cross(glm::ivec3 x, glm::ivec3 y)
 {
@@ -1,15 +1,21 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <cstdlib>
 #include <memory>
 #include <tuple>
-#include <unordered_map>
 #include <vector>
 
 #include <glm/glm.hpp>
 
 #include "../renderer/vertex.hh"
 #include "../proto/packet.hh"
+#include "../utility/flat_map.hh"
+#include "block_entities.hh"
+#include "heightmap.hh"
+#include "light.hh"
 
 namespace mccpp::world {
 
@@ -21,8 +27,36 @@ struct block {
 void generate_face(std::vector<vertex> &vertices, std::vector<unsigned> &indicies,
                    block block, glm::vec3 position, glm::ivec3 normal);
 
+// Global palette id of a block state
+using block_state = uint16_t;
+constexpr block_state AIR = 0;
+
+// minecraft:worldgen/biome registry id
+using biome_id = uint16_t;
+
+// Which borders of a section a local coordinate lies on, bit 2 * axis for
+// the low and 2 * axis + 1 for the high side
+inline unsigned section_border_mask(int x, int y, int z) {
+    unsigned mask = 0;
+    int local[3] = { x, y, z };
+    for (unsigned axis = 0; axis < 3; axis++) {
+        if (local[axis] == 0)
+            mask |= 1u << (axis * 2);
+        else if (local[axis] == 15)
+            mask |= 1u << (axis * 2 + 1);
+    }
+    return mask;
+}
+
 struct chunk {
+    // Blocks that aren't air, queries skip sections without any. Kept in
+    // front of the states so checking it doesn't cost another page.
+    uint16_t non_air = 0;
+    // Index (y * 16 + z) * 16 + x like the protocol
+    std::array<block_state, 16 * 16 * 16> states {};
     std::array<block, 16 * 16 * 16> blocks;
+    // One per 4x4x4 blocks, index (y * 4 + z) * 4 + x in those
+    std::array<biome_id, 4 * 4 * 4> biomes {};
 
     bool is_air_at(int x, int y, int z) const;
     inline bool is_air_at(glm::ivec3 pos) const
@@ -30,6 +64,17 @@ struct chunk {
         return is_air_at(pos.x, pos.y, pos.z);
     }
 
+    block_state state_at(int x, int y, int z) const {
+        return states[(y * 16 + z) * 16 + x];
+    }
+
+    biome_id biome_at(int x, int y, int z) const {
+        return biomes[((y >> 2) * 4 + (z >> 2)) * 4 + (x >> 2)];
+    }
+
+    // Returns false when the block already had that state
+    bool set_state(int x, int y, int z, block_state);
+
     void load(proto::packet_reader &);
 
     std::tuple<std::vector<vertex>, std::vector<unsigned>> generate_vertices() const;
@@ -41,53 +86,174 @@ public:
 
     chunk_column(size_t count)
     : m_chunks(std::make_unique<chunk[]>(count))
+    , m_count(count)
+    , m_light(count)
     {}
 
     chunk &operator[](size_t y) { return m_chunks[y]; }
     size_t count() { return m_count; }
 
+    column_light &light() { return m_light; }
+    column_heightmaps &heightmaps() { return m_heightmaps; }
+    column_block_entities &block_entities() { return m_block_entities; }
+
     iterator begin() { return m_chunks.get(); }
     iterator end() { return m_chunks.get() + m_count; }
 
+    // Bytes held by the column and its sections
+    size_t memory_usage() const {
+        return sizeof(chunk_column) + m_count * sizeof(chunk) + m_light.allocated_bytes()
+            + m_block_entities.allocated_bytes();
+    }
+
+    // Eviction clock value of the last load or edit
+    uint64_t last_access() const { return m_last_access; }
+    void touch(uint64_t clock) { m_last_access = clock; }
+
 private:
     std::unique_ptr<chunk[]> m_chunks;
     size_t m_count;
+    uint64_t m_last_access = 0;
+    column_light m_light;
+    column_heightmaps m_heightmaps;
+    column_block_entities m_block_entities;
 };
 
+struct chunk_stats {
+    size_t columns = 0;
+    // Columns that live in the fallback map
+    size_t overflow = 0;
+    // As of the last eviction pass
+    size_t bytes = 0;
+    // 0 when unlimited
+    size_t budget = 0;
+    uint64_t evicted = 0;
+    uint64_t forgotten = 0;
+};
+
+// Columns are kept in a view distance sized toroidal grid around the center
+// chunk, slot (x mod width, z mod width), so a lookup is a compare and a load.
+// Columns that don't get a slot because a column closer to the center has it
+// live in a flat hash map that is only searched when it isn't empty.
+// Pointers to columns stay valid until the column is unloaded.
 class chunk_manager {
 public:
-    chunk_manager(size_t height_in_chunks)
+    static constexpr int32_t DEFAULT_VIEW_DISTANCE = 12;
+
+    chunk_manager(size_t height_in_chunks, int32_t view_distance = DEFAULT_VIEW_DISTANCE)
     : m_height_in_chunks(height_in_chunks)
-    {}
+    {
+        resize(view_distance);
+    }
 
-    chunk_column *try_get(int32_t x, int32_t y) {
-        auto iter = m_columns.find(chunk_pos_to_idx(x, y));
-        if (iter == m_columns.end())
+    chunk_column *try_get(int32_t x, int32_t z) {
+        const slot &s = m_grid[slot_index(x, z)];
+        if (s.x == x && s.z == z && s.column)
+            return s.column.get();
+        if (m_overflow.empty())
             return nullptr;
-        return &iter->second;
+        return try_get_overflow(x, z);
     }
 
-    chunk_column &get(int32_t x, int32_t y) {
-        if (auto column = try_get(x, y))
-            return *column;
-        auto iter = m_columns.emplace(chunk_pos_to_idx(x, y), m_height_in_chunks);
-        assert(iter.second);
-        return iter.first->second;
+    // Looks up or creates the column and counts that as an access
+    chunk_column &get(int32_t x, int32_t z) {
+        chunk_column *column = try_get(x, z);
+        if (!column)
+            column = &insert(x, z, std::make_unique<chunk_column>(m_height_in_chunks));
+        column->touch(m_clock);
+        return *column;
     }
 
+    // The server forgot the column
     void unload(int32_t, int32_t);
 
+    // try_get stays a plain load, edits mark the access explicitly
+    void touch(chunk_column &column) { column.touch(m_clock); }
+
+    void set_memory_budget(size_t bytes) { m_stats.budget = bytes; }
+    // Whether the columns are known to need more than the budget, without
+    // walking all of them
+    bool over_budget() const {
+        return m_stats.budget != 0
+            && m_size * (sizeof(chunk_column) + m_height_in_chunks * sizeof(chunk)) > m_stats.budget;
+    }
+
+    // Drops the columns the server moved away from, further than the grid
+    // reaches, and then while over budget the furthest ones, least recently
+    // used first. Columns next to the center are always kept. Positions of
+    // dropped columns are appended to evicted.
+    void evict(std::vector<glm::ivec2> &evicted);
+
+    chunk_stats stats() const {
+        chunk_stats stats = m_stats;
+        stats.columns = m_size;
+        stats.overflow = m_overflow.size();
+        return stats;
+    }
+
+    // Moves the grid to follow the player, columns that now are closer than
+    // the ones in their slots are moved in from the fallback map
+    void set_center(int32_t x, int32_t z);
+    // Resizes the grid so every column within view_distance of the center
+    // has its own slot
+    void set_view_distance(int32_t view_distance);
+
     size_t height_in_chunks() {
         return m_height_in_chunks;
     }
 
+    size_t size() const { return m_size; }
+    // Columns that didn't fit in the grid
+    size_t overflow_size() const { return m_overflow.size(); }
+    int32_t grid_width() const { return m_width; }
+
 private:
-    constexpr uint64_t chunk_pos_to_idx(int32_t x, int32_t y) noexcept {
-        return uint64_t(std::bit_cast<uint32_t>(x)) << 32 | std::bit_cast<uint32_t>(y);
+    struct slot {
+        int32_t x = 0;
+        int32_t z = 0;
+        std::unique_ptr<chunk_column> column;
+    };
+
+    static constexpr uint64_t chunk_pos_to_idx(int32_t x, int32_t z) noexcept {
+        return uint64_t(std::bit_cast<uint32_t>(x)) << 32 | std::bit_cast<uint32_t>(z);
     }
 
+    size_t slot_index(int32_t x, int32_t z) const {
+        return size_t(x & m_mask) * size_t(m_width) + size_t(z & m_mask);
+    }
+
+    int32_t distance(int32_t x, int32_t z) const {
+        return std::max(std::abs(x - m_center_x), std::abs(z - m_center_z));
+    }
+
+    template<typename F>
+    void for_each_column(F &&f) {
+        for (slot &s : m_grid) {
+            if (s.column)
+                f(s.x, s.z, *s.column);
+        }
+        m_overflow.for_each([&](uint64_t key, std::unique_ptr<chunk_column> &column) {
+            f(std::bit_cast<int32_t>(uint32_t(key >> 32)), std::bit_cast<int32_t>(uint32_t(key)), *column);
+        });
+    }
+
+    chunk_column *try_get_overflow(int32_t x, int32_t z);
+    chunk_column &insert(int32_t x, int32_t z, std::unique_ptr<chunk_column> column);
+    bool remove(int32_t x, int32_t z);
+    void resize(int32_t view_distance);
+
     size_t m_height_in_chunks;
-    std::unordered_map<uint64_t, chunk_column> m_columns;
+    int32_t m_radius = 0;
+    int32_t m_width = 0;
+    int32_t m_mask = 0;
+    int32_t m_center_x = 0;
+    int32_t m_center_z = 0;
+    size_t m_size = 0;
+    // Advanced by every eviction pass
+    uint64_t m_clock = 0;
+    chunk_stats m_stats;
+    std::vector<slot> m_grid;
+    flat_u64_map<std::unique_ptr<chunk_column>> m_overflow;
 };
 
 }
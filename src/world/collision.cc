@@ -0,0 +1,183 @@
+#include "collision.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "world.hh"
+
+namespace mccpp::world {
+
+// Boxes closer than this count as touching, not overlapping, so rounding
+// errors don't get an entity stuck in the block it stands on
+static constexpr double EPSILON = 1e-7;
+
+// Fences and walls reach half a block into the block above
+static constexpr int32_t TALL_SHAPE_REACH = 1;
+
+// Extra blocks gathered on every side, the moves of the next ticks usually
+// stay within them
+static constexpr int32_t CACHE_MARGIN = 1;
+
+collision_shapes::collision_shapes()
+: m_state_shapes { EMPTY }
+, m_box_offsets { 0, 0, 1 }
+, m_boxes { { glm::dvec3 { 0. }, glm::dvec3 { 1. } } }
+{}
+
+collision_shapes::collision_shapes(std::vector<uint16_t> state_shapes, std::vector<uint32_t> box_offsets,
+                                   std::vector<aabb> boxes)
+: m_state_shapes(std::move(state_shapes))
+, m_box_offsets(std::move(box_offsets))
+, m_boxes(std::move(boxes))
+{
+    assert(m_box_offsets.size() > FULL + 1);
+    assert(m_box_offsets[EMPTY] == m_box_offsets[EMPTY + 1]);
+    assert(m_box_offsets[FULL + 1] - m_box_offsets[FULL] == 1);
+}
+
+collider::collider(world &w, const collision_shapes &shapes)
+: m_world(w)
+, m_shapes(shapes)
+{}
+
+std::span<const aabb> collider::gather(const aabb &region) {
+    glm::ivec3 min { glm::floor(region.min - EPSILON) };
+    glm::ivec3 max { glm::floor(region.max + EPSILON) };
+    min.y -= TALL_SHAPE_REACH;
+    if (m_valid && m_revision == m_world.revision()
+            && min.x >= m_min.x && min.y >= m_min.y && min.z >= m_min.z
+            && max.x <= m_max.x && max.y <= m_max.y && max.z <= m_max.z)
+        return m_boxes;
+
+    m_min = min - CACHE_MARGIN;
+    m_max = max + CACHE_MARGIN;
+    m_revision = m_world.revision();
+    m_valid = true;
+    m_boxes.clear();
+
+    chunk_manager &chunks = m_world.chunks();
+    int32_t min_y = m_world.min_y();
+    int32_t height = static_cast<int32_t>(chunks.height_in_chunks()) * 16;
+    int32_t y_begin = std::max(m_min.y - min_y, 0);
+    int32_t y_end = std::min(m_max.y - min_y + 1, height);
+
+    for (int32_t cx = m_min.x >> 4; cx <= m_max.x >> 4; cx++) {
+        for (int32_t cz = m_min.z >> 4; cz <= m_max.z >> 4; cz++) {
+            chunk_column *column = chunks.try_get(cx, cz);
+            if (!column)
+                continue;
+            int x_begin = std::max(m_min.x - cx * 16, 0);
+            int x_end = std::min(m_max.x - cx * 16 + 1, 16);
+            int z_begin = std::max(m_min.z - cz * 16, 0);
+            int z_end = std::min(m_max.z - cz * 16 + 1, 16);
+
+            for (int32_t y = y_begin; y < y_end;) {
+                const chunk &section = (*column)[y >> 4];
+                int32_t section_end = std::min((y | 15) + 1, y_end);
+                if (section.non_air == 0) {
+                    y = section_end;
+                    continue;
+                }
+                for (; y < section_end; y++) {
+                    for (int z = z_begin; z < z_end; z++) {
+                        for (int x = x_begin; x < x_end; x++) {
+                            block_state state = section.state_at(x, y & 15, z);
+                            if (state == AIR)
+                                continue;
+                            uint16_t shape = m_shapes.shape(state);
+                            if (shape == collision_shapes::EMPTY)
+                                continue;
+                            glm::dvec3 origin { glm::ivec3 { cx * 16 + x, min_y + y, cz * 16 + z } };
+                            if (shape == collision_shapes::FULL) {
+                                m_boxes.push_back({ origin, origin + 1. });
+                                continue;
+                            }
+                            for (const aabb &box : m_shapes.boxes(shape)) {
+                                m_boxes.push_back(box.moved(origin));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return m_boxes;
+}
+
+// How far box moves along axis before running into one of the boxes
+static double clip(const aabb &box, std::span<const aabb> boxes, int axis, double distance) {
+    if (std::abs(distance) < EPSILON)
+        return 0.;
+    int a = (axis + 1) % 3;
+    int b = (axis + 2) % 3;
+    for (const aabb &other : boxes) {
+        if (other.max[a] <= box.min[a] + EPSILON || other.min[a] >= box.max[a] - EPSILON
+                || other.max[b] <= box.min[b] + EPSILON || other.min[b] >= box.max[b] - EPSILON)
+            continue;
+        if (distance > 0. && other.min[axis] >= box.max[axis] - EPSILON) {
+            distance = std::min(distance, other.min[axis] - box.max[axis]);
+        } else if (distance < 0. && other.max[axis] <= box.min[axis] + EPSILON) {
+            distance = std::max(distance, other.max[axis] - box.min[axis]);
+        }
+    }
+    return distance;
+}
+
+static glm::dvec3 sweep(aabb box, std::span<const aabb> boxes, glm::dvec3 motion) {
+    glm::dvec3 result {};
+    result.y = clip(box, boxes, 1, motion.y);
+    box = box.moved({ 0., result.y, 0. });
+    // the same order as vanilla, or corners play out differently
+    bool z_first = std::abs(motion.x) < std::abs(motion.z);
+    if (z_first) {
+        result.z = clip(box, boxes, 2, motion.z);
+        box = box.moved({ 0., 0., result.z });
+    }
+    result.x = clip(box, boxes, 0, motion.x);
+    if (!z_first) {
+        box = box.moved({ result.x, 0., 0. });
+        result.z = clip(box, boxes, 2, motion.z);
+    }
+    return result;
+}
+
+static double horizontal_length2(glm::dvec3 v) {
+    return v.x * v.x + v.z * v.z;
+}
+
+glm::dvec3 collider::collide(const aabb &box, glm::dvec3 motion) {
+    if (motion == glm::dvec3 { 0. })
+        return motion;
+    return sweep(box, gather(box.expanded_towards(motion)), motion);
+}
+
+move_result collider::move(const aabb &box, glm::dvec3 motion, double step_height, bool on_ground) {
+    // one gather covers the step up attempts as well
+    std::span<const aabb> boxes = gather(box.expanded_towards(motion).expanded_towards({ 0., step_height, 0. }));
+    glm::dvec3 result = sweep(box, boxes, motion);
+
+    bool collided_x = result.x != motion.x;
+    bool collided_z = result.z != motion.z;
+    bool landed = result.y != motion.y && motion.y < 0.;
+    if (step_height > 0. && (on_ground || landed) && (collided_x || collided_z)) {
+        glm::dvec3 horizontal { motion.x, 0., motion.z };
+        // straight up and over, or up first when the box would hit its head
+        glm::dvec3 stepped = sweep(box, boxes, { motion.x, step_height, motion.z });
+        glm::dvec3 up = sweep(box.expanded_towards(horizontal), boxes, { 0., step_height, 0. });
+        if (up.y < step_height) {
+            glm::dvec3 over = sweep(box.moved(up), boxes, horizontal) + up;
+            if (horizontal_length2(over) > horizontal_length2(stepped))
+                stepped = over;
+        }
+        if (horizontal_length2(stepped) > horizontal_length2(result)) {
+            // and back down onto whatever it stepped on
+            result = stepped + sweep(box.moved(stepped), boxes, { 0., motion.y - stepped.y, 0. });
+        }
+    }
+
+    bool collided_y = result.y != motion.y;
+    return { result, result.x != motion.x || result.z != motion.z, collided_y, collided_y && motion.y < 0. };
+}
+
+}
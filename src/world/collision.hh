@@ -0,0 +1,103 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "chunk.hh"
+
+namespace mccpp::world {
+
+class world;
+
+struct aabb {
+    glm::dvec3 min;
+    glm::dvec3 max;
+
+    aabb moved(glm::dvec3 offset) const { return { min + offset, max + offset }; }
+
+    // Grown on the side the motion goes to, covers the whole sweep
+    aabb expanded_towards(glm::dvec3 motion) const {
+        return { min + glm::min(motion, glm::dvec3 { 0. }), max + glm::max(motion, glm::dvec3 { 0. }) };
+    }
+};
+
+// Collision boxes of every block state in block space, looked up once per
+// state so the sweep only tells empty, full cubes and the rest apart
+class collision_shapes {
+public:
+    static constexpr uint16_t EMPTY = 0;
+    static constexpr uint16_t FULL = 1;
+
+    // AIR is empty and every other state a full cube
+    collision_shapes();
+    // shape i owns boxes [box_offsets[i], box_offsets[i + 1]), shape EMPTY
+    // has to be empty and FULL the unit cube
+    collision_shapes(std::vector<uint16_t> state_shapes, std::vector<uint32_t> box_offsets, std::vector<aabb> boxes);
+
+    // The shapes of the generated block data
+    static const collision_shapes &baked();
+
+    // States past the table are treated like in the default tables
+    uint16_t shape(block_state state) const {
+        if (state < m_state_shapes.size())
+            return m_state_shapes[state];
+        return state == AIR ? EMPTY : FULL;
+    }
+
+    std::span<const aabb> boxes(uint16_t shape) const {
+        return { m_boxes.data() + m_box_offsets[shape], m_boxes.data() + m_box_offsets[shape + 1] };
+    }
+
+private:
+    std::vector<uint16_t> m_state_shapes;
+    std::vector<uint32_t> m_box_offsets;
+    std::vector<aabb> m_boxes;
+};
+
+struct move_result {
+    // The motion after collisions
+    glm::dvec3 motion;
+    // Cut short along x or z
+    bool collided_horizontally;
+    bool collided_vertically;
+    // Landed on or is still standing on something
+    bool on_ground;
+};
+
+// Moves boxes through the blocks of the world the way vanilla entities do.
+// The block boxes gathered for a move are kept with some margin around them,
+// so the following moves of the same entity reuse them until the world
+// changes. Unloaded columns don't collide.
+class collider {
+public:
+    collider(world &, const collision_shapes &);
+
+    // Boxes of at least the blocks touching region, in world space
+    std::span<const aabb> gather(const aabb &region);
+
+    // Sweeps box along y, then along the larger of x and z and the other
+    // one last, returns how far it got
+    glm::dvec3 collide(const aabb &box, glm::dvec3 motion);
+
+    // collide, and when standing on the ground and blocked horizontally also
+    // tries stepping up step_height onto what's in the way
+    move_result move(const aabb &box, glm::dvec3 motion, double step_height, bool on_ground);
+
+    // Drops the cached boxes
+    void invalidate() { m_valid = false; }
+
+private:
+    world &m_world;
+    const collision_shapes &m_shapes;
+
+    std::vector<aabb> m_boxes;
+    // Inclusive block range of m_boxes
+    glm::ivec3 m_min {};
+    glm::ivec3 m_max {};
+    uint64_t m_revision = 0;
+    bool m_valid = false;
+};
+
+}
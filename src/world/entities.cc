@@ -0,0 +1,236 @@
+#include "entities.hh"
+
+#include <algorithm>
+
+namespace mccpp::world {
+
+uint32_t entity_store::add(const entity_spawn &spawn) {
+    uint32_t slot = this->slot(spawn.id);
+    if (slot == NO_SLOT) {
+        slot = static_cast<uint32_t>(size());
+        for_each_field([](auto &field) { field.emplace_back(); });
+        m_slots.emplace(key(spawn.id), uint32_t { slot });
+        m_grid.insert(slot, spawn.position);
+    } else {
+        m_grid.update(slot, spawn.position);
+    }
+    m_id[slot] = spawn.id;
+    m_uuid[slot] = spawn.uuid;
+    m_type[slot] = spawn.type;
+    m_x[slot] = m_previous_x[slot] = m_render_x[slot] = spawn.position.x;
+    m_y[slot] = m_previous_y[slot] = m_render_y[slot] = spawn.position.y;
+    m_z[slot] = m_previous_z[slot] = m_render_z[slot] = spawn.position.z;
+    m_yaw[slot] = spawn.yaw;
+    m_pitch[slot] = spawn.pitch;
+    m_head_yaw[slot] = spawn.head_yaw;
+    m_velocity_x[slot] = spawn.velocity.x;
+    m_velocity_y[slot] = spawn.velocity.y;
+    m_velocity_z[slot] = spawn.velocity.z;
+    m_on_ground[slot] = 0;
+    return slot;
+}
+
+bool entity_store::remove(int32_t id) {
+    uint32_t *found = m_slots.find(key(id));
+    if (!found)
+        return false;
+    uint32_t slot = *found;
+    m_slots.erase(key(id));
+
+    uint32_t last = static_cast<uint32_t>(size() - 1);
+    if (slot != last)
+        *m_slots.find(key(m_id[last])) = slot;
+    m_grid.remove(slot, last);
+    for_each_field([slot](auto &field) {
+        field[slot] = field.back();
+        field.pop_back();
+    });
+    return true;
+}
+
+void entity_store::clear() {
+    m_slots = {};
+    m_grid.clear();
+    for_each_field([](auto &field) { field.clear(); });
+}
+
+bool entity_store::move(int32_t id, glm::dvec3 delta, bool on_ground) {
+    uint32_t slot = this->slot(id);
+    if (slot == NO_SLOT)
+        return false;
+    m_x[slot] += delta.x;
+    m_y[slot] += delta.y;
+    m_z[slot] += delta.z;
+    m_on_ground[slot] = on_ground;
+    m_grid.update(slot, position(slot));
+    return true;
+}
+
+bool entity_store::teleport(int32_t id, glm::dvec3 position, bool on_ground) {
+    uint32_t slot = this->slot(id);
+    if (slot == NO_SLOT)
+        return false;
+    m_x[slot] = position.x;
+    m_y[slot] = position.y;
+    m_z[slot] = position.z;
+    m_on_ground[slot] = on_ground;
+    m_grid.update(slot, position);
+    return true;
+}
+
+bool entity_store::rotate(int32_t id, float yaw, float pitch, bool on_ground) {
+    uint32_t slot = this->slot(id);
+    if (slot == NO_SLOT)
+        return false;
+    m_yaw[slot] = yaw;
+    m_pitch[slot] = pitch;
+    m_on_ground[slot] = on_ground;
+    return true;
+}
+
+bool entity_store::rotate_head(int32_t id, float head_yaw) {
+    uint32_t slot = this->slot(id);
+    if (slot == NO_SLOT)
+        return false;
+    m_head_yaw[slot] = head_yaw;
+    return true;
+}
+
+bool entity_store::set_velocity(int32_t id, glm::vec3 velocity) {
+    uint32_t slot = this->slot(id);
+    if (slot == NO_SLOT)
+        return false;
+    m_velocity_x[slot] = velocity.x;
+    m_velocity_y[slot] = velocity.y;
+    m_velocity_z[slot] = velocity.z;
+    return true;
+}
+
+void entity_store::query_radius(glm::dvec3 center, double radius, std::vector<uint32_t> &out) {
+    out.clear();
+    if (!(radius >= 0.))
+        return;
+    glm::ivec3 min = entity_grid::cell_of(center - radius);
+    glm::ivec3 max = entity_grid::cell_of(center + radius);
+    double radius2 = radius * radius;
+    m_grid.for_each_in(min, max, [&](uint32_t slot) {
+        double dx = m_x[slot] - center.x;
+        double dy = m_y[slot] - center.y;
+        double dz = m_z[slot] - center.z;
+        if (dx * dx + dy * dy + dz * dz <= radius2)
+            out.push_back(slot);
+    });
+}
+
+void entity_store::query_box(const aabb &box, std::vector<uint32_t> &out) {
+    out.clear();
+    glm::ivec3 min = entity_grid::cell_of(box.min);
+    glm::ivec3 max = entity_grid::cell_of(box.max);
+    m_grid.for_each_in(min, max, [&](uint32_t slot) {
+        if (m_x[slot] >= box.min.x && m_x[slot] <= box.max.x
+                && m_y[slot] >= box.min.y && m_y[slot] <= box.max.y
+                && m_z[slot] >= box.min.z && m_z[slot] <= box.max.z)
+            out.push_back(slot);
+    });
+}
+
+void entity_store::query_nearest(glm::dvec3 center, size_t k, std::vector<uint32_t> &out, double max_distance) {
+    out.clear();
+    if (k == 0 || size() == 0 || !(max_distance >= 0.))
+        return;
+
+    // max heap of the best so far by squared distance
+    std::vector<std::pair<double, uint32_t>> best {};
+    double max2 = max_distance * max_distance;
+    size_t seen = 0;
+    auto consider = [&](uint32_t slot) {
+        seen++;
+        double dx = m_x[slot] - center.x;
+        double dy = m_y[slot] - center.y;
+        double dz = m_z[slot] - center.z;
+        double d2 = dx * dx + dy * dy + dz * dz;
+        if (d2 > max2)
+            return;
+        if (best.size() < k) {
+            best.emplace_back(d2, slot);
+            std::push_heap(best.begin(), best.end());
+        } else if (d2 < best.front().first) {
+            std::pop_heap(best.begin(), best.end());
+            best.back() = { d2, slot };
+            std::push_heap(best.begin(), best.end());
+        }
+    };
+
+    // shells of cells around the center one, r cells away. Nothing past
+    // shell r is closer than the border of the cube of shells before it.
+    glm::ivec3 c = entity_grid::cell_of(center);
+    glm::dvec3 low = glm::dvec3 { c } * double(entity_grid::CELL_SIZE);
+    for (int32_t r = 0; seen < size(); r++) {
+        double reach = std::numeric_limits<double>::infinity();
+        for (int a = 0; a < 3; a++) {
+            reach = std::min(reach, center[a] - (low[a] - (r - 1) * entity_grid::CELL_SIZE));
+            reach = std::min(reach, (low[a] + r * entity_grid::CELL_SIZE) - center[a]);
+        }
+        reach = std::max(reach, 0.);
+        if (reach * reach > max2 || (best.size() == k && reach * reach >= best.front().first))
+            break;
+
+        // a shell bigger than the occupied cells, rather go through those
+        int64_t side = 2 * int64_t(r) + 1;
+        int64_t shell = r == 0 ? 1 : side * side * side - (side - 2) * (side - 2) * (side - 2);
+        if (static_cast<uint64_t>(shell) > m_grid.cell_count()) {
+            m_grid.for_each_cell([&](glm::ivec3 cell, std::span<const uint32_t> slots) {
+                glm::ivec3 d = glm::abs(cell - c);
+                if (std::max(d.x, std::max(d.y, d.z)) < r)
+                    return;
+                for (uint32_t slot : slots) {
+                    consider(slot);
+                }
+            });
+            break;
+        }
+
+        for (int32_t x = -r; x <= r; x++) {
+            for (int32_t y = -r; y <= r; y++) {
+                bool face = x == -r || x == r || y == -r || y == r;
+                // inside the shell only its two z faces
+                for (int32_t z = -r; z <= r; z += face || r == 0 ? 1 : 2 * r) {
+                    for (uint32_t slot : m_grid.find(c + glm::ivec3 { x, y, z })) {
+                        consider(slot);
+                    }
+                }
+            }
+        }
+    }
+
+    std::sort_heap(best.begin(), best.end());
+    for (auto &[d2, slot] : best) {
+        out.push_back(slot);
+    }
+}
+
+void entity_store::tick() {
+    std::copy(m_x.begin(), m_x.end(), m_previous_x.begin());
+    std::copy(m_y.begin(), m_y.end(), m_previous_y.begin());
+    std::copy(m_z.begin(), m_z.end(), m_previous_z.begin());
+}
+
+// One axis at a time keeps every loop a plain streaming pass the compiler
+// turns into vector code, the restrict saves it the overlap checks
+static void lerp(const std::vector<double> &from, const std::vector<double> &to, std::vector<double> &out, double t) {
+    const double *__restrict a = from.data();
+    const double *__restrict b = to.data();
+    double *__restrict result = out.data();
+    size_t n = out.size();
+    for (size_t i = 0; i < n; i++) {
+        result[i] = a[i] + (b[i] - a[i]) * t;
+    }
+}
+
+void entity_store::interpolate(double partial_tick) {
+    lerp(m_previous_x, m_x, m_render_x, partial_tick);
+    lerp(m_previous_y, m_y, m_render_y, partial_tick);
+    lerp(m_previous_z, m_z, m_render_z, partial_tick);
+}
+
+}
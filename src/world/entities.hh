@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../utility/flat_map.hh"
+#include "../uuid.hh"
+#include "collision.hh"
+#include "entity_grid.hh"
+
+namespace mccpp::world {
+
+// The add player packet carries no type, players get this one
+constexpr int32_t PLAYER_ENTITY_TYPE = -1;
+
+// What the add entity and add player packets carry
+struct entity_spawn {
+    int32_t id;
+    class uuid uuid;
+    // minecraft:entity_type registry id
+    int32_t type;
+    glm::dvec3 position;
+    // Degrees
+    float yaw = 0.f;
+    float pitch = 0.f;
+    float head_yaw = 0.f;
+    // Blocks per tick
+    glm::vec3 velocity {};
+};
+
+// The entities the server told the client about. Every field is an array
+// indexed by slot, so passes over all entities only touch the fields they
+// need and vectorize. Slots are dense: removing an entity moves the last one
+// into its slot, ids map to slots through a flat hash map.
+class entity_store {
+public:
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    size_t size() const { return m_id.size(); }
+
+    // NO_SLOT for unknown ids
+    uint32_t slot(int32_t id) {
+        uint32_t *slot = m_slots.find(key(id));
+        return slot ? *slot : NO_SLOT;
+    }
+
+    // Replaces an entity with the same id
+    uint32_t add(const entity_spawn &);
+    // False for unknown ids
+    bool remove(int32_t id);
+    void clear();
+
+    // Updates from the movement packets, false for unknown ids
+    bool move(int32_t id, glm::dvec3 delta, bool on_ground);
+    bool teleport(int32_t id, glm::dvec3 position, bool on_ground);
+    bool rotate(int32_t id, float yaw, float pitch, bool on_ground);
+    bool rotate_head(int32_t id, float head_yaw);
+    bool set_velocity(int32_t id, glm::vec3 velocity);
+
+    // Slots of the entities at most radius away from center
+    void query_radius(glm::dvec3 center, double radius, std::vector<uint32_t> &out);
+    // Slots of the entities positioned inside of box
+    void query_box(const aabb &box, std::vector<uint32_t> &out);
+    // Slots of the k entities closest to center and at most max_distance
+    // away, the closest first
+    void query_nearest(glm::dvec3 center, size_t k, std::vector<uint32_t> &out,
+                       double max_distance = std::numeric_limits<double>::infinity());
+
+    // Starts a client tick, the positions so far become the previous ones
+    void tick();
+    // Fills the render positions partial_tick of the way from the previous
+    // to the current positions
+    void interpolate(double partial_tick);
+
+    int32_t id(uint32_t slot) const { return m_id[slot]; }
+    class uuid uuid(uint32_t slot) const { return m_uuid[slot]; }
+    int32_t type(uint32_t slot) const { return m_type[slot]; }
+    glm::dvec3 position(uint32_t slot) const { return { m_x[slot], m_y[slot], m_z[slot] }; }
+    glm::dvec3 previous_position(uint32_t slot) const { return { m_previous_x[slot], m_previous_y[slot], m_previous_z[slot] }; }
+    glm::dvec3 render_position(uint32_t slot) const { return { m_render_x[slot], m_render_y[slot], m_render_z[slot] }; }
+    float yaw(uint32_t slot) const { return m_yaw[slot]; }
+    float pitch(uint32_t slot) const { return m_pitch[slot]; }
+    float head_yaw(uint32_t slot) const { return m_head_yaw[slot]; }
+    glm::vec3 velocity(uint32_t slot) const { return { m_velocity_x[slot], m_velocity_y[slot], m_velocity_z[slot] }; }
+    bool on_ground(uint32_t slot) const { return m_on_ground[slot] != 0; }
+
+    std::span<const int32_t> ids() const { return m_id; }
+    std::span<const double> x() const { return m_x; }
+    std::span<const double> y() const { return m_y; }
+    std::span<const double> z() const { return m_z; }
+    std::span<const double> render_x() const { return m_render_x; }
+    std::span<const double> render_y() const { return m_render_y; }
+    std::span<const double> render_z() const { return m_render_z; }
+
+    entity_grid &grid() { return m_grid; }
+
+private:
+    static uint64_t key(int32_t id) { return static_cast<uint32_t>(id); }
+
+    template<typename F>
+    void for_each_field(F &&f) {
+        f(m_id);
+        f(m_uuid);
+        f(m_type);
+        f(m_x);
+        f(m_y);
+        f(m_z);
+        f(m_previous_x);
+        f(m_previous_y);
+        f(m_previous_z);
+        f(m_render_x);
+        f(m_render_y);
+        f(m_render_z);
+        f(m_yaw);
+        f(m_pitch);
+        f(m_head_yaw);
+        f(m_velocity_x);
+        f(m_velocity_y);
+        f(m_velocity_z);
+        f(m_on_ground);
+    }
+
+    flat_u64_map<uint32_t> m_slots;
+    // Queries go through the grid, it follows every position change
+    entity_grid m_grid;
+
+    std::vector<int32_t> m_id;
+    std::vector<class uuid> m_uuid;
+    std::vector<int32_t> m_type;
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_z;
+    std::vector<double> m_previous_x;
+    std::vector<double> m_previous_y;
+    std::vector<double> m_previous_z;
+    std::vector<double> m_render_x;
+    std::vector<double> m_render_y;
+    std::vector<double> m_render_z;
+    std::vector<float> m_yaw;
+    std::vector<float> m_pitch;
+    std::vector<float> m_head_yaw;
+    std::vector<float> m_velocity_x;
+    std::vector<float> m_velocity_y;
+    std::vector<float> m_velocity_z;
+    std::vector<uint8_t> m_on_ground;
+};
+
+}
@@ -0,0 +1,61 @@
+#include "entity_grid.hh"
+
+#include <cassert>
+
+namespace mccpp::world {
+
+void entity_grid::insert(uint32_t slot, glm::dvec3 position) {
+    assert(slot == m_cell.size());
+    m_cell.emplace_back();
+    m_cell_index.emplace_back();
+    add_to_cell(slot, pack(cell_of(position)));
+}
+
+void entity_grid::update(uint32_t slot, glm::dvec3 position) {
+    uint64_t key = pack(cell_of(position));
+    if (key == m_cell[slot])
+        return;
+    remove_from_cell(slot);
+    add_to_cell(slot, key);
+}
+
+void entity_grid::remove(uint32_t slot, uint32_t last) {
+    assert(last + 1 == m_cell.size());
+    remove_from_cell(slot);
+    if (slot != last) {
+        uint64_t key = m_cell[last];
+        uint32_t index = m_cell_index[last];
+        (*m_cells.find(key))[index] = slot;
+        m_cell[slot] = key;
+        m_cell_index[slot] = index;
+    }
+    m_cell.pop_back();
+    m_cell_index.pop_back();
+}
+
+void entity_grid::clear() {
+    m_cells = {};
+    m_cell.clear();
+    m_cell_index.clear();
+}
+
+void entity_grid::add_to_cell(uint32_t slot, uint64_t key) {
+    std::vector<uint32_t> &slots = *m_cells.emplace(key, {}).first;
+    m_cell[slot] = key;
+    m_cell_index[slot] = static_cast<uint32_t>(slots.size());
+    slots.push_back(slot);
+}
+
+void entity_grid::remove_from_cell(uint32_t slot) {
+    uint64_t key = m_cell[slot];
+    std::vector<uint32_t> &slots = *m_cells.find(key);
+    uint32_t index = m_cell_index[slot];
+    uint32_t moved = slots.back();
+    slots[index] = moved;
+    m_cell_index[moved] = index;
+    slots.pop_back();
+    if (slots.empty())
+        m_cells.erase(key);
+}
+
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../utility/flat_map.hh"
+
+namespace mccpp::world {
+
+// Entity slots bucketed by the chunk section their position is in, so
+// proximity queries only look at the sections they overlap. The cell of
+// every slot is kept to tell cheaply whether a move left it, which most
+// movement packets don't.
+class entity_grid {
+public:
+    static constexpr int32_t CELL_SIZE = 16;
+
+    static glm::ivec3 cell_of(glm::dvec3 position) {
+        // past the world border and far above and below the world, keeps
+        // garbage from the server in the range of the packed cells
+        constexpr double LIMITS[3] = { 3.2e7, 8e6, 3.2e7 };
+        for (int a = 0; a < 3; a++) {
+            position[a] = position[a] > -LIMITS[a] ? (position[a] < LIMITS[a] ? position[a] : LIMITS[a]) : -LIMITS[a];
+        }
+        return glm::ivec3 { glm::floor(position / double(CELL_SIZE)) };
+    }
+
+    // Occupied cells
+    size_t cell_count() const { return m_cells.size(); }
+
+    // slot has to be the next one, the number of slots so far
+    void insert(uint32_t slot, glm::dvec3 position);
+    void update(uint32_t slot, glm::dvec3 position);
+    // Forgets slot, the entity in last moves into it like in entity_store
+    void remove(uint32_t slot, uint32_t last);
+    void clear();
+
+    // Calls f(slot) for the entities in the cells from min to max inclusive.
+    // Goes through the occupied cells instead when there are fewer of them.
+    template<typename F>
+    void for_each_in(glm::ivec3 min, glm::ivec3 max, F &&f) {
+        int64_t volume = int64_t(max.x - min.x + 1) * (max.y - min.y + 1) * (max.z - min.z + 1);
+        if (volume <= 0)
+            return;
+        if (static_cast<uint64_t>(volume) > m_cells.size()) {
+            m_cells.for_each([&](uint64_t key, std::vector<uint32_t> &slots) {
+                glm::ivec3 cell = unpack(key);
+                if (cell.x >= min.x && cell.x <= max.x && cell.y >= min.y && cell.y <= max.y
+                        && cell.z >= min.z && cell.z <= max.z) {
+                    for (uint32_t slot : slots) {
+                        f(slot);
+                    }
+                }
+            });
+            return;
+        }
+        for (int32_t x = min.x; x <= max.x; x++) {
+            for (int32_t z = min.z; z <= max.z; z++) {
+                for (int32_t y = min.y; y <= max.y; y++) {
+                    std::vector<uint32_t> *slots = m_cells.find(pack({ x, y, z }));
+                    if (!slots)
+                        continue;
+                    for (uint32_t slot : *slots) {
+                        f(slot);
+                    }
+                }
+            }
+        }
+    }
+
+    // Calls f(cell, slots) for every occupied cell
+    template<typename F>
+    void for_each_cell(F &&f) {
+        m_cells.for_each([&](uint64_t key, std::vector<uint32_t> &slots) {
+            f(unpack(key), std::span<const uint32_t> { slots });
+        });
+    }
+
+    // Empty for cells without entities
+    std::span<const uint32_t> find(glm::ivec3 cell) {
+        std::vector<uint32_t> *slots = m_cells.find(pack(cell));
+        return slots ? std::span<const uint32_t> { *slots } : std::span<const uint32_t> {};
+    }
+
+private:
+    // Like section positions in the section blocks update packet, 22 bits
+    // for x and z and 20 for y
+    static uint64_t pack(glm::ivec3 c) {
+        return (uint64_t(c.x) & 0x3fffff) << 42 | (uint64_t(c.z) & 0x3fffff) << 20 | (uint64_t(c.y) & 0xfffff);
+    }
+    static glm::ivec3 unpack(uint64_t packed) {
+        return {
+            static_cast<int32_t>(static_cast<int64_t>(packed) >> 42),
+            static_cast<int32_t>(static_cast<int64_t>(packed << 44) >> 44),
+            static_cast<int32_t>(static_cast<int64_t>(packed << 22) >> 42),
+        };
+    }
+
+    void add_to_cell(uint32_t slot, uint64_t key);
+    void remove_from_cell(uint32_t slot);
+
+    flat_u64_map<std::vector<uint32_t>> m_cells;
+    // Per slot, the packed cell and the index in its list
+    std::vector<uint64_t> m_cell;
+    std::vector<uint32_t> m_cell_index;
+};
+
+}
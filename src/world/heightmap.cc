@@ -0,0 +1,52 @@
+#include "heightmap.hh"
+
+#include <algorithm>
+#include <bit>
+
+#include "../nbt_visitor.hh"
+
+namespace mccpp::world {
+
+void heightmap::load(std::span<const std::byte> big_endian_longs, unsigned bits_per_entry) {
+    if (bits_per_entry == 0 || bits_per_entry > 16)
+        throw proto::decode_error("invalid heightmap entry size");
+    size_t per_long = 64 / bits_per_entry;
+    size_t longs = (m_heights.size() + per_long - 1) / per_long;
+    if (big_endian_longs.size() != longs * 8)
+        throw proto::decode_error("invalid heightmap size");
+
+    uint64_t mask = (uint64_t(1) << bits_per_entry) - 1;
+    size_t i = 0;
+    for (size_t l = 0; l < longs; l++) {
+        uint64_t v = 0;
+        for (size_t b = 0; b < 8; b++) {
+            v = v << 8 | static_cast<uint8_t>(big_endian_longs[l * 8 + b]);
+        }
+        for (size_t j = 0; j < per_long && i < m_heights.size(); j++, i++) {
+            m_heights[i] = static_cast<uint16_t>(v & mask);
+            v >>= bits_per_entry;
+        }
+    }
+    recalculate_max();
+}
+
+void heightmap::recalculate_max() {
+    m_max = *std::max_element(m_heights.begin(), m_heights.end());
+}
+
+void column_heightmaps::load(proto::packet_reader &s, size_t world_height) {
+    unsigned bits = std::bit_width(world_height);
+    nbt::path_query query {};
+    auto on = [&](std::string_view name, heightmap &map) {
+        query.on({ name }, [&map, bits](const nbt::path_query::match &m) {
+            if (m.type != nbt::TAG_LONG_ARRAY)
+                throw proto::decode_error("heightmap isn't a long array");
+            map.load(m.array, bits);
+        });
+    };
+    on("MOTION_BLOCKING", motion_blocking);
+    on("WORLD_SURFACE", world_surface);
+    query.run(s);
+}
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "../proto/packet.hh"
+
+namespace mccpp::world {
+
+// Height of every column of a chunk, counted in blocks from the bottom of the
+// world, so it's one above the highest matching block and 0 when there is
+// none. Index z * 16 + x.
+class heightmap {
+public:
+    uint16_t at(int x, int z) const { return m_heights[z * 16 + x]; }
+    // Highest height of all columns
+    uint16_t max() const { return m_max; }
+
+    // True when no column reaches into the section, sections are counted
+    // from the bottom of the world
+    bool is_above(size_t section) const { return section * 16 >= m_max; }
+
+    // Unpacks a long array as sent by the server, bits_per_entry wide
+    // entries that don't cross longs. Throws a decode_error on a bad size.
+    void load(std::span<const std::byte> big_endian_longs, unsigned bits_per_entry);
+
+    // Keeps the column up to date when the block at y changed. matches_at(y)
+    // is only asked about blocks below y when the top block was removed.
+    template<typename F>
+    void update(int x, int y, int z, bool matches, F &&matches_at) {
+        uint16_t &height = m_heights[z * 16 + x];
+        if (matches) {
+            if (y + 1 > height) {
+                height = static_cast<uint16_t>(y + 1);
+                m_max = std::max(m_max, height);
+            }
+            return;
+        }
+        if (y + 1 != height)
+            return;
+
+        // the top block went away, look for the next one down
+        uint16_t old = height;
+        int below = y - 1;
+        while (below >= 0 && !matches_at(below))
+            below--;
+        height = static_cast<uint16_t>(below + 1);
+        if (old == m_max)
+            recalculate_max();
+    }
+
+private:
+    void recalculate_max();
+
+    std::array<uint16_t, 256> m_heights {};
+    uint16_t m_max = 0;
+};
+
+struct column_heightmaps {
+    // Blocks that block motion or contain fluid, what the sky light reaches
+    heightmap motion_blocking;
+    // Every block except air
+    heightmap world_surface;
+
+    // Reads the heightmaps NBT of a chunk packet, world_height is needed for
+    // the entry size
+    void load(proto::packet_reader &, size_t world_height);
+};
+
+}
@@ -0,0 +1,122 @@
+#include "light.hh"
+
+#include <algorithm>
+#include <cstring>
+
+namespace mccpp::world {
+
+const nibble_array::storage nibble_array::DARK {};
+const nibble_array::storage nibble_array::FULL = [] {
+    storage s {};
+    s.fill(std::byte(0xff));
+    return s;
+}();
+
+nibble_array::storage &nibble_array::make_owned() {
+    if (!m_owned) {
+        m_owned = std::make_unique<storage>(*m_data);
+        m_data = m_owned.get();
+    }
+    return *m_owned;
+}
+
+void nibble_array::set(size_t index, uint8_t level) {
+    if (get(index) == level)
+        return;
+    std::byte &b = make_owned()[index / 2];
+    if (index % 2 == 0) {
+        b = (b & std::byte(0xf0)) | std::byte(level & 0xf);
+    } else {
+        b = (b & std::byte(0x0f)) | std::byte(level << 4);
+    }
+}
+
+void nibble_array::assign(std::span<const std::byte, SIZE> data) {
+    auto uniform = [&](const storage &s) {
+        return std::memcmp(data.data(), s.data(), SIZE) == 0;
+    };
+    if (uniform(DARK)) {
+        fill(0);
+    } else if (uniform(FULL)) {
+        fill(15);
+    } else {
+        std::copy(data.begin(), data.end(), make_owned().begin());
+    }
+}
+
+void nibble_array::fill(uint8_t level) {
+    if (level == 0 || level == 15) {
+        m_owned.reset();
+        m_data = level == 0 ? &DARK : &FULL;
+        return;
+    }
+    make_owned().fill(std::byte(level | level << 4));
+}
+
+// A BitSet of the protocol, bit i is in long i / 64
+static std::vector<uint64_t> read_bitset(proto::packet_reader &s) {
+    int32_t count = s.read_varint();
+    if (count < 0 || static_cast<size_t>(count) > s.remaining() / 8)
+        throw proto::decode_error("invalid bitset length");
+    std::vector<uint64_t> bits(count);
+    for (uint64_t &word : bits) {
+        word = s.read_u64();
+    }
+    return bits;
+}
+
+static bool bit_set(const std::vector<uint64_t> &bits, size_t i) {
+    return i / 64 < bits.size() && (bits[i / 64] >> (i % 64) & 1);
+}
+
+// https://wiki.vg/index.php?title=Protocol&oldid=17979#Chunk_Data_and_Update_Light
+void column_light::load(proto::packet_reader &s) {
+    std::vector<uint64_t> sky_mask = read_bitset(s);
+    std::vector<uint64_t> block_mask = read_bitset(s);
+    std::vector<uint64_t> empty_sky_mask = read_bitset(s);
+    std::vector<uint64_t> empty_block_mask = read_bitset(s);
+
+    auto read_arrays = [&](const std::vector<uint64_t> &mask, const std::vector<uint64_t> &empty_mask,
+                           nibble_array section_light::*member) {
+        int32_t count = s.read_varint();
+        if (count < 0)
+            throw proto::decode_error("invalid light array count");
+        size_t section = 0;
+        for (int32_t i = 0; i < count; i++) {
+            while (section < m_sections.size() && !bit_set(mask, section))
+                section++;
+            if (section == m_sections.size())
+                throw proto::decode_error("more light arrays than sections");
+            int32_t length = s.read_varint();
+            if (length != nibble_array::SIZE)
+                throw proto::decode_error("invalid light array length");
+            // straight from the packet when possible
+            nibble_array::storage buffer;
+            std::span<const std::byte, nibble_array::SIZE> data = buffer;
+            if (auto unread = s.unread(); unread && unread->size() >= nibble_array::SIZE) {
+                data = unread->first<nibble_array::SIZE>();
+                s.discard(nibble_array::SIZE);
+            } else {
+                s.read_bytes(buffer);
+            }
+            (m_sections[section++].*member).assign(data);
+        }
+        for (size_t i = 0; i < m_sections.size(); i++) {
+            if (bit_set(empty_mask, i))
+                (m_sections[i].*member).fill(0);
+        }
+    };
+    read_arrays(sky_mask, empty_sky_mask, &section_light::sky);
+    read_arrays(block_mask, empty_block_mask, &section_light::block);
+}
+
+size_t column_light::allocated_bytes() const {
+    size_t bytes = 0;
+    for (const section_light &light : m_sections) {
+        bytes += light.sky.is_shared() ? 0 : nibble_array::SIZE;
+        bytes += light.block.is_shared() ? 0 : nibble_array::SIZE;
+    }
+    return bytes;
+}
+
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "../proto/packet.hh"
+
+namespace mccpp::world {
+
+// 4 bit light levels of one 16x16x16 section in the protocol layout, index
+// (y * 16 + z) * 16 + x with the even index in the low nibble. Completely
+// dark and completely lit sections point at shared storage and only get an
+// array of their own once they differ.
+class nibble_array {
+public:
+    static constexpr size_t SIZE = 2048;
+    using storage = std::array<std::byte, SIZE>;
+
+    nibble_array()
+    : m_data(&DARK)
+    {}
+
+    static nibble_array full() {
+        nibble_array a {};
+        a.m_data = &FULL;
+        return a;
+    }
+
+    uint8_t get(size_t index) const {
+        uint8_t b = static_cast<uint8_t>((*m_data)[index / 2]);
+        return index % 2 == 0 ? b & 0xf : b >> 4;
+    }
+
+    uint8_t get(int x, int y, int z) const {
+        return get(static_cast<size_t>((y * 16 + z) * 16 + x));
+    }
+
+    void set(size_t index, uint8_t level);
+
+    // Copies a section as sent by the server, uniform data drops the array
+    void assign(std::span<const std::byte, SIZE>);
+    void fill(uint8_t level);
+
+    // True while the array points at shared storage
+    bool is_shared() const { return !m_owned; }
+    bool is_dark() const { return m_data == &DARK; }
+    bool is_full() const { return m_data == &FULL; }
+
+    std::span<const std::byte, SIZE> data() const { return *m_data; }
+
+private:
+    static const storage DARK;
+    static const storage FULL;
+
+    storage &make_owned();
+
+    const storage *m_data;
+    std::unique_ptr<storage> m_owned;
+};
+
+struct section_light {
+    nibble_array sky;
+    nibble_array block;
+};
+
+// Light of a chunk column, which has one more section below and above the
+// block sections
+class column_light {
+public:
+    column_light(size_t sections)
+    : m_sections(sections + 2)
+    {}
+
+    // i = 0 is the section below the world
+    section_light &operator[](size_t i) { return m_sections[i]; }
+    const section_light &operator[](size_t i) const { return m_sections[i]; }
+    size_t count() const { return m_sections.size(); }
+
+    // Applies the masks and arrays shared by the chunk and light update
+    // packets. Sections in neither mask keep their light.
+    void load(proto::packet_reader &);
+
+    // Bytes allocated for arrays that aren't shared
+    size_t allocated_bytes() const;
+
+private:
+    std::vector<section_light> m_sections;
+};
+
+}
@@ -0,0 +1,180 @@
+#include "light_engine.hh"
+
+#include <algorithm>
+
+namespace mccpp::world {
+
+static constexpr int DIRECTIONS[6][3] = {
+    { -1, 0, 0 }, { 1, 0, 0 },
+    { 0, -1, 0 }, { 0, 1, 0 },
+    { 0, 0, -1 }, { 0, 0, 1 },
+};
+// Of the index into a section, in the same order
+static constexpr int INDEX_OFFSETS[6] = { -1, 1, -256, 256, -16, 16 };
+static constexpr size_t DOWN = 2;
+
+light_engine::node light_engine::queue::pop() {
+    node n = m_nodes[m_head++];
+    if (m_head == m_nodes.size()) {
+        m_nodes.clear();
+        m_head = 0;
+    } else if (m_head >= 4096 && m_head * 2 >= m_nodes.size()) {
+        // work left over from a budget running out keeps getting added to
+        m_nodes.erase(m_nodes.begin(), m_nodes.begin() + m_head);
+        m_head = 0;
+    }
+    return n;
+}
+
+void light_engine::set_properties(block_state state, light_properties p) {
+    while (m_properties.size() <= state) {
+        m_properties.push_back(properties(static_cast<block_state>(m_properties.size())));
+    }
+    m_properties[state] = p;
+}
+
+void light_engine::on_block_changed(chunk_manager &chunks, int32_t x, int32_t y, int32_t z,
+                                    block_state from, block_state to) {
+    light_properties before = properties(from);
+    light_properties after = properties(to);
+    if (before.emission == after.emission && before.opacity == after.opacity)
+        return;
+    m_cached = nullptr;
+    int light_y = y - m_min_y + 16;
+    cell c;
+    if (!locate(chunks, x, light_y, z, c))
+        return;
+
+    // the light the block had goes, a decrease from a block that was dark
+    // lets the light around it back in
+    for (bool sky : { false, true }) {
+        node n { x, z, static_cast<int16_t>(light_y), light_of(c, sky).get(c.index), sky };
+        m_decrease.push(n);
+        n.level = 0;
+        set_level(c, n);
+    }
+    if (after.emission > 0) {
+        node n { x, z, static_cast<int16_t>(light_y), after.emission, false };
+        set_level(c, n);
+        m_increase.push(n);
+    }
+}
+
+void light_engine::forget_column(int32_t chunk_x, int32_t chunk_z) {
+    m_cached = nullptr;
+    auto in_column = [&](const node &n) {
+        return n.x >> 4 == chunk_x && n.z >> 4 == chunk_z;
+    };
+    m_decrease.erase_if(in_column);
+    m_increase.erase_if(in_column);
+}
+
+size_t light_engine::update(chunk_manager &chunks, size_t budget) {
+    // columns may have been unloaded since the last call
+    m_cached = nullptr;
+    size_t done = 0;
+    for (; done < budget; done++) {
+        if (!m_decrease.empty())
+            decrease(chunks, m_decrease.pop());
+        else if (!m_increase.empty())
+            increase(chunks, m_increase.pop());
+        else
+            break;
+    }
+    return done;
+}
+
+bool light_engine::locate(chunk_manager &chunks, int32_t x, int y, int32_t z, cell &c) {
+    if (!m_cached || m_cached_x != x >> 4 || m_cached_z != z >> 4) {
+        chunk_column *column = chunks.try_get(x >> 4, z >> 4);
+        if (!column)
+            return false;
+        m_cached = column;
+        m_cached_x = x >> 4;
+        m_cached_z = z >> 4;
+    }
+    if (y < 0 || static_cast<size_t>(y >> 4) >= m_cached->light().count())
+        return false;
+    c.column = m_cached;
+    c.section = static_cast<size_t>(y >> 4);
+    c.blocks = c.section == 0 || c.section > m_cached->count() ? nullptr : &(*m_cached)[c.section - 1];
+    c.index = static_cast<size_t>(((y & 15) * 16 + (z & 15)) * 16 + (x & 15));
+    return true;
+}
+
+bool light_engine::neighbour(chunk_manager &chunks, const cell &from, const node &n, size_t direction,
+                             cell &to, node &next) {
+    const int (&d)[3] = DIRECTIONS[direction];
+    next = { n.x + d[0], n.z + d[2], static_cast<int16_t>(n.y + d[1]), 0, n.sky };
+    int axis = direction / 2;
+    int local = (axis == 0 ? n.x : axis == 1 ? n.y : n.z) & 15;
+    if (local != (direction % 2 == 0 ? 0 : 15)) {
+        to = from;
+        to.index = static_cast<size_t>(static_cast<int>(from.index) + INDEX_OFFSETS[direction]);
+        return true;
+    }
+    return locate(chunks, next.x, next.y, next.z, to);
+}
+
+void light_engine::set_level(const cell &c, const node &n) {
+    light_of(c, n.sky).set(c.index, n.level);
+    int32_t section_y = (n.y >> 4) + m_min_y / 16 - 1;
+    uint64_t key = (uint64_t(n.x >> 4) & 0x3fffff) << 42 | (uint64_t(n.z >> 4) & 0x3fffff) << 20
+        | (uint64_t(section_y) & 0xfffff);
+    *m_changed.emplace(key, 0u).first |= section_border_mask(n.x & 15, n.y & 15, n.z & 15);
+}
+
+void light_engine::increase(chunk_manager &chunks, const node &n) {
+    cell c;
+    // a decrease went through it since it was queued
+    if (!locate(chunks, n.x, n.y, n.z, c) || light_of(c, n.sky).get(c.index) != n.level)
+        return;
+    for (size_t direction = 0; direction < 6; direction++) {
+        cell to;
+        node next;
+        if (!neighbour(chunks, c, n, direction, to, next))
+            continue;
+        uint8_t opacity = properties_at(to).opacity;
+        // sky light goes straight down through clear blocks at full strength
+        int loss = n.sky && n.level == 15 && direction == DOWN && opacity == 0 ? 0 : std::max<int>(opacity, 1);
+        int level = n.level - loss;
+        if (level <= light_of(to, n.sky).get(to.index))
+            continue;
+        next.level = static_cast<uint8_t>(level);
+        set_level(to, next);
+        m_increase.push(next);
+    }
+}
+
+void light_engine::decrease(chunk_manager &chunks, const node &n) {
+    cell c;
+    if (!locate(chunks, n.x, n.y, n.z, c))
+        return;
+    for (size_t direction = 0; direction < 6; direction++) {
+        cell to;
+        node next;
+        if (!neighbour(chunks, c, n, direction, to, next))
+            continue;
+        uint8_t level = light_of(to, n.sky).get(to.index);
+        if (level == 0)
+            continue;
+        // brighter neighbours get their light from elsewhere and spread it
+        // back into the dark left behind
+        bool from_here = level < n.level || (n.sky && n.level == 15 && level == 15 && direction == DOWN);
+        if (!from_here) {
+            next.level = level;
+            m_increase.push(next);
+            continue;
+        }
+        set_level(to, next);
+        next.level = level;
+        m_decrease.push(next);
+        if (uint8_t emission = n.sky ? 0 : properties_at(to).emission) {
+            next.level = emission;
+            set_level(to, next);
+            m_increase.push(next);
+        }
+    }
+}
+
+}
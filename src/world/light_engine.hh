@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../utility/flat_map.hh"
+#include "chunk.hh"
+
+namespace mccpp::world {
+
+// How a block state takes part in lighting
+struct light_properties {
+    // Block light level it gives off
+    uint8_t emission = 0;
+    // Levels light loses going into it, at least one is lost per block
+    // anyway and 15 stops light
+    uint8_t opacity = 15;
+};
+
+// Keeps block and sky light up to date after blocks change, without waiting
+// for the server. Changes are queued and propagated breadth first over the
+// nibble arrays of the loaded columns, light that has to go is taken away
+// first and the light around it spreads back in afterwards. Work is done in
+// bounded steps so a large change is spread over a few frames. Nothing is
+// queued until block properties are set.
+class light_engine {
+public:
+    static constexpr size_t DEFAULT_BUDGET = 1 << 14;
+
+    explicit light_engine(int32_t min_y)
+    : m_min_y(min_y)
+    {}
+
+    // Of every state in the generated block data
+    static const std::vector<light_properties> &baked_properties();
+
+    bool enabled() const { return !m_properties.empty(); }
+
+    // States without properties set, air is clear and the rest opaque and
+    // dark
+    light_properties properties(block_state state) const {
+        if (state < m_properties.size())
+            return m_properties[state];
+        return state == AIR ? light_properties { 0, 0 } : light_properties {};
+    }
+    void set_properties(std::vector<light_properties> properties) { m_properties = std::move(properties); }
+    void set_properties(block_state, light_properties);
+
+    // Queues the light changes of a block that changed from one state to
+    // another, the block has to be set already
+    void on_block_changed(chunk_manager &, int32_t x, int32_t y, int32_t z, block_state from, block_state to);
+
+    // Propagates queued changes, at most budget queue entries and light
+    // being taken away before light spreading. Returns the number of entries
+    // processed.
+    size_t update(chunk_manager &, size_t budget = DEFAULT_BUDGET);
+    size_t pending() const { return m_decrease.size() + m_increase.size(); }
+
+    // Drops the work queued in a column, its light came from the server
+    // again or it went away
+    void forget_column(int32_t chunk_x, int32_t chunk_z);
+
+    // Calls f(section, border_mask) for every section in chunk coordinates
+    // whose light changed since the last call, border_mask as for
+    // section_border_mask of the blocks that changed
+    template<typename F>
+    void take_changed_sections(F &&f) {
+        m_changed.for_each([&](uint64_t key, unsigned &borders) {
+            int64_t raw = static_cast<int64_t>(key);
+            f(glm::ivec3 {
+                static_cast<int32_t>(raw >> 42),
+                static_cast<int32_t>(raw << 44 >> 44),
+                static_cast<int32_t>(raw << 22 >> 42),
+            }, borders);
+        });
+        m_changed = {};
+    }
+
+private:
+    // A block with the level it had or got, y counts from the bottom of
+    // the section below the world
+    struct node {
+        int32_t x;
+        int32_t z;
+        int16_t y;
+        uint8_t level;
+        bool sky;
+    };
+
+    // FIFO that keeps its storage, entries before head are done
+    class queue {
+    public:
+        void push(const node &n) { m_nodes.push_back(n); }
+        node pop();
+        bool empty() const { return m_head == m_nodes.size(); }
+        size_t size() const { return m_nodes.size() - m_head; }
+        template<typename P>
+        void erase_if(P &&predicate) {
+            m_nodes.erase(m_nodes.begin(), m_nodes.begin() + static_cast<ptrdiff_t>(m_head));
+            m_head = 0;
+            std::erase_if(m_nodes, predicate);
+        }
+
+    private:
+        std::vector<node> m_nodes;
+        size_t m_head = 0;
+    };
+
+    // Where a block is in the loaded columns
+    struct cell {
+        chunk_column *column;
+        // Null for the sections below and above the world, they hold air
+        const chunk *blocks;
+        // Into the column light, 0 is the section below the world
+        size_t section;
+        size_t index;
+    };
+
+    bool locate(chunk_manager &, int32_t x, int y, int32_t z, cell &);
+    // The neighbour of a located block in one of the DIRECTIONS, without
+    // looking anything up when it's in the same section
+    bool neighbour(chunk_manager &, const cell &, const node &, size_t direction, cell &, node &);
+    light_properties properties_at(const cell &c) const {
+        return properties(c.blocks ? c.blocks->states[c.index] : AIR);
+    }
+    static nibble_array &light_of(const cell &c, bool sky) {
+        section_light &light = c.column->light()[c.section];
+        return sky ? light.sky : light.block;
+    }
+    void set_level(const cell &, const node &);
+
+    void increase(chunk_manager &, const node &);
+    void decrease(chunk_manager &, const node &);
+
+    int32_t m_min_y;
+    std::vector<light_properties> m_properties;
+    queue m_increase;
+    queue m_decrease;
+    // Column of the last lookup, neighbours mostly are in the same one
+    int32_t m_cached_x = 0;
+    int32_t m_cached_z = 0;
+    chunk_column *m_cached = nullptr;
+    // Section positions packed like the section blocks update packet does
+    flat_u64_map<unsigned> m_changed;
+};
+
+}
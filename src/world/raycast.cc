@@ -0,0 +1,169 @@
+#include "raycast.hh"
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#include "world.hh"
+
+namespace mccpp::world {
+
+namespace {
+
+// Remembers the section the ray is in so that stepping inside of it doesn't
+// go through the chunk manager
+class section_cache {
+public:
+    explicit section_cache(world &w)
+    : m_chunks(w.chunks())
+    , m_min_section(w.min_y() >> 4)
+    , m_sections(static_cast<int32_t>(w.chunks().height_in_chunks()))
+    {}
+
+    int32_t min_section() const { return m_min_section; }
+    int32_t max_section() const { return m_min_section + m_sections; }
+
+    // nullptr outside of loaded columns and the world height
+    const chunk *get(glm::ivec3 section) {
+        if (section == m_section_pos)
+            return m_section;
+        m_section_pos = section;
+        if (section.x != m_column_x || section.z != m_column_z || !m_column_valid) {
+            m_column = m_chunks.try_get(section.x, section.z);
+            m_column_x = section.x;
+            m_column_z = section.z;
+            m_column_valid = true;
+        }
+        int32_t index = section.y - m_min_section;
+        m_section = m_column && index >= 0 && index < m_sections ? &(*m_column)[index] : nullptr;
+        return m_section;
+    }
+
+private:
+    chunk_manager &m_chunks;
+    int32_t m_min_section;
+    int32_t m_sections;
+
+    glm::ivec3 m_section_pos { std::numeric_limits<int32_t>::min() };
+    const chunk *m_section = nullptr;
+    int32_t m_column_x = 0;
+    int32_t m_column_z = 0;
+    bool m_column_valid = false;
+    chunk_column *m_column = nullptr;
+};
+
+}
+
+static std::optional<ray_hit> cast(section_cache &cache, const ray &r) {
+    constexpr double INF = std::numeric_limits<double>::infinity();
+
+    double length = glm::length(r.direction);
+    // a horizontal ray without a limit would never leave the world
+    if (!(length > 0.) || !(r.max_distance >= 0.) || !std::isfinite(r.max_distance))
+        return std::nullopt;
+    glm::dvec3 dir = r.direction / length;
+
+    glm::ivec3 voxel { glm::floor(r.origin) };
+    glm::ivec3 step {};
+    // distance along the ray between two borders on an axis
+    glm::dvec3 t_delta {};
+    // distance along the ray to the next border on an axis
+    glm::dvec3 t_max {};
+    for (int a = 0; a < 3; a++) {
+        if (dir[a] > 0.) {
+            step[a] = 1;
+            t_delta[a] = 1. / dir[a];
+            t_max[a] = (voxel[a] + 1 - r.origin[a]) * t_delta[a];
+        } else if (dir[a] < 0.) {
+            step[a] = -1;
+            t_delta[a] = -1. / dir[a];
+            t_max[a] = (r.origin[a] - voxel[a]) * t_delta[a];
+        } else {
+            t_delta[a] = INF;
+            t_max[a] = INF;
+        }
+    }
+
+    auto section_of = [](glm::ivec3 v) { return glm::ivec3 { v.x >> 4, v.y >> 4, v.z >> 4 }; };
+    const chunk *section = cache.get(section_of(voxel));
+    // checking whether a section is empty costs a cache miss of its own, so
+    // in the section the ray starts in, which is usually the one the player
+    // is in, short rays just walk. Sections entered later are checked first.
+    int unchecked_steps = 4;
+
+    double t = 0.;
+    glm::ivec3 face {};
+    while (t <= r.max_distance) {
+        if (section && (--unchecked_steps > 0 || section->non_air != 0)) {
+            block_state state = section->state_at(voxel.x & 15, voxel.y & 15, voxel.z & 15);
+            if (state != AIR)
+                return ray_hit { voxel, face, t, state };
+
+            int a = t_max.x < t_max.y ? (t_max.x < t_max.z ? 0 : 2) : (t_max.y < t_max.z ? 1 : 2);
+            t = t_max[a];
+            voxel[a] += step[a];
+            t_max[a] += t_delta[a];
+            face = {};
+            face[a] = -step[a];
+            if ((voxel[a] & 15) == (step[a] > 0 ? 0 : 15)) {
+                section = cache.get(section_of(voxel));
+                unchecked_steps = 0;
+            }
+            continue;
+        }
+
+        // nothing comes back once the ray left the world height
+        int32_t section_y = voxel.y >> 4;
+        if ((section_y < cache.min_section() && step.y <= 0)
+                || (section_y >= cache.max_section() && step.y >= 0))
+            return std::nullopt;
+
+        // empty: jump to the block where the ray leaves the section, n is
+        // the number of borders to cross on an axis before the section ends
+        glm::ivec3 n {};
+        glm::dvec3 t_exit { INF };
+        for (int a = 0; a < 3; a++) {
+            if (step[a] == 0)
+                continue;
+            n[a] = step[a] > 0 ? 15 - (voxel[a] & 15) : voxel[a] & 15;
+            t_exit[a] = t_max[a] + n[a] * t_delta[a];
+        }
+        int exit = t_exit.x < t_exit.y ? (t_exit.x < t_exit.z ? 0 : 2) : (t_exit.y < t_exit.z ? 1 : 2);
+        double leave = t_exit[exit];
+        for (int a = 0; a < 3; a++) {
+            int32_t k = 0;
+            if (a == exit) {
+                k = n[a] + 1;
+            } else if (step[a] != 0 && t_max[a] < leave) {
+                double crossed = std::floor((leave - t_max[a]) / t_delta[a]) + 1.;
+                k = static_cast<int32_t>(std::min<double>(crossed, n[a]));
+            }
+            // 0 * inf would turn the axes the ray doesn't move on into nan
+            if (k != 0) {
+                voxel[a] += step[a] * k;
+                t_max[a] += k * t_delta[a];
+            }
+        }
+        t = leave;
+        face = {};
+        face[exit] = -step[exit];
+        section = cache.get(section_of(voxel));
+        unchecked_steps = 0;
+    }
+    return std::nullopt;
+}
+
+std::optional<ray_hit> raycast(world &w, const ray &r) {
+    section_cache cache { w };
+    return cast(cache, r);
+}
+
+void raycast(world &w, std::span<const ray> rays, std::span<std::optional<ray_hit>> hits) {
+    assert(rays.size() == hits.size());
+    section_cache cache { w };
+    for (size_t i = 0; i < rays.size(); i++) {
+        hits[i] = cast(cache, rays[i]);
+    }
+}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <optional>
+#include <span>
+
+#include <glm/glm.hpp>
+
+#include "chunk.hh"
+
+namespace mccpp::world {
+
+class world;
+
+struct ray {
+    glm::dvec3 origin;
+    // Doesn't have to be normalized
+    glm::dvec3 direction;
+    double max_distance;
+};
+
+struct ray_hit {
+    glm::ivec3 block;
+    // Normal of the face the ray entered the block through, zero when it
+    // started inside of it
+    glm::ivec3 face;
+    // Along the ray to where it entered the block
+    double distance;
+    block_state state;
+};
+
+// Walks the blocks along the ray (Amanatides & Woo) until one that isn't air.
+// Sections without blocks and unloaded columns are crossed in a single step.
+std::optional<ray_hit> raycast(world &, const ray &);
+
+// Casts every ray, hits[i] is the result of rays[i]. Cheaper than single
+// casts for rays close to each other since the section lookups are shared.
+void raycast(world &, std::span<const ray> rays, std::span<std::optional<ray_hit>> hits);
+
+}
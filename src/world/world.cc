@@ -0,0 +1,238 @@
+#include "world.hh"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace mccpp::world {
+
+static uint64_t pack_section(glm::ivec3 s) {
+    return (uint64_t(s.x) & 0x3fffff) << 42 | (uint64_t(s.z) & 0x3fffff) << 20 | (uint64_t(s.y) & 0xfffff);
+}
+
+static glm::ivec3 unpack_section(uint64_t v) {
+    int64_t raw = static_cast<int64_t>(v);
+    return {
+        static_cast<int32_t>(raw >> 42),
+        static_cast<int32_t>(raw << 44 >> 44),
+        static_cast<int32_t>(raw << 22 >> 42),
+    };
+}
+
+static uint64_t pack_column(int32_t x, int32_t z) {
+    return uint64_t(std::bit_cast<uint32_t>(x)) << 32 | std::bit_cast<uint32_t>(z);
+}
+
+block_state world::block_state_at(int32_t x, int32_t y, int32_t z) {
+    int32_t section = (y - m_min_y) >> 4;
+    chunk_column *column = m_chunks.try_get(x >> 4, z >> 4);
+    if (!column || section < 0 || static_cast<size_t>(section) >= column->count())
+        return AIR;
+    return (*column)[section].state_at(x & 15, (y - m_min_y) & 15, z & 15);
+}
+
+bool world::set_block(int32_t x, int32_t y, int32_t z, block_state state) {
+    int32_t height = y - m_min_y;
+    chunk_column *column = m_chunks.try_get(x >> 4, z >> 4);
+    if (!column || height < 0 || static_cast<size_t>(height >> 4) >= column->count())
+        return false;
+    chunk &c = (*column)[height >> 4];
+    block_state from = c.state_at(x & 15, height & 15, z & 15);
+    if (!c.set_state(x & 15, height & 15, z & 15, state))
+        return false;
+    m_chunks.touch(*column);
+    if (m_light.enabled())
+        m_light.on_block_changed(m_chunks, x, y, z, from, state);
+    // tints are blended from the biomes at the surface
+    if (update_heightmaps(*column, x & 15, height, z & 15, state))
+        forget_tints_around(x >> 4, z >> 4);
+    if (state == AIR)
+        column->block_entities().remove(x & 15, y, z & 15);
+    mark_dirty({ x >> 4, y >> 4, z >> 4 }, section_border_mask(x & 15, height & 15, z & 15));
+    return true;
+}
+
+size_t world::set_blocks(glm::ivec3 section, std::span<const int64_t> entries) {
+    int32_t index = section.y - m_min_y / 16;
+    chunk_column *column = m_chunks.try_get(section.x, section.z);
+    if (!column || index < 0 || static_cast<size_t>(index) >= column->count())
+        return 0;
+
+    chunk &c = (*column)[index];
+    size_t changed = 0;
+    unsigned borders = 0;
+    bool surface_changed = false;
+    for (int64_t entry : entries) {
+        uint64_t state = static_cast<uint64_t>(entry) >> 12;
+        if (state > std::numeric_limits<block_state>::max())
+            throw proto::decode_error("invalid block state");
+        int x = entry >> 8 & 15;
+        int z = entry >> 4 & 15;
+        int y = entry & 15;
+        block_state from = c.state_at(x, y, z);
+        if (!c.set_state(x, y, z, static_cast<block_state>(state)))
+            continue;
+        if (m_light.enabled()) {
+            m_light.on_block_changed(m_chunks, section.x * 16 + x, section.y * 16 + y, section.z * 16 + z, from,
+                                     static_cast<block_state>(state));
+        }
+        surface_changed |= update_heightmaps(*column, x, index * 16 + y, z, static_cast<block_state>(state));
+        if (state == AIR)
+            column->block_entities().remove(x, section.y * 16 + y, z);
+        borders |= section_border_mask(x, y, z);
+        changed++;
+    }
+    if (changed > 0) {
+        m_chunks.touch(*column);
+        mark_dirty(section, borders);
+        if (surface_changed)
+            forget_tints_around(section.x, section.z);
+    }
+    return changed;
+}
+
+size_t world::update_light(size_t budget) {
+    size_t done = m_light.update(m_chunks, budget);
+    m_light.take_changed_sections([&](glm::ivec3 section, unsigned borders) {
+        mark_dirty(section, borders);
+    });
+    return done;
+}
+
+void world::on_column_loaded(int32_t chunk_x, int32_t chunk_z) {
+    m_revision++;
+    m_light.forget_column(chunk_x, chunk_z);
+    int32_t min_section = m_min_y / 16;
+    for (size_t i = 0; i < m_chunks.height_in_chunks(); i++) {
+        m_dirty_sections.emplace(pack_section({ chunk_x, min_section + int32_t(i), chunk_z }));
+    }
+    // the faces of loaded neighbours toward it were meshed against nothing
+    const glm::ivec2 sides[] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+    for (glm::ivec2 side : sides) {
+        if (!m_chunks.try_get(chunk_x + side.x, chunk_z + side.y))
+            continue;
+        for (size_t i = 0; i < m_chunks.height_in_chunks(); i++) {
+            m_dirty_sections.emplace(pack_section({ chunk_x + side.x, min_section + int32_t(i), chunk_z + side.y }));
+        }
+    }
+    // the neighbours blend with its biomes now
+    forget_tints_around(chunk_x, chunk_z);
+    if (m_chunks.over_budget())
+        evict_columns();
+}
+
+void world::on_light_loaded(int32_t chunk_x, int32_t chunk_z) {
+    m_light.forget_column(chunk_x, chunk_z);
+}
+
+void world::unload_column(int32_t chunk_x, int32_t chunk_z) {
+    m_chunks.unload(chunk_x, chunk_z);
+    m_light.forget_column(chunk_x, chunk_z);
+    m_tints.erase(pack_column(chunk_x, chunk_z));
+    m_revision++;
+    glm::ivec2 column { chunk_x, chunk_z };
+    forget_dirty_sections({ &column, 1 });
+}
+
+void world::set_center(int32_t chunk_x, int32_t chunk_z) {
+    m_chunks.set_center(chunk_x, chunk_z);
+    evict_columns();
+}
+
+size_t world::evict_columns() {
+    std::vector<glm::ivec2> evicted {};
+    m_chunks.evict(evicted);
+    if (!evicted.empty()) {
+        m_revision++;
+        forget_dirty_sections(evicted);
+        for (glm::ivec2 column : evicted) {
+            m_tints.erase(pack_column(column.x, column.y));
+            m_light.forget_column(column.x, column.y);
+        }
+    }
+    return evicted.size();
+}
+
+const column_tints *world::tints(int32_t chunk_x, int32_t chunk_z) {
+    if (!m_chunks.try_get(chunk_x, chunk_z))
+        return nullptr;
+    uint64_t key = pack_column(chunk_x, chunk_z);
+    if (std::unique_ptr<column_tints> *cached = m_tints.find(key))
+        return cached->get();
+    auto tints = std::make_unique<column_tints>(m_blender.blend(m_chunks, chunk_x, chunk_z));
+    return m_tints.emplace(key, std::move(tints)).first->get();
+}
+
+void world::set_biome_blend_radius(int radius) {
+    m_blender.set_radius(radius);
+    m_tints = {};
+}
+
+std::vector<glm::ivec3> world::take_dirty_sections() {
+    std::vector<glm::ivec3> sections {};
+    sections.reserve(m_dirty_sections.size());
+    for (uint64_t packed : m_dirty_sections) {
+        sections.emplace_back(unpack_section(packed));
+    }
+    m_dirty_sections.clear();
+    return sections;
+}
+
+void world::forget_dirty_sections(std::span<const glm::ivec2> columns) {
+    std::erase_if(m_dirty_sections, [&](uint64_t packed) {
+        glm::ivec3 s = unpack_section(packed);
+        return std::any_of(columns.begin(), columns.end(), [&](glm::ivec2 c) { return c.x == s.x && c.y == s.z; });
+    });
+}
+
+void world::mark_dirty(glm::ivec3 section, unsigned border_mask) {
+    m_revision++;
+    int32_t min_section = m_min_y / 16;
+    int32_t max_section = min_section + static_cast<int32_t>(m_chunks.height_in_chunks());
+    auto mark = [&](glm::ivec3 s) {
+        // unloaded neighbours get meshed once they arrive
+        if (s.y >= min_section && s.y < max_section && m_chunks.try_get(s.x, s.z))
+            m_dirty_sections.emplace(pack_section(s));
+    };
+    mark(section);
+    for (int axis = 0; axis < 3; axis++) {
+        glm::ivec3 offset {};
+        offset[axis] = 1;
+        if (border_mask & (1u << (axis * 2)))
+            mark(section - offset);
+        if (border_mask & (1u << (axis * 2 + 1)))
+            mark(section + offset);
+    }
+}
+
+// Vanilla also counts fluids as motion blocking, they have no collision and
+// the block data doesn't tell them apart, so after edits motion_blocking
+// misses water and lava until the server sends the heightmaps again
+bool world::update_heightmaps(chunk_column &column, int x, int y, int z, block_state state) {
+    uint16_t surface = column.heightmaps().world_surface.at(x, z);
+    auto state_at = [&](int below) {
+        return column[below >> 4].state_at(x, below & 15, z);
+    };
+    auto blocks_motion = [this](block_state s) {
+        return m_shapes ? m_shapes->shape(s) != collision_shapes::EMPTY : s != AIR;
+    };
+    column.heightmaps().world_surface.update(x, y, z, state != AIR, [&](int below) {
+        return state_at(below) != AIR;
+    });
+    column.heightmaps().motion_blocking.update(x, y, z, blocks_motion(state), [&](int below) {
+        return blocks_motion(state_at(below));
+    });
+    return column.heightmaps().world_surface.at(x, z) != surface;
+}
+
+void world::forget_tints_around(int32_t chunk_x, int32_t chunk_z) {
+    if (m_tints.empty())
+        return;
+    for (int32_t dz = -1; dz <= 1; dz++) {
+        for (int32_t dx = -1; dx <= 1; dx++) {
+            m_tints.erase(pack_column(chunk_x + dx, chunk_z + dz));
+        }
+    }
+}
+
+}
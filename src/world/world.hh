@@ -1,19 +1,139 @@
 #pragma once
 
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../utility/flat_map.hh"
+#include "biome.hh"
 #include "chunk.hh"
+#include "collision.hh"
+#include "entities.hh"
+#include "light_engine.hh"
 
 namespace mccpp::world {
 
 class world {
 public:
-    world(size_t world_height)
-    : m_chunks(world_height / 16)
+    world(int32_t min_y, size_t world_height, std::vector<biome> biomes)
+    : m_min_y(min_y)
+    , m_chunks(world_height / 16)
+    , m_biomes(std::move(biomes))
+    , m_blender(m_biomes)
+    , m_light(min_y)
     {}
 
+    // Lowest block, chunk sections start here
+    int32_t min_y() const { return m_min_y; }
+
     chunk_manager &chunks() { return m_chunks; }
+    entity_store &entities() { return m_entities; }
+    light_engine &light() { return m_light; }
+
+    // Edits count blocks with collision for the motion blocking heightmap,
+    // without shapes every block but air. shapes must outlive the world.
+    void set_collision_shapes(const collision_shapes &shapes) { m_shapes = &shapes; }
+
+    // Y of the highest block that isn't air, nullopt for empty or missing
+    // columns
+    std::optional<int32_t> highest_block(int32_t x, int32_t z) {
+        chunk_column *column = m_chunks.try_get(x >> 4, z >> 4);
+        if (!column)
+            return std::nullopt;
+        uint16_t height = column->heightmaps().world_surface.at(x & 15, z & 15);
+        if (height == 0)
+            return std::nullopt;
+        return m_min_y + height - 1;
+    }
+
+    // True when no block of a loaded column reaches into the section at
+    // section_y, that is block y / 16, so it only holds air
+    bool is_above_surface(int32_t chunk_x, int32_t section_y, int32_t chunk_z) {
+        chunk_column *column = m_chunks.try_get(chunk_x, chunk_z);
+        int32_t section = section_y - m_min_y / 16;
+        if (!column || section < 0)
+            return false;
+        return column->heightmaps().world_surface.is_above(section);
+    }
+
+    // Indexed by registry id, entries the server left out have no name
+    const std::vector<biome> &biomes() const { return m_biomes; }
+
+    // Biome colours of a loaded column blended with the ones around it, the
+    // mesher looks tints up in there. Worked out on first use and kept until
+    // a column next to it loads or the surface height in or next to it
+    // changes. Null for missing columns.
+    const column_tints *tints(int32_t chunk_x, int32_t chunk_z);
+    int biome_blend_radius() const { return m_blender.radius(); }
+    // In blocks, the cached tints are worked out again
+    void set_biome_blend_radius(int radius);
+
+    // Global palette id of a block, AIR outside of loaded columns
+    block_state block_state_at(int32_t x, int32_t y, int32_t z);
+
+    // Changes a single block, returns false when it's outside of the loaded
+    // columns or already had that state
+    bool set_block(int32_t x, int32_t y, int32_t z, block_state);
+
+    // Changes several blocks of one section, packed as in the section blocks
+    // update packet: state << 12 | x << 8 | z << 4 | y. Returns the number of
+    // blocks that changed.
+    size_t set_blocks(glm::ivec3 section, std::span<const int64_t> entries);
+
+    // Propagates the light changes of edited blocks, at most budget steps,
+    // and marks the sections whose light changed dirty. Returns the number
+    // of steps done. Blocks only queue changes once the light engine has
+    // block properties.
+    size_t update_light(size_t budget = light_engine::DEFAULT_BUDGET);
+
+    // After a column was (re)loaded, the column may be evicted right away
+    // when the memory budget is exceeded
+    void on_column_loaded(int32_t chunk_x, int32_t chunk_z);
+    // The server sent new light for a loaded column
+    void on_light_loaded(int32_t chunk_x, int32_t chunk_z);
+    void unload_column(int32_t chunk_x, int32_t chunk_z);
+
+    // Follows the player to the chunk and drops the columns left behind
+    void set_center(int32_t chunk_x, int32_t chunk_z);
+    // Runs an eviction pass of the chunk manager, returns the number of
+    // dropped columns
+    size_t evict_columns();
+
+    // Sections in chunk coordinates whose mesh is out of date, cleared by
+    // the call
+    std::vector<glm::ivec3> take_dirty_sections();
+    size_t dirty_section_count() const { return m_dirty_sections.size(); }
+
+    // Changes whenever blocks change or columns come and go, so caches of
+    // block data can tell whether they are out of date
+    uint64_t revision() const { return m_revision; }
 
 private:
+    // The section and the neighbours sharing one of the borders in
+    // border_mask, bit 2 * axis for the low and 2 * axis + 1 for the high side
+    void mark_dirty(glm::ivec3 section, unsigned border_mask = 0);
+    // Returns whether the world surface height changed
+    bool update_heightmaps(chunk_column &, int x, int y, int z, block_state);
+    // Of the column and the ones that blend with it
+    void forget_tints_around(int32_t chunk_x, int32_t chunk_z);
+    void forget_dirty_sections(std::span<const glm::ivec2> columns);
+
+    int32_t m_min_y;
     chunk_manager m_chunks;
+    entity_store m_entities;
+    std::vector<biome> m_biomes;
+    biome_blender m_blender;
+    light_engine m_light;
+    const collision_shapes *m_shapes = nullptr;
+    // By column position packed like the chunk manager does
+    flat_u64_map<std::unique_ptr<column_tints>> m_tints;
+    // Section positions packed like the section blocks update packet does
+    std::unordered_set<uint64_t> m_dirty_sections;
+    uint64_t m_revision = 0;
 };
 
 }
@@ -0,0 +1,70 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <span>
+#include <vector>
+
+#include "nbt.hh"
+
+using namespace mccpp;
+
+static std::vector<std::byte> to_vector(const proto::packet_writer &w) {
+    std::span<const std::byte> bytes = w;
+    return { bytes.begin(), bytes.end() };
+}
+
+TEST_CASE("nbt array tags", "[nbt]") {
+    // odd lengths so the bulk byteswap has a tail
+    std::vector<int8_t> bytes { -1, 0, 1, 127, -128 };
+    std::vector<int32_t> ints {};
+    std::vector<int64_t> longs {};
+    for (int32_t i = 0; i < 37; i++) {
+        ints.emplace_back(i * 0x01020304 - 0x7fffffff);
+        longs.emplace_back(int64_t(i) * 0x0102030405060708 - INT64_MAX);
+    }
+
+    proto::packet_writer w {};
+    nbt::writer n { w };
+    n.begin_compound();
+    n.write_byte_array("bytes", bytes);
+    n.write_int_array("ints", ints);
+    n.write_long_array("longs", longs);
+    n.write_int_array("empty", {});
+    n.end_compound();
+    std::vector<std::byte> data = to_vector(w);
+
+    auto check = [&](proto::packet_reader &s) {
+        nbt::nbt tree { s };
+        REQUIRE(s.remaining() == 0);
+        auto it = tree.root().as_compound().begin();
+        REQUIRE(std::get<1>(*it++)->as_byte_array().values() == bytes);
+        REQUIRE(std::get<1>(*it++)->as_int_array().values() == ints);
+        REQUIRE(std::get<1>(*it++)->as_long_array().values() == longs);
+        REQUIRE(std::get<1>(*it++)->as_int_array().values().empty());
+    };
+
+    proto::packet_reader memory { data };
+    check(memory);
+
+    size_t offset = 0;
+    proto::packet_reader callback { [&] { return data.at(offset++); }, data.size() };
+    check(callback);
+}
+
+TEST_CASE("nbt array lengths are checked", "[nbt]") {
+    proto::packet_writer w {};
+    nbt::writer n { w };
+    n.begin_compound();
+    n.write_long_array("longs", std::vector<int64_t> { 1, 2, 3 });
+    n.end_compound();
+    std::vector<std::byte> data = to_vector(w);
+
+    // name "longs" ends at offset 11, claim two billion elements
+    std::vector<std::byte> huge = data;
+    huge[11] = std::byte(0x7f);
+    proto::packet_reader s { huge };
+    REQUIRE_THROWS_AS(nbt::nbt { s }, nbt::parse_error);
+
+    std::vector<std::byte> truncated(data.begin(), data.end() - 5);
+    proto::packet_reader t { truncated };
+    REQUIRE_THROWS(nbt::nbt { t });
+}
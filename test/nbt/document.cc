@@ -0,0 +1,115 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "nbt_document.hh"
+
+using namespace mccpp;
+
+static std::vector<std::byte> to_vector(const proto::packet_writer &w) {
+    std::span<const std::byte> bytes = w;
+    return { bytes.begin(), bytes.end() };
+}
+
+static std::vector<std::byte> registry() {
+    proto::packet_writer w {};
+    nbt::writer n { w };
+    n.begin_compound();
+    n.begin_compound("minecraft:dimension_type");
+    n.write_string("type", "minecraft:dimension_type");
+    n.begin_list("value", nbt::TAG_COMPOUND, 2);
+    for (std::string_view name : { "minecraft:overworld", "minecraft:the_nether" }) {
+        n.begin_compound();
+        n.write_string("name", name);
+        n.write_int("id", name == "minecraft:overworld" ? 0 : 1);
+        n.begin_compound("element");
+        n.write_int("min_y", name == "minecraft:overworld" ? -64 : 0);
+        n.write_int("height", name == "minecraft:overworld" ? 384 : 256);
+        n.write_byte("natural", name == "minecraft:overworld");
+        n.write_double("coordinate_scale", name == "minecraft:overworld" ? 1. : 8.);
+        n.write_float("ambient_light", name == "minecraft:overworld" ? 0.f : .1f);
+        n.end_compound();
+        n.end_compound();
+    }
+    n.end_list();
+    n.end_compound();
+    n.begin_list("empty", nbt::TAG_END, 0);
+    n.end_list();
+    n.write_long_array("longs", std::vector<int64_t> { 1, -2, INT64_MAX });
+    n.write_int_array("ints", std::vector<int32_t> { -1, 0x12345678 });
+    n.begin_list("shorts", nbt::TAG_SHORT, 3);
+    n.write_short({}, 1);
+    n.write_short({}, -2);
+    n.write_short({}, 3);
+    n.end_list();
+    n.write_long("a_long", -5);
+    n.end_compound();
+    return to_vector(w);
+}
+
+TEST_CASE("nbt document lookups", "[nbt][document]") {
+    std::vector<std::byte> bytes = registry();
+    bytes.emplace_back(std::byte(0x42));
+    proto::packet_reader s { bytes };
+    nbt::document doc { s };
+    REQUIRE(s.remaining() == 1);
+
+    auto root = doc.root();
+    REQUIRE(root.has_value());
+    REQUIRE(root->type() == nbt::TAG_COMPOUND);
+    REQUIRE(root->size() == 6);
+    REQUIRE_FALSE(root->find("missing").has_value());
+
+    // compound children are in name order
+    std::vector<std::string_view> names {};
+    for (nbt::document::value child : *root) {
+        names.emplace_back(child.name());
+    }
+    REQUIRE(names == std::vector<std::string_view> { "a_long", "empty", "ints", "longs", "minecraft:dimension_type", "shorts" });
+
+    auto dimensions = root->find("minecraft:dimension_type")->find("value");
+    REQUIRE(dimensions.has_value());
+    REQUIRE(dimensions->type() == nbt::TAG_LIST);
+    REQUIRE(dimensions->size() == 2);
+    nbt::document::value nether = (*dimensions)[1];
+    REQUIRE(nether.find("name")->as_string() == "minecraft:the_nether");
+    auto element = nether.find("element");
+    REQUIRE(element->find("height")->as_int() == 256);
+    REQUIRE(element->find("min_y")->as_int() == 0);
+    REQUIRE(element->find("natural")->as_byte() == 0);
+    REQUIRE(element->find("coordinate_scale")->as_double() == 8.);
+    REQUIRE(element->find("ambient_light")->as_float() == .1f);
+    REQUIRE((*dimensions)[0].find("element")->find("height")->as_int() == 384);
+
+    REQUIRE(root->find("empty")->size() == 0);
+    REQUIRE(root->find("a_long")->as_long() == -5);
+    auto longs = root->find("longs");
+    REQUIRE(longs->size() == 3);
+    REQUIRE(longs->long_array_at(1) == -2);
+    REQUIRE(longs->long_array_at(2) == INT64_MAX);
+    REQUIRE(root->find("ints")->int_array_at(1) == 0x12345678);
+    auto shorts = root->find("shorts");
+    REQUIRE(shorts->size() == 3);
+    REQUIRE((*shorts)[1].as_short() == -2);
+}
+
+TEST_CASE("nbt document empty and malformed", "[nbt][document]") {
+    std::vector<std::byte> end { std::byte(nbt::TAG_END) };
+    proto::packet_reader s { end };
+    nbt::document empty { s };
+    REQUIRE_FALSE(empty.root().has_value());
+    REQUIRE(s.remaining() == 0);
+
+    std::vector<std::byte> bytes = registry();
+    for (size_t size : { size_t(1), size_t(3), bytes.size() / 2, bytes.size() - 1 }) {
+        std::vector<std::byte> truncated(bytes.begin(), bytes.begin() + size);
+        proto::packet_reader r { truncated };
+        REQUIRE_THROWS_AS(nbt::document { r }, nbt::parse_error);
+    }
+
+    size_t offset = 0;
+    proto::packet_reader callback { [&] { return bytes[offset++]; }, bytes.size() };
+    REQUIRE_THROWS_AS(nbt::document { callback }, nbt::parse_error);
+}
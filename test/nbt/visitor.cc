@@ -0,0 +1,177 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nbt_visitor.hh"
+
+using namespace mccpp;
+
+static std::vector<std::byte> to_vector(const proto::packet_writer &w) {
+    std::span<const std::byte> bytes = w;
+    return { bytes.begin(), bytes.end() };
+}
+
+static std::vector<std::byte> registry() {
+    proto::packet_writer w {};
+    nbt::writer n { w };
+    n.begin_compound();
+    n.begin_compound("minecraft:dimension_type");
+    n.write_string("type", "minecraft:dimension_type");
+    n.begin_list("value", nbt::TAG_COMPOUND, 2);
+    for (std::string_view name : { "minecraft:overworld", "minecraft:the_nether" }) {
+        n.begin_compound();
+        n.write_string("name", name);
+        n.write_int("id", name == "minecraft:overworld" ? 0 : 1);
+        n.begin_compound("element");
+        n.write_int("min_y", name == "minecraft:overworld" ? -64 : 0);
+        n.write_int("height", name == "minecraft:overworld" ? 384 : 256);
+        n.write_float("ambient_light", name == "minecraft:overworld" ? 0.f : .1f);
+        n.end_compound();
+        n.end_compound();
+    }
+    n.end_list();
+    n.end_compound();
+    n.begin_compound("minecraft:damage_type");
+    n.begin_list("value", nbt::TAG_COMPOUND, 1);
+    n.begin_compound();
+    n.write_string("name", "minecraft:fall");
+    n.end_compound();
+    n.end_list();
+    n.end_compound();
+    n.begin_list("parameters", nbt::TAG_STRING, 2);
+    n.write_string({}, "sender");
+    n.write_string({}, "content");
+    n.end_list();
+    n.write_long_array("longs", std::vector<int64_t> { 1, -2 });
+    n.end_compound();
+    return to_vector(w);
+}
+
+// Records every event as a line
+class recorder final : public nbt::visitor {
+public:
+    std::vector<std::string> events;
+    std::string prune;
+
+    bool begin_compound() override {
+        events.emplace_back("{");
+        return prune.empty() || m_last_key != prune;
+    }
+    void key(std::string_view name) override {
+        m_last_key = name;
+        events.emplace_back(name);
+    }
+    void end_compound() override { events.emplace_back("}"); }
+    bool begin_list(nbt::tag_type, int32_t length) override {
+        events.emplace_back("[" + std::to_string(length));
+        return prune.empty() || m_last_key != prune;
+    }
+    void end_list() override { events.emplace_back("]"); }
+    void value(nbt::tag_type, int64_t v) override { events.emplace_back(std::to_string(v)); }
+    void value(nbt::tag_type, double v) override { events.emplace_back(std::to_string(v)); }
+    void value(std::string_view v) override { events.emplace_back(v); }
+    void value(nbt::tag_type, std::span<const std::byte> v) override {
+        events.emplace_back("array " + std::to_string(v.size()));
+    }
+
+private:
+    std::string m_last_key;
+};
+
+TEST_CASE("nbt visitor events", "[nbt][visitor]") {
+    std::vector<std::byte> bytes = registry();
+    bytes.emplace_back(std::byte(0x42));
+
+    proto::packet_reader s { bytes };
+    recorder all {};
+    nbt::visit(s, all);
+    REQUIRE(s.remaining() == 1);
+    REQUIRE(all.events.size() == 57);
+    REQUIRE(all.events[0] == "{");
+    REQUIRE(all.events[1] == "minecraft:dimension_type");
+    REQUIRE(all.events[54] == "longs");
+    REQUIRE(all.events[55] == "array 16");
+    REQUIRE(all.events[56] == "}");
+
+    // pruned containers get no events, not even their end
+    proto::packet_reader pruned_reader { bytes };
+    recorder pruned {};
+    pruned.prune = "value";
+    nbt::visit(pruned_reader, pruned);
+    REQUIRE(pruned_reader.remaining() == 1);
+    REQUIRE(pruned.events == std::vector<std::string> {
+        "{", "minecraft:dimension_type", "{", "type", "minecraft:dimension_type", "value", "[2", "}",
+        "minecraft:damage_type", "{", "value", "[1", "}",
+        "parameters", "[2", "sender", "content", "]", "longs", "array 16", "}",
+    });
+
+    std::vector<std::byte> truncated(bytes.begin(), bytes.begin() + bytes.size() / 2);
+    proto::packet_reader r { truncated };
+    recorder ignored {};
+    REQUIRE_THROWS(nbt::visit(r, ignored));
+}
+
+TEST_CASE("nbt path query", "[nbt][visitor]") {
+    std::vector<std::byte> bytes = registry();
+    using match = nbt::path_query::match;
+
+    std::vector<std::string> names(2);
+    std::vector<int32_t> heights(2);
+    std::vector<std::string> parameters {};
+    std::vector<size_t> keys {};
+    float nether_light = 0;
+    size_t long_count = 0;
+    size_t fall_count = 0;
+
+    nbt::path_query query {};
+    query.on({ "minecraft:dimension_type", "value", "*", "name" }, [&](const match &m) {
+        names.at(m.indices[0]) = m.string;
+    });
+    query.on({ "minecraft:dimension_type", "value", "*", "element", "height" }, [&](const match &m) {
+        REQUIRE(m.type == nbt::TAG_INT);
+        heights.at(m.indices[0]) = static_cast<int32_t>(m.integer);
+    });
+    query.on({ "minecraft:dimension_type", "value", "*", "element", "ambient_light" }, [&](const match &m) {
+        if (m.indices[0] == 1)
+            nether_light = static_cast<float>(m.floating);
+    });
+    query.on({ "minecraft:dimension_type", "*" }, [&](const match &m) {
+        // only the leaf "type" matches, "value" is a list
+        REQUIRE(m.string == "minecraft:dimension_type");
+        keys.emplace_back(m.indices[0]);
+    });
+    query.on({ "parameters", "*" }, [&](const match &m) {
+        REQUIRE(m.indices[0] == parameters.size());
+        parameters.emplace_back(m.string);
+    });
+    query.on({ "longs" }, [&](const match &m) {
+        REQUIRE(m.type == nbt::TAG_LONG_ARRAY);
+        long_count = m.array.size() / 8;
+    });
+    query.on({ "minecraft:damage_type", "value", "0", "name" }, [&](const match &) {
+        fall_count++;
+    });
+
+    proto::packet_reader s { bytes };
+    query.run(s);
+    REQUIRE(s.remaining() == 0);
+    REQUIRE(names == std::vector<std::string> { "minecraft:overworld", "minecraft:the_nether" });
+    REQUIRE(heights == std::vector<int32_t> { 384, 256 });
+    REQUIRE(nether_light == .1f);
+    REQUIRE(keys == std::vector<size_t> { 0 });
+    REQUIRE(parameters == std::vector<std::string> { "sender", "content" });
+    REQUIRE(long_count == 2);
+    // list elements are only matched by "*"
+    REQUIRE(fall_count == 0);
+}
+
+TEST_CASE("nbt visitor needs memory", "[nbt][visitor]") {
+    std::vector<std::byte> bytes = registry();
+    size_t offset = 0;
+    proto::packet_reader callback { [&] { return bytes[offset++]; }, bytes.size() };
+    recorder ignored {};
+    REQUIRE_THROWS_AS(nbt::visit(callback, ignored), nbt::parse_error);
+}
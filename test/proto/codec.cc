@@ -0,0 +1,161 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "proto/clientbound/packets.hh"
+#include "proto/serverbound/packets.hh"
+
+using namespace mccpp;
+using namespace mccpp::proto;
+
+static std::vector<std::byte> from_hex(std::string_view hex) {
+    std::vector<std::byte> bytes {};
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        bytes.emplace_back(std::byte(std::stoi(std::string(hex.substr(i, 2)), nullptr, 16)));
+    }
+    return bytes;
+}
+
+template<typename Packet>
+static std::vector<std::byte> encode(const Packet &p) {
+    packet_writer w {};
+    write_fields(w, p);
+    std::span<const std::byte> bytes = w;
+    REQUIRE(bytes.size() == encoded_size(p));
+    return { bytes.begin(), bytes.end() };
+}
+
+template<typename Packet>
+static Packet decode(const std::vector<std::byte> &bytes) {
+    size_t offset = 0;
+    packet_reader r([&bytes, &offset] { return bytes.at(offset++); }, bytes.size());
+    Packet p {};
+    read_fields(r, p);
+    REQUIRE(r.remaining() == 0);
+    return p;
+}
+
+TEST_CASE("codec handshake", "[proto][codec]") {
+    using info = generated::serverbound::handshaking::client_intention_packet;
+    packet<info> p {
+        .protocol_version = 761,
+        .server_address = "localhost",
+        .server_port = 25565,
+        .next_state = packet<info>::LOGIN,
+    };
+    REQUIRE(encode(p) == from_hex("f905" "096c6f63616c686f7374" "63dd" "02"));
+
+    packet<info> q = decode<packet<info>>(encode(p));
+    REQUIRE(q.protocol_version == p.protocol_version);
+    REQUIRE(q.server_address == p.server_address);
+    REQUIRE(q.server_port == p.server_port);
+    REQUIRE(q.next_state == p.next_state);
+}
+
+TEST_CASE("codec fixed size runs", "[proto][codec]") {
+    using info = generated::serverbound::play::client_information_packet;
+    packet<info> p {
+        .locale = "en_US",
+        .view_distance = -3,
+        .chat_mode = 2,
+        .chat_colors = true,
+        .displayed_skin_parts = 0x7f,
+        .main_hand = 300,
+        .enable_text_filtering = false,
+        .allow_server_listings = true,
+    };
+    REQUIRE(encode(p) == from_hex("05656e5f5553" "fd" "02" "01" "7f" "ac02" "00" "01"));
+
+    packet<info> q = decode<packet<info>>(encode(p));
+    REQUIRE(q.locale == p.locale);
+    REQUIRE(q.view_distance == p.view_distance);
+    REQUIRE(q.chat_mode == p.chat_mode);
+    REQUIRE(q.chat_colors == p.chat_colors);
+    REQUIRE(q.displayed_skin_parts == p.displayed_skin_parts);
+    REQUIRE(q.main_hand == p.main_hand);
+    REQUIRE(q.enable_text_filtering == p.enable_text_filtering);
+    REQUIRE(q.allow_server_listings == p.allow_server_listings);
+
+    // the run of chat_colors and displayed_skin_parts is checked as a whole
+    std::vector<std::byte> bad = encode(p);
+    bad[8] = std::byte(0x02);
+    REQUIRE_THROWS_AS(decode<packet<info>>(bad), decode_error);
+    std::vector<std::byte> truncated = from_hex("05656e5f5553" "fd" "02" "01");
+    REQUIRE_THROWS_AS(decode<packet<info>>(truncated), decode_error);
+}
+
+TEST_CASE("codec optional and rest", "[proto][codec]") {
+    using hello = generated::serverbound::login::hello_packet;
+    packet<hello> anonymous { .name = "bot", .uuid = {} };
+    REQUIRE(encode(anonymous) == from_hex("03626f74" "00"));
+    packet<hello> with_uuid { .name = "bot", .uuid = uuid(0x0011223344556677, 0x8899aabbccddeeff) };
+    REQUIRE(encode(with_uuid) == from_hex("03626f74" "01" "00112233445566778899aabbccddeeff"));
+
+    using query = generated::serverbound::login::custom_query_packet;
+    packet<query> reply { .message_id = 5, .data = std::nullopt };
+    REQUIRE(encode(reply) == from_hex("05" "00"));
+    reply.data = from_hex("abcd");
+    REQUIRE(encode(reply) == from_hex("05" "01" "abcd"));
+
+    using payload = generated::serverbound::play::custom_payload_packet;
+    packet<payload> brand { .channel = "minecraft:brand", .data = from_hex("6d63") };
+    REQUIRE(encode(brand) == from_hex("0f6d696e6563726166743a6272616e64" "6d63"));
+
+    using status = generated::serverbound::status::status_request_packet;
+    REQUIRE(encode(packet<status> {}).empty());
+
+    using ping = generated::serverbound::status::ping_request_packet;
+    REQUIRE(encode(packet<ping> { .payload = -2 }) == from_hex("fffffffffffffffe"));
+}
+
+TEST_CASE("codec clientbound game profile", "[proto][codec]") {
+    using info = generated::clientbound::login::game_profile_packet;
+    std::vector<std::byte> bytes = from_hex(
+            "00112233445566778899aabbccddeeff" "03626f74"
+            "02"
+            "0874657874757265730176" "01" "0173"
+            "016e" "00" "00");
+
+    packet<info> p = decode<packet<info>>(bytes);
+    REQUIRE(p.uuid.high() == 0x0011223344556677);
+    REQUIRE(p.uuid.low() == 0x8899aabbccddeeff);
+    REQUIRE(p.username == "bot");
+    REQUIRE(p.properties.size() == 2);
+    REQUIRE(p.properties[0].name == "textures");
+    REQUIRE(p.properties[0].value == "v");
+    REQUIRE(p.properties[0].signature == "s");
+    REQUIRE(p.properties[1].name == "n");
+    REQUIRE(p.properties[1].value == "");
+    REQUIRE_FALSE(p.properties[1].signature.has_value());
+
+    REQUIRE(encode(p) == bytes);
+}
+
+TEST_CASE("codec rejects oversized lists", "[proto][codec]") {
+    using info = generated::clientbound::login::game_profile_packet;
+    std::vector<std::byte> bytes = from_hex("00112233445566778899aabbccddeeff" "03626f74" "ffffffff07");
+    REQUIRE_THROWS_AS(decode<packet<info>>(bytes), decode_error);
+}
+
+TEST_CASE("readers throw on truncated data", "[proto][codec]") {
+    std::vector<std::byte> bytes = from_hex("0102030405");
+    auto reader = [&] {
+        return packet_reader { std::span<const std::byte>(bytes) };
+    };
+    REQUIRE_THROWS_AS(reader().discard(6), decode_error);
+    REQUIRE_THROWS_AS(reader().read_byte_array(6), decode_error);
+    REQUIRE_THROWS_AS(reader().read_double(), decode_error);
+    packet_reader r = reader();
+    r.discard(4);
+    REQUIRE_THROWS_AS(r.read_float(), decode_error);
+    r.read_byte();
+    REQUIRE_THROWS_AS(r.read_byte(), decode_error);
+    REQUIRE(r.remaining() == 0);
+
+    // a bitset longer than any packet
+    std::vector<std::byte> bitset = from_hex("ffffffff07");
+    packet_reader b { std::span<const std::byte>(bitset) };
+    REQUIRE_THROWS_AS(b.discard_bitset(), decode_error);
+}
@@ -0,0 +1,107 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string_view>
+#include <vector>
+
+#include "proto/encryption.hh"
+
+using namespace mccpp::proto;
+
+static std::vector<std::byte> from_hex(std::string_view hex) {
+    std::vector<std::byte> bytes {};
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        bytes.emplace_back(std::byte(std::stoi(std::string(hex.substr(i, 2)), nullptr, 16)));
+    }
+    return bytes;
+}
+
+static aes_key key_from_hex(std::string_view hex) {
+    std::vector<std::byte> bytes = from_hex(hex);
+    aes_key key {};
+    std::copy(bytes.begin(), bytes.end(), key.begin());
+    return key;
+}
+
+static std::vector<std::byte> from_string(std::string_view str) {
+    return { reinterpret_cast<const std::byte *>(str.data()), reinterpret_cast<const std::byte *>(str.data() + str.size()) };
+}
+
+TEST_CASE("aes128 FIPS-197 example", "[proto][encryption]") {
+    aes128 aes(key_from_hex("000102030405060708090a0b0c0d0e0f"));
+    std::vector<std::byte> in = from_hex("00112233445566778899aabbccddeeff");
+    std::vector<std::byte> out(16);
+    aes.encrypt_block(reinterpret_cast<const uint8_t *>(in.data()), reinterpret_cast<uint8_t *>(out.data()));
+    REQUIRE(out == from_hex("69c4e0d86a7b0430d8cdb78070b4c55a"));
+}
+
+TEST_CASE("cfb8 NIST SP 800-38A F.3.7", "[proto][encryption]") {
+    aes_key key = key_from_hex("2b7e151628aed2a6abf7158809cf4f3c");
+    aes_key iv = key_from_hex("000102030405060708090a0b0c0d0e0f");
+    std::vector<std::byte> plaintext = from_hex("6bc1bee22e409f96e93d7e117393172aae2d");
+    std::vector<std::byte> ciphertext = from_hex("3b79424c9c0dd436bace9e0ed4586a4f32b9");
+
+    std::vector<std::byte> data = plaintext;
+    cfb8_encryptor encryptor(key, iv);
+    encryptor.encrypt(data);
+    REQUIRE(data == ciphertext);
+
+    for (bool accelerated : { true, false }) {
+        cfb8_decryptor decryptor(key, iv);
+        if (!accelerated)
+            decryptor.cipher().disable_acceleration();
+        data = ciphertext;
+        decryptor.decrypt(data);
+        REQUIRE(data == plaintext);
+    }
+}
+
+// openssl enc -aes-128-cfb8 -K 000102030405060708090a0b0c0d0e0f -iv 000102030405060708090a0b0c0d0e0f
+TEST_CASE("cfb8 split across reads", "[proto][encryption]") {
+    aes_key secret = key_from_hex("000102030405060708090a0b0c0d0e0f");
+    std::vector<std::byte> plaintext = from_string(
+            "the quick brown fox jumps over the lazy dog, the quick brown fox jumps over the lazy dog!!!");
+    std::vector<std::byte> ciphertext = from_hex(
+            "7ebeb56ff23cfdb89271913815e64bb3b1b423f7dec511e2e2a21fb75598c092d62d7d7419e1ef72a089c1e30bda14b4"
+            "7a82195f6f97a9de48f2cf469865142f1021f9b0abeb99c35dff2cabc6de98993c51f2771862413d37c6fa");
+
+    std::vector<std::byte> data = plaintext;
+    cfb8_encryptor encryptor(secret, secret);
+    encryptor.encrypt(std::span(data).first(7));
+    encryptor.encrypt(std::span(data).subspan(7));
+    REQUIRE(data == ciphertext);
+
+    for (bool accelerated : { true, false }) {
+        for (size_t split : { 0, 1, 15, 16, 17, 40, 88 }) {
+            cfb8_decryptor decryptor(secret, secret);
+            if (!accelerated)
+                decryptor.cipher().disable_acceleration();
+            data = ciphertext;
+            decryptor.decrypt(std::span(data).first(split));
+            decryptor.decrypt(std::span(data).subspan(split, 3));
+            decryptor.decrypt(std::span(data).subspan(split + 3));
+            REQUIRE(data == plaintext);
+        }
+    }
+}
+
+TEST_CASE("cfb8 round trip", "[proto][encryption]") {
+    aes_key secret = key_from_hex("f0e1d2c3b4a5968778695a4b3c2d1e0f");
+    std::vector<std::byte> plaintext(100000);
+    for (size_t i = 0; i < plaintext.size(); i++) {
+        plaintext[i] = std::byte(i * 31 + i / 7);
+    }
+
+    std::vector<std::byte> data = plaintext;
+    cfb8_encryptor encryptor(secret, secret);
+    encryptor.encrypt(data);
+    REQUIRE(data != plaintext);
+
+    cfb8_decryptor decryptor(secret, secret);
+    size_t offset = 0;
+    for (size_t size = 1; offset < data.size(); size = size * 3 + 1) {
+        size_t n = std::min(size, data.size() - offset);
+        decryptor.decrypt(std::span(data).subspan(offset, n));
+        offset += n;
+    }
+    REQUIRE(data == plaintext);
+}
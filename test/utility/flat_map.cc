@@ -0,0 +1,54 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <map>
+#include <random>
+
+#include "utility/flat_map.hh"
+
+TEST_CASE("flat_u64_map basics", "[utility][flat_map]") {
+    using namespace mccpp;
+    flat_u64_map<int> map {};
+    REQUIRE(map.empty());
+    REQUIRE(map.find(1) == nullptr);
+    REQUIRE(map.take(1) == 0);
+
+    REQUIRE(map.emplace(1, 10).second);
+    REQUIRE_FALSE(map.emplace(1, 11).second);
+    REQUIRE(*map.find(1) == 10);
+    REQUIRE(map.size() == 1);
+    REQUIRE(map.take(1) == 10);
+    REQUIRE(map.find(1) == nullptr);
+    REQUIRE(map.empty());
+}
+
+TEST_CASE("flat_u64_map against std::map", "[utility][flat_map]") {
+    using namespace mccpp;
+    flat_u64_map<uint64_t> map {};
+    std::map<uint64_t, uint64_t> expected {};
+    std::mt19937_64 random { 42 };
+
+    // few distinct keys so that erasure hits long clusters
+    for (int i = 0; i < 100000; i++) {
+        uint64_t key = random() % 512;
+        if (random() % 3 == 0) {
+            REQUIRE(map.erase(key) == (expected.erase(key) == 1));
+        } else {
+            bool inserted = expected.emplace(key, key * 3).second;
+            REQUIRE(map.emplace(key, key * 3).second == inserted);
+        }
+    }
+    REQUIRE(map.size() == expected.size());
+    REQUIRE(map.capacity() * 7 >= map.size() * 8);
+    for (uint64_t key = 0; key < 512; key++) {
+        uint64_t *value = map.find(key);
+        REQUIRE((value != nullptr) == expected.contains(key));
+        if (value)
+            REQUIRE(*value == key * 3);
+    }
+    size_t count = 0;
+    map.for_each([&](uint64_t key, uint64_t &value) {
+        REQUIRE(value == expected.at(key));
+        count++;
+    });
+    REQUIRE(count == expected.size());
+}
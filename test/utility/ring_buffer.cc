@@ -0,0 +1,116 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstring>
+#include <vector>
+
+#include "utility/ring_buffer.hh"
+
+using namespace mccpp;
+
+static void write(ring_buffer &buffer, const std::vector<std::byte> &data) {
+    REQUIRE(buffer.writable() >= data.size());
+    std::span<std::byte> front = buffer.write_front();
+    std::span<std::byte> back = buffer.write_back();
+    size_t first = std::min(front.size(), data.size());
+    std::memcpy(front.data(), data.data(), first);
+    std::memcpy(back.data(), data.data() + first, data.size() - first);
+    buffer.mark_write(data.size());
+}
+
+static std::vector<std::byte> contents(const ring_buffer &buffer) {
+    std::vector<std::byte> data;
+    for (std::span<const std::byte> part : { buffer.read_front(), buffer.read_back() }) {
+        data.insert(data.end(), part.begin(), part.end());
+    }
+    REQUIRE(data.size() == buffer.readable());
+    return data;
+}
+
+static std::vector<std::byte> pattern(size_t size, unsigned seed) {
+    std::vector<std::byte> data(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = std::byte(static_cast<unsigned char>(i * 7 + seed));
+    }
+    return data;
+}
+
+TEST_CASE("ring_buffer wraps around", "[utility][ring_buffer]") {
+    ring_buffer buffer;
+    REQUIRE(buffer.capacity() == 0);
+    buffer.reserve(1);
+    size_t capacity = buffer.capacity();
+    REQUIRE(capacity == slab_pool::MIN_SLAB_SIZE);
+
+    write(buffer, pattern(capacity - 100, 0));
+    buffer.erase(capacity - 200);
+    REQUIRE(buffer.readable() == 100);
+
+    // the next write starts at the end and continues at the start
+    std::vector<std::byte> tail = pattern(300, 1);
+    write(buffer, tail);
+    REQUIRE(buffer.read_front().size() == 200);
+    REQUIRE(buffer.read_back().size() == 200);
+    REQUIRE(buffer.front() == pattern(capacity - 100, 0)[capacity - 200]);
+
+    buffer.erase(100);
+    REQUIRE(contents(buffer) == tail);
+    REQUIRE(buffer.capacity() == capacity);
+
+    // filled up completely
+    std::vector<std::byte> rest = pattern(buffer.writable(), 2);
+    write(buffer, rest);
+    REQUIRE(buffer.writable() == 0);
+    REQUIRE(buffer.write_front().empty());
+    REQUIRE(buffer.write_back().empty());
+    buffer.erase(tail.size());
+    REQUIRE(contents(buffer) == rest);
+}
+
+TEST_CASE("ring_buffer keeps its contents when resized", "[utility][ring_buffer]") {
+    ring_buffer buffer;
+    buffer.reserve(1);
+    size_t capacity = buffer.capacity();
+
+    // contents split over the end of the buffer
+    write(buffer, pattern(capacity - 10, 0));
+    buffer.erase(capacity - 1000);
+    write(buffer, pattern(2000, 1));
+    std::vector<std::byte> expected = contents(buffer);
+    REQUIRE(buffer.read_back().size() > 0);
+
+    buffer.reserve(capacity + 1);
+    REQUIRE(buffer.capacity() == capacity * 2);
+    REQUIRE(contents(buffer) == expected);
+    // after the move everything is in the front part
+    REQUIRE(buffer.read_back().empty());
+
+    // large enough to shrink, but never below what it holds
+    buffer.reserve(capacity * 8);
+    REQUIRE(buffer.capacity() == capacity * 8);
+    buffer.shrink(0);
+    REQUIRE(buffer.capacity() == capacity);
+    REQUIRE(contents(buffer) == expected);
+
+    // not shrunk unless it's four times larger than needed
+    buffer.reserve(capacity * 2);
+    buffer.shrink(capacity);
+    REQUIRE(buffer.capacity() == capacity * 2);
+
+    // reserving what already fits does nothing
+    buffer.reserve(expected.size());
+    REQUIRE(buffer.capacity() == capacity * 2);
+    REQUIRE(contents(buffer) == expected);
+}
+
+TEST_CASE("ring_buffer grows past the largest slab", "[utility][ring_buffer]") {
+    ring_buffer buffer;
+    buffer.reserve(slab_pool::MAX_SLAB_SIZE);
+    std::vector<std::byte> data = pattern(slab_pool::MAX_SLAB_SIZE, 3);
+    write(buffer, data);
+    buffer.reserve(slab_pool::MAX_SLAB_SIZE * 2);
+    REQUIRE(buffer.capacity() == slab_pool::MAX_SLAB_SIZE * 2);
+    REQUIRE(contents(buffer) == data);
+    buffer.erase(data.size());
+    buffer.shrink(0);
+    REQUIRE(buffer.capacity() == slab_pool::MIN_SLAB_SIZE);
+}
@@ -0,0 +1,55 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "utility/slab_pool.hh"
+
+TEST_CASE("slab_pool size classes", "[utility][slab_pool]") {
+    using namespace mccpp;
+    REQUIRE(slab_pool::slab_size(1) == slab_pool::MIN_SLAB_SIZE);
+    REQUIRE(slab_pool::slab_size(slab_pool::MIN_SLAB_SIZE) == slab_pool::MIN_SLAB_SIZE);
+    REQUIRE(slab_pool::slab_size(slab_pool::MIN_SLAB_SIZE + 1) == slab_pool::MIN_SLAB_SIZE * 2);
+    REQUIRE(slab_pool::slab_size(slab_pool::MAX_SLAB_SIZE) == slab_pool::MAX_SLAB_SIZE);
+    // past the largest class sizes stay powers of two
+    REQUIRE(slab_pool::slab_size(slab_pool::MAX_SLAB_SIZE + 1) == slab_pool::MAX_SLAB_SIZE * 2);
+}
+
+TEST_CASE("slab_pool reuses slabs of the same class", "[utility][slab_pool]") {
+    using namespace mccpp;
+    slab_pool pool;
+
+    std::span<std::byte> small = pool.allocate(100);
+    REQUIRE(small.size() == slab_pool::MIN_SLAB_SIZE);
+    std::span<std::byte> large = pool.allocate(slab_pool::MIN_SLAB_SIZE * 3);
+    REQUIRE(large.size() == slab_pool::MIN_SLAB_SIZE * 4);
+    std::byte *small_data = small.data();
+    std::byte *large_data = large.data();
+    pool.deallocate(small);
+    pool.deallocate(large);
+
+    // each size gets the slab of its own class back
+    std::span<std::byte> again_large = pool.allocate(slab_pool::MIN_SLAB_SIZE * 4);
+    REQUIRE(again_large.data() == large_data);
+    std::span<std::byte> again_small = pool.allocate(slab_pool::MIN_SLAB_SIZE);
+    REQUIRE(again_small.data() == small_data);
+    // and a new one once the cache of the class is empty
+    std::span<std::byte> other = pool.allocate(1);
+    REQUIRE(other.data() != small_data);
+    REQUIRE(other.size() == slab_pool::MIN_SLAB_SIZE);
+
+    pool.deallocate(again_large);
+    pool.deallocate(again_small);
+    pool.deallocate(other);
+}
+
+TEST_CASE("slab_pool allocates past the largest class", "[utility][slab_pool]") {
+    using namespace mccpp;
+    slab_pool pool;
+
+    std::span<std::byte> huge = pool.allocate(slab_pool::MAX_SLAB_SIZE * 3);
+    REQUIRE(huge.size() == slab_pool::MAX_SLAB_SIZE * 4);
+    huge[huge.size() - 1] = std::byte { 1 };
+    pool.deallocate(huge);
+
+    std::span<std::byte> largest = pool.allocate(slab_pool::MAX_SLAB_SIZE);
+    REQUIRE(largest.size() == slab_pool::MAX_SLAB_SIZE);
+    pool.deallocate(largest);
+}
@@ -0,0 +1,51 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <thread>
+
+#include "utility/spsc_queue.hh"
+
+TEST_CASE("spsc_queue bounds", "[utility][spsc_queue]") {
+    using namespace mccpp;
+    spsc_queue<int> queue(3);
+
+    REQUIRE(queue.empty());
+    REQUIRE(queue.try_push(1));
+    REQUIRE(queue.try_push(2));
+    REQUIRE(queue.try_push(3));
+    REQUIRE(queue.full());
+    REQUIRE_FALSE(queue.try_push(4));
+
+    REQUIRE(queue.try_pop() == 1);
+    REQUIRE(queue.try_push(4));
+    REQUIRE(queue.try_pop() == 2);
+    REQUIRE(queue.try_pop() == 3);
+    REQUIRE(queue.try_pop() == 4);
+    REQUIRE_FALSE(queue.try_pop().has_value());
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("spsc_queue threaded", "[utility][spsc_queue]") {
+    using namespace mccpp;
+    constexpr int count = 100000;
+    spsc_queue<int> queue(16);
+
+    std::thread producer([&queue] {
+        for (int i = 0; i < count;) {
+            if (queue.try_push(int(i)))
+                i++;
+        }
+    });
+
+    int expected = 0;
+    bool in_order = true;
+    while (expected < count) {
+        if (std::optional<int> value = queue.try_pop()) {
+            in_order = in_order && *value == expected;
+            expected++;
+        }
+    }
+    producer.join();
+
+    REQUIRE(in_order);
+    REQUIRE(queue.empty());
+}
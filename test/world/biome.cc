@@ -0,0 +1,184 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdlib>
+#include <span>
+#include <vector>
+
+#include "world/world.hh"
+
+using namespace mccpp;
+
+// A section of air with the biomes written by write_biomes
+template<typename F>
+static world::chunk load_section(F &&write_biomes) {
+    proto::packet_writer w {};
+    w.write_i16(0);
+    w.write_u8(0);
+    w.write_varint(0);
+    w.write_varint(0);
+    write_biomes(w);
+    std::span<const std::byte> bytes = w;
+    proto::packet_reader s { bytes };
+    world::chunk c {};
+    c.load(s);
+    REQUIRE(s.remaining() == 0);
+    return c;
+}
+
+TEST_CASE("biomes load from chunk sections", "[world][biome]") {
+    world::chunk single = load_section([](proto::packet_writer &w) {
+        w.write_u8(0);
+        w.write_varint(7);
+        w.write_varint(0);
+    });
+    REQUIRE(single.biome_at(0, 0, 0) == 7);
+    REQUIRE(single.biome_at(15, 15, 15) == 7);
+
+    // 2 bits, 32 entries per long, the upper half of the section is the
+    // second palette entry
+    world::chunk palette = load_section([](proto::packet_writer &w) {
+        w.write_u8(2);
+        w.write_varint(2);
+        w.write_varint(3);
+        w.write_varint(40);
+        w.write_varint(2);
+        w.write_u64(0);
+        w.write_u64(0x5555555555555555);
+    });
+    REQUIRE(palette.biome_at(3, 7, 3) == 3);
+    REQUIRE(palette.biome_at(12, 8, 0) == 40);
+
+    // registry ids straight away, 6 bits and 10 entries per long
+    world::chunk direct = load_section([](proto::packet_writer &w) {
+        w.write_u8(6);
+        w.write_varint(7);
+        for (uint64_t l = 0; l < 7; l++) {
+            uint64_t v = 0;
+            for (uint64_t i = 0; i < 10; i++) {
+                v |= ((l * 10 + i) % 64) << (i * 6);
+            }
+            w.write_u64(v);
+        }
+    });
+    for (int i = 0; i < 64; i++) {
+        REQUIRE(direct.biomes[i] == i);
+    }
+    // x, then z, then y
+    REQUIRE(direct.biome_at(4, 0, 0) == 1);
+    REQUIRE(direct.biome_at(0, 0, 4) == 4);
+    REQUIRE(direct.biome_at(0, 4, 0) == 16);
+
+    REQUIRE_THROWS_AS(load_section([](proto::packet_writer &w) {
+        w.write_u8(1);
+        w.write_varint(1);
+        w.write_varint(0);
+        w.write_varint(1);
+        w.write_u64(1);
+    }), proto::decode_error);
+}
+
+static bool near(uint32_t a, uint32_t b, int tolerance) {
+    for (int shift : { 0, 8, 16 }) {
+        if (std::abs(int(a >> shift & 0xff) - int(b >> shift & 0xff)) > tolerance)
+            return false;
+    }
+    return true;
+}
+
+TEST_CASE("biome colours", "[world][biome]") {
+    // plains, close to what the vanilla colormaps give
+    world::biome plains {};
+    REQUIRE(near(world::grass_color(plains), 0x91bd59, 10));
+    REQUIRE(near(world::foliage_color(plains), 0x77ab2f, 10));
+
+    world::biome swamp {};
+    swamp.grass_color = 0x6a7039;
+    REQUIRE(world::grass_color(swamp) == 0x6a7039);
+
+    // hot and dry is the desert corner
+    world::biome desert {};
+    desert.temperature = 2.f;
+    desert.downfall = 0.f;
+    REQUIRE(world::grass_color(desert) == 0xbfb755);
+}
+
+static void load_column(world::world &w, int32_t x, int32_t z, world::biome_id biome) {
+    for (world::chunk &c : w.chunks().get(x, z)) {
+        c.biomes.fill(biome);
+    }
+    w.on_column_loaded(x, z);
+}
+
+TEST_CASE("biome tints blend across columns", "[world][biome]") {
+    std::vector<world::biome> biomes(3);
+    biomes[0].name = "red";
+    biomes[0].grass_color = 0xff0000;
+    biomes[0].water_color = 0x0000ff;
+    biomes[1].name = "green";
+    biomes[1].grass_color = 0x00ff00;
+    biomes[1].water_color = 0x0000ff;
+    // left out by the server
+    world::world w { 0, 32, biomes };
+    load_column(w, 0, 0, 0);
+    load_column(w, 1, 0, 1);
+    REQUIRE(w.tints(5, 5) == nullptr);
+
+    w.set_biome_blend_radius(0);
+    const world::column_tints *tints = w.tints(0, 0);
+    REQUIRE(tints);
+    REQUIRE(tints->at(world::tint::GRASS, 15, 8) == 0xff0000);
+    REQUIRE(tints->at(world::tint::WATER, 15, 8) == 0x0000ff);
+    REQUIRE(w.tints(0, 0) == tints);
+
+    // three blocks of red and two of green, the missing column at -x is left out
+    w.set_biome_blend_radius(2);
+    tints = w.tints(0, 0);
+    REQUIRE(tints->at(world::tint::GRASS, 15, 8) == 0x996600);
+    REQUIRE(tints->at(world::tint::GRASS, 0, 8) == 0xff0000);
+    REQUIRE(tints->at(world::tint::GRASS, 8, 8) == 0xff0000);
+    REQUIRE(w.tints(1, 0)->at(world::tint::GRASS, 0, 8) == 0x669900);
+
+    // loading a neighbour invalidates, loading anything else doesn't
+    load_column(w, 5, 5, 0);
+    REQUIRE(w.tints(0, 0) == tints);
+    load_column(w, -1, 0, 2);
+    tints = w.tints(0, 0);
+    uint32_t unknown = world::grass_color(world::biome {});
+    uint32_t expected = 0;
+    for (int shift : { 16, 8, 0 }) {
+        uint32_t sum = 3 * (0xff0000 >> shift & 0xff) + 2 * (unknown >> shift & 0xff);
+        expected = expected << 8 | (sum + 2) / 5;
+    }
+    REQUIRE(tints->at(world::tint::GRASS, 0, 8) == expected);
+    REQUIRE(tints->at(world::tint::WATER, 15, 8) == 0x0000ff);
+
+    w.unload_column(0, 0);
+    REQUIRE(w.tints(0, 0) == nullptr);
+}
+
+TEST_CASE("biome tints follow the surface", "[world][biome]") {
+    std::vector<world::biome> biomes(2);
+    biomes[0].name = "red";
+    biomes[0].grass_color = 0xff0000;
+    biomes[1].name = "green";
+    biomes[1].grass_color = 0x00ff00;
+    world::world w { 0, 32, biomes };
+    w.set_biome_blend_radius(0);
+    world::chunk_column &column = w.chunks().get(0, 0);
+    column[1].biomes.fill(1);
+    w.on_column_loaded(0, 0);
+    load_column(w, 1, 0, 0);
+
+    // the bottom of an empty column is red, the sky above it green
+    REQUIRE(w.tints(0, 0)->at(world::tint::GRASS, 3, 3) == 0xff0000);
+    REQUIRE(w.set_block(3, 20, 3, 1));
+    REQUIRE(w.tints(0, 0)->at(world::tint::GRASS, 3, 3) == 0x00ff00);
+    REQUIRE(w.set_blocks({ 0, 1, 0 }, std::vector<int64_t> { 3 << 8 | 3 << 4 | 4 }) == 1);
+    REQUIRE(w.tints(0, 0)->at(world::tint::GRASS, 3, 3) == 0xff0000);
+
+    // the neighbours blend with it
+    w.set_biome_blend_radius(1);
+    uint32_t before = w.tints(1, 0)->at(world::tint::GRASS, 0, 0);
+    REQUIRE(w.set_block(15, 20, 0, 1));
+    REQUIRE(w.tints(1, 0)->at(world::tint::GRASS, 0, 0) != before);
+}
@@ -0,0 +1,147 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "nbt.hh"
+#include "world/block_entities.hh"
+
+using namespace mccpp;
+
+static constexpr int32_t CHEST = 1;
+static constexpr int32_t SIGN = 7;
+
+static void write_sign(proto::packet_writer &w, std::string_view text) {
+    nbt::writer n { w };
+    n.begin_compound();
+    n.write_string("Text1", text);
+    n.write_byte("GlowingText", 0);
+    n.end_compound();
+}
+
+static void write_entity(proto::packet_writer &w, int x, int y, int z, int32_t type, std::string_view text) {
+    w.write_u8(static_cast<uint8_t>(x << 4 | z));
+    w.write_i16(static_cast<int16_t>(y));
+    w.write_varint(type);
+    write_sign(w, text);
+}
+
+static std::string text_of(world::column_block_entities &entities, int x, int y, int z) {
+    const nbt::document *document = entities.nbt(x, y, z);
+    REQUIRE(document);
+    auto text = document->root()->find("Text1");
+    REQUIRE(text.has_value());
+    return std::string { text->as_string() };
+}
+
+TEST_CASE("block entities load from the chunk packet", "[world][block_entities]") {
+    proto::packet_writer w {};
+    w.write_varint(4);
+    write_entity(w, 3, 70, 4, SIGN, "top");
+    write_entity(w, 15, -64, 0, SIGN, "bottom");
+    write_entity(w, 3, 70, 4, SIGN, "again");
+    // empty chests are a lone compound
+    w.write_u8(0x12);
+    w.write_i16(-1);
+    w.write_varint(CHEST);
+    nbt::writer chest { w };
+    chest.begin_compound();
+    chest.end_compound();
+    w.write_bool(true);
+    std::span<const std::byte> bytes = w;
+
+    world::column_block_entities entities {};
+    proto::packet_reader s { bytes };
+    entities.load(s);
+    REQUIRE(s.remaining() == 1);
+
+    // the later one of a position wins
+    REQUIRE(entities.size() == 3);
+    REQUIRE(entities.type(3, 70, 4) == SIGN);
+    REQUIRE(entities.type(1, -1, 2) == CHEST);
+    REQUIRE_FALSE(entities.type(4, 70, 3).has_value());
+    REQUIRE(entities.raw_nbt(1, -1, 2).size() == 4);
+    REQUIRE(entities.nbt(0, 0, 0) == nullptr);
+
+    // bottom to top, negative y first
+    std::vector<int> ys {};
+    entities.for_each([&](int x, int y, int z, int32_t) {
+        ys.push_back(y);
+        REQUIRE(entities.type(x, y, z).has_value());
+    });
+    REQUIRE(ys == std::vector<int> { -64, -1, 70 });
+
+    // parsed once, then the same document
+    REQUIRE(text_of(entities, 3, 70, 4) == "again");
+    REQUIRE(entities.nbt(3, 70, 4) == entities.nbt(3, 70, 4));
+    REQUIRE(text_of(entities, 15, -64, 0) == "bottom");
+
+    // the bytes as sent are all that's kept of the entities not looked at
+    world::column_block_entities fresh {};
+    proto::packet_reader again { bytes };
+    fresh.load(again);
+    size_t wire = bytes.size() - again.remaining();
+    REQUIRE(fresh.allocated_bytes() <= wire + 16 * 4);
+
+    // readers that don't read from memory keep the same bytes
+    size_t next = 0;
+    proto::packet_reader stream { [&] { return bytes[next++]; }, bytes.size() };
+    world::column_block_entities streamed {};
+    streamed.load(stream);
+    REQUIRE(stream.remaining() == 1);
+    REQUIRE(std::ranges::equal(streamed.raw_nbt(3, 70, 4), entities.raw_nbt(3, 70, 4)));
+    REQUIRE(text_of(streamed, 15, -64, 0) == "bottom");
+}
+
+TEST_CASE("block entities update and remove", "[world][block_entities]") {
+    world::column_block_entities entities {};
+    auto set = [&](int x, int y, int z, int32_t type, std::string_view text) {
+        proto::packet_writer w {};
+        write_sign(w, text);
+        std::span<const std::byte> bytes = w;
+        proto::packet_reader s { bytes };
+        entities.set(x, y, z, type, s);
+        REQUIRE(s.remaining() == 0);
+    };
+
+    set(0, 10, 0, SIGN, "a");
+    set(5, 5, 5, SIGN, "b");
+    set(0, 10, 0, SIGN, "c");
+    REQUIRE(entities.size() == 2);
+    REQUIRE(text_of(entities, 0, 10, 0) == "c");
+    REQUIRE(text_of(entities, 5, 5, 5) == "b");
+
+    // empty NBT keeps the data
+    proto::packet_writer empty {};
+    empty.write_u8(nbt::TAG_END);
+    std::span<const std::byte> empty_bytes = empty;
+    proto::packet_reader s { empty_bytes };
+    entities.set(5, 5, 5, CHEST, s);
+    REQUIRE(entities.type(5, 5, 5) == CHEST);
+    REQUIRE(text_of(entities, 5, 5, 5) == "b");
+    // and adds nothing where there is no block entity
+    proto::packet_reader nothing { empty_bytes };
+    entities.set(7, 7, 7, CHEST, nothing);
+    REQUIRE(nothing.remaining() == 0);
+    REQUIRE(entities.size() == 2);
+    REQUIRE_FALSE(entities.type(7, 7, 7).has_value());
+    REQUIRE(entities.nbt(7, 7, 7) == nullptr);
+
+    // lots of edits don't grow the buffer without bounds
+    for (int i = 0; i < 100; i++) {
+        set(0, 10, 0, SIGN, std::to_string(i));
+    }
+    REQUIRE(text_of(entities, 0, 10, 0) == "99");
+    REQUIRE(entities.allocated_bytes() < 2048);
+
+    REQUIRE(entities.remove(0, 10, 0));
+    REQUIRE_FALSE(entities.remove(0, 10, 0));
+    REQUIRE(entities.nbt(0, 10, 0) == nullptr);
+    REQUIRE(text_of(entities, 5, 5, 5) == "b");
+
+    entities.clear();
+    REQUIRE(entities.empty());
+    REQUIRE(entities.allocated_bytes() == 0);
+}
@@ -0,0 +1,169 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+
+#include "world/collision.hh"
+#include "world/world.hh"
+
+using namespace mccpp;
+
+static constexpr world::block_state STONE = 1;
+static constexpr world::block_state SLAB = 2;
+static constexpr world::block_state FENCE = 3;
+static constexpr world::block_state GRASS = 4;
+
+// 0 and 1 are reserved for empty and full, then a bottom slab and a fence post
+static const world::collision_shapes &shapes() {
+    static const world::collision_shapes shapes {
+        { world::collision_shapes::EMPTY, world::collision_shapes::FULL, 2, 3, world::collision_shapes::EMPTY },
+        { 0, 0, 1, 2, 3 },
+        {
+            { glm::dvec3 { 0. }, glm::dvec3 { 1. } },
+            { { 0., 0., 0. }, { 1., 0.5, 1. } },
+            { { 0.375, 0., 0.375 }, { 0.625, 1.5, 0.625 } },
+        },
+    };
+    return shapes;
+}
+
+// A stone floor at y = 3 in the columns around the origin
+static world::world flat_world() {
+    world::world w { 0, 64, {} };
+    for (int32_t x = -2; x < 2; x++) {
+        for (int32_t z = -2; z < 2; z++) {
+            w.chunks().get(x, z);
+        }
+    }
+    for (int32_t x = -32; x < 32; x++) {
+        for (int32_t z = -32; z < 32; z++) {
+            w.set_block(x, 3, z, STONE);
+        }
+    }
+    return w;
+}
+
+static world::aabb player_at(glm::dvec3 feet) {
+    return { feet - glm::dvec3 { 0.3, 0., 0.3 }, feet + glm::dvec3 { 0.3, 1.8, 0.3 } };
+}
+
+static bool near(double a, double b) {
+    return std::abs(a - b) < 1e-9;
+}
+
+TEST_CASE("collision shapes decide the motion blocking heightmap", "[world]") {
+    world::world w = flat_world();
+    w.set_collision_shapes(shapes());
+    world::column_heightmaps &maps = w.chunks().get(0, 0).heightmaps();
+    REQUIRE(maps.motion_blocking.at(1, 1) == 4);
+
+    // grass has no collision
+    REQUIRE(w.set_block(1, 4, 1, GRASS));
+    REQUIRE(maps.world_surface.at(1, 1) == 5);
+    REQUIRE(maps.motion_blocking.at(1, 1) == 4);
+    REQUIRE(w.set_block(1, 5, 1, SLAB));
+    REQUIRE(maps.motion_blocking.at(1, 1) == 6);
+    // going down past the grass to the floor
+    REQUIRE(w.set_block(1, 5, 1, world::AIR));
+    REQUIRE(maps.world_surface.at(1, 1) == 5);
+    REQUIRE(maps.motion_blocking.at(1, 1) == 4);
+}
+
+TEST_CASE("collision falling and walls", "[world]") {
+    world::world w = flat_world();
+    world::collider collider { w, shapes() };
+
+    // lands on the floor, across the section border
+    world::move_result r = collider.move(player_at({ 0.5, 20., 0.5 }), { 0., -30., 0. }, 0.6, false);
+    REQUIRE(near(r.motion.y, -16.));
+    REQUIRE(r.on_ground);
+    REQUIRE(r.collided_vertically);
+    REQUIRE_FALSE(r.collided_horizontally);
+
+    // standing on it doesn't sink in
+    r = collider.move(player_at({ 0.5, 4., 0.5 }), { 0., -0.08, 0. }, 0.6, true);
+    REQUIRE(r.motion.y == 0.);
+    REQUIRE(r.on_ground);
+
+    // stops flush at a wall two blocks high and slides along it
+    w.set_block(2, 4, 0, STONE);
+    w.set_block(2, 5, 0, STONE);
+    r = collider.move(player_at({ 0.5, 4., 0.5 }), { 2., 0., 0.25 }, 0.6, true);
+    REQUIRE(near(r.motion.x, 1.2));
+    REQUIRE(near(r.motion.z, 0.25));
+    REQUIRE(r.collided_horizontally);
+
+    // a gap in the wall lets the box through
+    r = collider.move(player_at({ 0.5, 4., 1.5 }), { 2., 0., 0. }, 0.6, true);
+    REQUIRE(near(r.motion.x, 2.));
+
+    // nothing to collide with outside of the loaded columns
+    r = collider.move(player_at({ 100.5, 4., 0.5 }), { 0., -10., 0. }, 0.6, false);
+    REQUIRE(near(r.motion.y, -10.));
+}
+
+TEST_CASE("collision shapes and step up", "[world]") {
+    world::world w = flat_world();
+    world::collider collider { w, shapes() };
+
+    // half a block is low enough to step onto, a full one isn't
+    w.set_block(1, 4, 0, SLAB);
+    world::move_result r = collider.move(player_at({ 0.5, 4., 0.5 }), { 0.5, -0.08, 0. }, 0.6, true);
+    REQUIRE(near(r.motion.x, 0.5));
+    REQUIRE(near(r.motion.y, 0.5));
+    REQUIRE(r.on_ground);
+    r = collider.move(player_at({ 0.5, 4., 0.5 }), { 0.5, -0.08, 0. }, 0., true);
+    REQUIRE(near(r.motion.x, 0.2));
+
+    w.set_block(1, 4, 0, STONE);
+    r = collider.move(player_at({ 0.5, 4., 0.5 }), { 0.5, -0.08, 0. }, 0.6, true);
+    REQUIRE(near(r.motion.x, 0.2));
+    REQUIRE(r.motion.y == 0.);
+
+    // no stepping up in mid air
+    w.set_block(1, 4, 0, SLAB);
+    r = collider.move(player_at({ 0.5, 6., 0.5 }), { 0.5, 0., 0. }, 0.6, false);
+    REQUIRE(near(r.motion.x, 0.5));
+
+    // a fence reaches into the block above it, the post is thin
+    w.set_block(-2, 4, 0, FENCE);
+    world::collider fresh { w, shapes() };
+    r = fresh.move(player_at({ -1.5, 5.55, 0.5 }), { 0., -0.08, 0. }, 0.6, false);
+    REQUIRE(near(r.motion.y, -0.05));
+    r = collider.move(player_at({ -1.5, 5.6, 1.5 }), { 0., -1., 0. }, 0.6, false);
+    REQUIRE(near(r.motion.y, -1.));
+
+    // states without a shape don't collide
+    w.set_block(0, 4, 3, GRASS);
+    r = collider.move(player_at({ 0.5, 4., 2.5 }), { 0., 0., 1. }, 0., true);
+    REQUIRE(near(r.motion.z, 1.));
+}
+
+TEST_CASE("collision box cache", "[world]") {
+    world::world w = flat_world();
+    world::collider collider { w, shapes() };
+
+    world::aabb box = player_at({ 0.5, 4., 0.5 });
+    std::span<const world::aabb> boxes = collider.gather(box);
+    // the floor below the box and the margin around it
+    REQUIRE(boxes.size() == 3 * 3);
+    const world::aabb *data = boxes.data();
+
+    // small moves stay within the cached blocks
+    REQUIRE(collider.gather(box.moved({ 0.2, 0., 0. })).data() == data);
+    REQUIRE(collider.gather(box.moved({ 0.2, 0., 0. })).size() == 9);
+
+    // edits make it gather again
+    w.set_block(1, 4, 0, STONE);
+    REQUIRE(collider.gather(box).size() == 10);
+
+    collider.invalidate();
+    REQUIRE(collider.gather(box.moved({ 5., 0., 0. })).size() == 9);
+}
+
+TEST_CASE("collision default shapes", "[world]") {
+    world::collision_shapes defaults {};
+    REQUIRE(defaults.shape(world::AIR) == world::collision_shapes::EMPTY);
+    REQUIRE(defaults.shape(1234) == world::collision_shapes::FULL);
+    REQUIRE(defaults.boxes(world::collision_shapes::FULL).size() == 1);
+    REQUIRE(defaults.boxes(world::collision_shapes::EMPTY).empty());
+}
@@ -0,0 +1,190 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "world/entities.hh"
+#include "world/entity_grid.hh"
+
+using namespace mccpp;
+
+static world::entity_spawn spawn(int32_t id, glm::dvec3 position) {
+    world::entity_spawn s {};
+    s.id = id;
+    s.uuid = { 0, static_cast<uint64_t>(id) };
+    s.type = 7;
+    s.position = position;
+    return s;
+}
+
+TEST_CASE("entity store slots", "[world]") {
+    world::entity_store entities {};
+    for (int32_t id = 0; id < 100; id++) {
+        REQUIRE(entities.add(spawn(id * 3, { double(id), 64., -double(id) })) == static_cast<uint32_t>(id));
+    }
+    REQUIRE(entities.size() == 100);
+    REQUIRE(entities.slot(1) == world::entity_store::NO_SLOT);
+    REQUIRE(entities.position(entities.slot(30)) == glm::dvec3 { 10., 64., -10. });
+
+    // the last entity moves into the hole
+    REQUIRE(entities.remove(30));
+    REQUIRE_FALSE(entities.remove(30));
+    REQUIRE(entities.size() == 99);
+    REQUIRE(entities.slot(30) == world::entity_store::NO_SLOT);
+    REQUIRE(entities.slot(297) == 10);
+    REQUIRE(entities.id(10) == 297);
+    REQUIRE(entities.uuid(10).low() == 297);
+    REQUIRE(entities.position(10) == glm::dvec3 { 99., 64., -99. });
+
+    // adding a known id replaces it in place
+    REQUIRE(entities.add(spawn(297, { 1., 2., 3. })) == 10);
+    REQUIRE(entities.size() == 99);
+    REQUIRE(entities.position(10) == glm::dvec3 { 1., 2., 3. });
+
+    for (int32_t id = 0; id < 100; id++) {
+        entities.remove(id * 3);
+    }
+    REQUIRE(entities.size() == 0);
+    entities.add(spawn(5, {}));
+    REQUIRE(entities.slot(5) == 0);
+    entities.clear();
+    REQUIRE(entities.slot(5) == world::entity_store::NO_SLOT);
+}
+
+TEST_CASE("entity store movement", "[world]") {
+    world::entity_store entities {};
+    entities.add(spawn(1, { 0.5, 64., 0.5 }));
+    entities.add(spawn(2, { 10., 70., 10. }));
+
+    // deltas of 1/4096 add up without drifting
+    for (int i = 0; i < 4096; i++) {
+        entities.move(1, { 1. / 4096., 0., -1. / 4096. }, true);
+    }
+    REQUIRE(entities.position(0) == glm::dvec3 { 1.5, 64., -0.5 });
+    REQUIRE(entities.on_ground(0));
+    REQUIRE_FALSE(entities.move(3, { 1., 0., 0. }, true));
+
+    REQUIRE(entities.rotate(2, 90.f, -45.f, false));
+    REQUIRE(entities.rotate_head(2, 180.f));
+    REQUIRE(entities.set_velocity(2, { 0.f, 0.5f, 0.f }));
+    REQUIRE(entities.yaw(1) == 90.f);
+    REQUIRE(entities.pitch(1) == -45.f);
+    REQUIRE(entities.head_yaw(1) == 180.f);
+    REQUIRE(entities.velocity(1).y == 0.5f);
+}
+
+TEST_CASE("entity store interpolation", "[world]") {
+    world::entity_store entities {};
+    entities.add(spawn(1, { 0., 64., 0. }));
+    entities.add(spawn(2, { 8., 64., 8. }));
+
+    entities.tick();
+    entities.move(1, { 1., 0., 0. }, true);
+    entities.teleport(2, { 8., 68., 0. }, false);
+    entities.interpolate(0.25);
+    REQUIRE(entities.render_position(0) == glm::dvec3 { 0.25, 64., 0. });
+    REQUIRE(entities.render_position(1) == glm::dvec3 { 8., 65., 6. });
+    REQUIRE(entities.render_x().size() == 2);
+
+    // a new tick starts from where the last one ended
+    entities.tick();
+    entities.interpolate(0.5);
+    REQUIRE(entities.render_position(0) == glm::dvec3 { 1., 64., 0. });
+    REQUIRE(entities.previous_position(1) == glm::dvec3 { 8., 68., 0. });
+}
+
+// The queries against plain scans, with entities moving between cells and
+// getting removed in between
+TEST_CASE("entity store proximity queries", "[world]") {
+    world::entity_store entities {};
+    std::mt19937 random { 3 };
+    std::uniform_real_distribution<double> coordinate { -100., 100. };
+    std::uniform_real_distribution<double> step { -3., 3. };
+    auto random_position = [&] {
+        return glm::dvec3 { coordinate(random), coordinate(random) * 0.5, coordinate(random) };
+    };
+    for (int32_t id = 0; id < 500; id++) {
+        entities.add(spawn(id, random_position()));
+    }
+
+    auto distance2 = [&](uint32_t slot, glm::dvec3 center) {
+        glm::dvec3 d = entities.position(slot) - center;
+        return glm::dot(d, d);
+    };
+    auto sorted = [](std::vector<uint32_t> slots) {
+        std::sort(slots.begin(), slots.end());
+        return slots;
+    };
+
+    std::vector<uint32_t> found {};
+    for (int round = 0; round < 20; round++) {
+        for (int32_t id = 0; id < 500; id++) {
+            entities.move(id, { step(random), step(random), step(random) }, false);
+        }
+        entities.teleport(round, random_position(), false);
+        entities.remove(round * 7);
+
+        glm::dvec3 center = random_position();
+        double radius = 5. + round * 3.;
+        std::vector<uint32_t> expected {};
+        for (uint32_t slot = 0; slot < entities.size(); slot++) {
+            if (distance2(slot, center) <= radius * radius)
+                expected.push_back(slot);
+        }
+        entities.query_radius(center, radius, found);
+        REQUIRE(sorted(found) == expected);
+
+        world::aabb box { center - glm::dvec3 { radius, 4., radius }, center + glm::dvec3 { radius, 4., radius } };
+        expected.clear();
+        for (uint32_t slot = 0; slot < entities.size(); slot++) {
+            glm::dvec3 p = entities.position(slot);
+            if (p.x >= box.min.x && p.x <= box.max.x && p.y >= box.min.y && p.y <= box.max.y
+                    && p.z >= box.min.z && p.z <= box.max.z)
+                expected.push_back(slot);
+        }
+        entities.query_box(box, found);
+        REQUIRE(sorted(found) == expected);
+
+        size_t k = 1 + round * 4;
+        expected.resize(entities.size());
+        std::iota(expected.begin(), expected.end(), 0);
+        std::sort(expected.begin(), expected.end(), [&](uint32_t a, uint32_t b) {
+            return distance2(a, center) < distance2(b, center);
+        });
+        expected.resize(k);
+        entities.query_nearest(center, k, found);
+        REQUIRE(found == expected);
+
+        // only as far as max_distance
+        entities.query_nearest(center, k, found, 20.);
+        REQUIRE(found.size() <= k);
+        for (uint32_t slot : found) {
+            REQUIRE(distance2(slot, center) <= 400.);
+        }
+    }
+
+    // far away entities are found with few occupied cells
+    world::entity_store sparse {};
+    sparse.add(spawn(1, { 1e6, 0., 1e6 }));
+    sparse.add(spawn(2, { -1e6, 0., 0. }));
+    sparse.query_nearest({}, 5, found);
+    REQUIRE(found == std::vector<uint32_t> { 1, 0 });
+    sparse.query_radius({}, 2e6, found);
+    REQUIRE(found.size() == 2);
+
+    // far above the world the cell still fits the packed key
+    world::entity_grid grid {};
+    glm::dvec3 high { 0., 1e7, 0. };
+    grid.insert(0, high);
+    glm::ivec3 cell = world::entity_grid::cell_of(high);
+    REQUIRE(cell.y == 500000);
+    grid.for_each_cell([&](glm::ivec3 occupied, std::span<const uint32_t> slots) {
+        REQUIRE(occupied == cell);
+        REQUIRE(slots.size() == 1);
+    });
+    sparse.add(spawn(3, high));
+    sparse.query_box({ high - 1., high + 1. }, found);
+    REQUIRE(found == std::vector<uint32_t> { 2 });
+}
@@ -0,0 +1,92 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <span>
+#include <vector>
+
+#include "nbt.hh"
+#include "world/heightmap.hh"
+
+using namespace mccpp;
+
+// 9 bits per column, 7 columns per long, the layout for 384 block high worlds
+static std::vector<int64_t> pack(const std::vector<uint16_t> &heights) {
+    std::vector<int64_t> longs((256 + 6) / 7, 0);
+    for (size_t i = 0; i < 256; i++) {
+        longs[i / 7] |= int64_t(uint64_t(heights[i]) << (i % 7 * 9));
+    }
+    return longs;
+}
+
+TEST_CASE("heightmaps load from chunk NBT", "[world][heightmap]") {
+    std::vector<uint16_t> surface(256);
+    std::vector<uint16_t> blocking(256);
+    for (size_t i = 0; i < 256; i++) {
+        surface[i] = static_cast<uint16_t>(i % 2 == 0 ? 384 : i);
+        blocking[i] = static_cast<uint16_t>(i / 2);
+    }
+
+    proto::packet_writer w {};
+    nbt::writer n { w };
+    n.begin_compound();
+    n.write_long_array("MOTION_BLOCKING", pack(blocking));
+    n.write_long_array("WORLD_SURFACE", pack(surface));
+    n.end_compound();
+    std::span<const std::byte> bytes = w;
+
+    world::column_heightmaps maps {};
+    proto::packet_reader s { bytes };
+    maps.load(s, 384);
+    REQUIRE(s.remaining() == 0);
+    for (int z = 0; z < 16; z++) {
+        for (int x = 0; x < 16; x++) {
+            REQUIRE(maps.world_surface.at(x, z) == surface[z * 16 + x]);
+            REQUIRE(maps.motion_blocking.at(x, z) == blocking[z * 16 + x]);
+        }
+    }
+    REQUIRE(maps.world_surface.max() == 384);
+    REQUIRE(maps.motion_blocking.max() == 127);
+    REQUIRE_FALSE(maps.motion_blocking.is_above(7));
+    REQUIRE(maps.motion_blocking.is_above(8));
+
+    proto::packet_writer bad {};
+    nbt::writer b { bad };
+    b.begin_compound();
+    b.write_long_array("WORLD_SURFACE", std::vector<int64_t>(36));
+    b.end_compound();
+    std::span<const std::byte> bad_bytes = bad;
+    proto::packet_reader r { bad_bytes };
+    REQUIRE_THROWS_AS(maps.load(r, 384), proto::decode_error);
+}
+
+TEST_CASE("heightmap updates", "[world][heightmap]") {
+    std::vector<uint16_t> heights(256, 10);
+    heights[0] = 20;
+    std::vector<int64_t> longs = pack(heights);
+    std::vector<std::byte> bytes {};
+    for (int64_t l : longs) {
+        for (int i = 7; i >= 0; i--) {
+            bytes.emplace_back(std::byte(uint64_t(l) >> (i * 8)));
+        }
+    }
+
+    world::heightmap map {};
+    map.load(bytes, 9);
+    REQUIRE(map.at(0, 0) == 20);
+    REQUIRE(map.max() == 20);
+
+    // blocks below the top don't matter
+    auto never = [](int) -> bool { FAIL("scanned below"); return false; };
+    map.update(1, 3, 0, false, never);
+    REQUIRE(map.at(1, 0) == 10);
+    map.update(1, 30, 0, true, never);
+    REQUIRE(map.at(1, 0) == 31);
+    REQUIRE(map.max() == 31);
+
+    // removing the top scans down to the next block
+    map.update(1, 30, 0, false, [](int y) { return y == 12; });
+    REQUIRE(map.at(1, 0) == 13);
+    REQUIRE(map.max() == 20);
+    map.update(0, 19, 0, false, [](int) { return false; });
+    REQUIRE(map.at(0, 0) == 0);
+    REQUIRE(map.max() == 13);
+}
@@ -0,0 +1,103 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <span>
+#include <vector>
+
+#include "world/light.hh"
+
+using namespace mccpp;
+using world::nibble_array;
+
+static void write_light(proto::packet_writer &w, uint64_t sky_mask, uint64_t empty_sky_mask,
+                        const std::vector<std::array<std::byte, 2048>> &sky) {
+    w.write_varint(1);
+    w.write_u64(sky_mask);
+    w.write_varint(0);
+    w.write_varint(1);
+    w.write_u64(empty_sky_mask);
+    w.write_varint(0);
+    w.write_varint(sky.size());
+    for (const std::array<std::byte, 2048> &array : sky) {
+        w.write_varint(array.size());
+        w.write_bytes(array);
+    }
+    w.write_varint(0);
+}
+
+TEST_CASE("nibble arrays share uniform storage", "[world][light]") {
+    nibble_array a {};
+    REQUIRE(a.is_dark());
+    REQUIRE(a.get(5, 6, 7) == 0);
+
+    // setting the level it already has doesn't allocate
+    a.set(100, 0);
+    REQUIRE(a.is_shared());
+
+    a.set(1, 9);
+    REQUIRE_FALSE(a.is_shared());
+    REQUIRE(a.get(0) == 0);
+    REQUIRE(a.get(1) == 9);
+    REQUIRE(a.get(1, 0, 0) == 9);
+    a.set(0, 4);
+    REQUIRE(a.get(0) == 4);
+    REQUIRE(a.get(1) == 9);
+
+    a.fill(15);
+    REQUIRE(a.is_full());
+    REQUIRE(a.get(4095) == 15);
+    a.fill(7);
+    REQUIRE_FALSE(a.is_shared());
+    REQUIRE(a.get(4095) == 7);
+
+    nibble_array b = nibble_array::full();
+    REQUIRE(b.is_full());
+    REQUIRE(b.data()[0] == std::byte(0xff));
+}
+
+TEST_CASE("column light loads and patches", "[world][light]") {
+    world::column_light light { 2 };
+    REQUIRE(light.count() == 4);
+
+    std::array<std::byte, 2048> dark {};
+    std::array<std::byte, 2048> full {};
+    full.fill(std::byte(0xff));
+    std::array<std::byte, 2048> mixed {};
+    mixed[0] = std::byte(0x5a);
+
+    // sections 0, 1 and 3 have arrays
+    proto::packet_writer w {};
+    write_light(w, 0b1011, 0, { full, mixed, dark });
+    std::span<const std::byte> bytes = w;
+    proto::packet_reader s { bytes };
+    light.load(s);
+    REQUIRE(s.remaining() == 0);
+
+    REQUIRE(light[0].sky.is_full());
+    REQUIRE(light[1].sky.get(0) == 0xa);
+    REQUIRE(light[1].sky.get(1) == 0x5);
+    REQUIRE(light[2].sky.is_dark());
+    REQUIRE(light[3].sky.is_dark());
+    REQUIRE(light[0].block.is_dark());
+    REQUIRE(light.allocated_bytes() == 2048);
+
+    // an update only touches the sections in its masks
+    proto::packet_writer update {};
+    write_light(update, 0b0100, 0b0010, { full });
+    std::span<const std::byte> update_bytes = update;
+    size_t offset = 0;
+    proto::packet_reader callback { [&] { return update_bytes[offset++]; }, update_bytes.size() };
+    light.load(callback);
+    REQUIRE(callback.remaining() == 0);
+
+    REQUIRE(light[0].sky.is_full());
+    REQUIRE(light[1].sky.is_dark());
+    REQUIRE(light[2].sky.is_full());
+    REQUIRE(light.allocated_bytes() == 0);
+
+    proto::packet_writer too_many {};
+    write_light(too_many, 0b0001, 0, { full, full });
+    std::span<const std::byte> too_many_bytes = too_many;
+    proto::packet_reader r { too_many_bytes };
+    REQUIRE_THROWS_AS(light.load(r), proto::decode_error);
+}
@@ -0,0 +1,290 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "world/world.hh"
+
+using namespace mccpp;
+
+static constexpr world::block_state STONE = 1;
+static constexpr world::block_state TORCH = 2;
+static constexpr world::block_state WATER = 3;
+static constexpr world::block_state GLOWSTONE = 4;
+
+// Two block sections starting at y -16, light from y -32 to 31
+static constexpr int32_t MIN_Y = -16;
+
+static void set_properties(world::world &w) {
+    w.light().set_properties(TORCH, { 14, 0 });
+    w.light().set_properties(WATER, { 0, 2 });
+    w.light().set_properties(GLOWSTONE, { 15, 15 });
+}
+
+static world::nibble_array &light_at(world::world &w, int32_t x, int32_t y, int32_t z, bool sky) {
+    world::section_light &light = w.chunks().get(x >> 4, z >> 4).light()[((y - MIN_Y) >> 4) + 1];
+    return sky ? light.sky : light.block;
+}
+
+static uint8_t block_light(world::world &w, int32_t x, int32_t y, int32_t z) {
+    return light_at(w, x, y, z, false).get(x & 15, y & 15, z & 15);
+}
+
+static uint8_t sky_light(world::world &w, int32_t x, int32_t y, int32_t z) {
+    return light_at(w, x, y, z, true).get(x & 15, y & 15, z & 15);
+}
+
+static void drain(world::world &w) {
+    while (w.light().pending() > 0) {
+        w.update_light(100);
+    }
+}
+
+TEST_CASE("block light spreads and goes away", "[world][light]") {
+    world::world w { MIN_Y, 32, {} };
+    set_properties(w);
+    w.chunks().get(0, 0);
+    w.chunks().get(1, 0);
+    w.take_dirty_sections();
+
+    REQUIRE(w.set_block(12, 4, 8, TORCH));
+    // the block itself is lit right away
+    REQUIRE(block_light(w, 12, 4, 8) == 14);
+    REQUIRE(w.light().pending() > 0);
+    w.update_light();
+    REQUIRE(w.light().pending() == 0);
+    REQUIRE(block_light(w, 13, 4, 8) == 13);
+    REQUIRE(block_light(w, 12, 10, 8) == 8);
+    // into the next column, down into the section below the world and not
+    // into a missing column
+    REQUIRE(block_light(w, 20, 4, 8) == 6);
+    REQUIRE(block_light(w, 12, -17, 8) == 0);
+    REQUIRE(block_light(w, 12, -16, 8) == 0);
+    REQUIRE(block_light(w, 12, -10, 8) == 0);
+    REQUIRE(block_light(w, 12, -3, 8) == 7);
+    REQUIRE(block_light(w, 12, 4, 0) == 6);
+
+    std::vector<glm::ivec3> dirty = w.take_dirty_sections();
+    REQUIRE(std::find(dirty.begin(), dirty.end(), glm::ivec3 { 1, 0, 0 }) != dirty.end());
+    REQUIRE(std::find(dirty.begin(), dirty.end(), glm::ivec3 { 0, -1, 0 }) != dirty.end());
+
+    // stone stops it, water takes two levels
+    REQUIRE(w.set_block(13, 4, 8, STONE));
+    REQUIRE(w.set_block(11, 4, 8, WATER));
+    drain(w);
+    REQUIRE(block_light(w, 13, 4, 8) == 0);
+    REQUIRE(block_light(w, 11, 4, 8) == 12);
+    REQUIRE(block_light(w, 10, 4, 8) == 11);
+    // around the stone
+    REQUIRE(block_light(w, 14, 4, 8) == 10);
+
+    // a second torch keeps its own light when the first goes
+    REQUIRE(w.set_block(4, 4, 8, TORCH));
+    drain(w);
+    REQUIRE(block_light(w, 8, 4, 8) == 10);
+    REQUIRE(w.set_block(12, 4, 8, world::AIR));
+    drain(w);
+    REQUIRE(block_light(w, 8, 4, 8) == 10);
+    // through the water
+    REQUIRE(block_light(w, 12, 4, 8) == 5);
+    REQUIRE(block_light(w, 20, 4, 8) == 0);
+
+    // blocks that don't change light queue nothing
+    REQUIRE(w.set_block(13, 4, 8, 9));
+    REQUIRE(w.light().pending() == 0);
+}
+
+TEST_CASE("sky light comes down and spreads under blocks", "[world][light]") {
+    world::world w { MIN_Y, 32, {} };
+    set_properties(w);
+    world::chunk_column &column = w.chunks().get(0, 0);
+    for (size_t i = 0; i < column.light().count(); i++) {
+        column.light()[i].sky.fill(15);
+    }
+
+    REQUIRE(w.set_block(8, 10, 8, STONE));
+    drain(w);
+    REQUIRE(sky_light(w, 8, 10, 8) == 0);
+    REQUIRE(sky_light(w, 8, 11, 8) == 15);
+    REQUIRE(sky_light(w, 8, 9, 8) == 14);
+    REQUIRE(sky_light(w, 8, -30, 8) == 14);
+    REQUIRE(sky_light(w, 7, 9, 8) == 15);
+
+    // a roof over the whole column, only what's left of the light below
+    for (int32_t z = 0; z < 16; z++) {
+        for (int32_t x = 0; x < 16; x++) {
+            w.set_block(x, 0, z, STONE);
+        }
+    }
+    drain(w);
+    REQUIRE(sky_light(w, 7, 1, 8) == 15);
+    REQUIRE(sky_light(w, 8, 1, 8) == 14);
+    REQUIRE(sky_light(w, 8, -1, 8) == 0);
+    REQUIRE(sky_light(w, 0, -30, 15) == 0);
+    // and a hole in it
+    w.set_block(3, 0, 3, world::AIR);
+    drain(w);
+    REQUIRE(sky_light(w, 3, -30, 3) == 15);
+    REQUIRE(sky_light(w, 4, -30, 3) == 14);
+    REQUIRE(sky_light(w, 10, -5, 3) == 8);
+    // the light above the world is never taken away and stays shared
+    REQUIRE(column.light()[column.light().count() - 1].sky.is_full());
+}
+
+TEST_CASE("light work is bounded by the budget", "[world][light]") {
+    world::world w { MIN_Y, 32, {} };
+    set_properties(w);
+    w.chunks().get(0, 0);
+    REQUIRE(w.set_block(8, 0, 8, GLOWSTONE));
+    REQUIRE(w.update_light(10) == 10);
+    REQUIRE(w.light().pending() > 0);
+    REQUIRE(block_light(w, 8, 0, 8) == 15);
+    size_t steps = 10;
+    while (size_t done = w.update_light(10)) {
+        REQUIRE(done <= 10);
+        steps += done;
+    }
+    REQUIRE(steps > 1000);
+    REQUIRE(block_light(w, 8, 0, 10) == 13);
+    REQUIRE(block_light(w, 0, 15, 15) == 0);
+    REQUIRE(block_light(w, 2, 3, 8) == 6);
+}
+
+TEST_CASE("light is left to the server without block properties", "[world][light]") {
+    world::world w { MIN_Y, 32, {} };
+    w.chunks().get(0, 0);
+    REQUIRE_FALSE(w.light().enabled());
+    REQUIRE(w.set_block(8, 0, 8, GLOWSTONE));
+    REQUIRE(w.set_blocks({ 0, 0, 0 }, std::vector<int64_t> { int64_t(TORCH) << 12 | 1 << 8 | 1 << 4 | 1 }) == 1);
+    REQUIRE(w.light().pending() == 0);
+    REQUIRE(block_light(w, 8, 0, 8) == 0);
+}
+
+TEST_CASE("light from the server replaces queued work", "[world][light]") {
+    world::world w { MIN_Y, 32, {} };
+    set_properties(w);
+    w.chunks().get(0, 0);
+    w.chunks().get(1, 0);
+    REQUIRE(w.set_block(15, 0, 8, GLOWSTONE));
+    REQUIRE(w.set_block(16, 0, 8, GLOWSTONE));
+    size_t pending = w.light().pending();
+    REQUIRE(pending >= 4);
+
+    // the column at 0, 0 got new light, only the other one is left
+    w.on_light_loaded(0, 0);
+    REQUIRE(w.light().pending() > 0);
+    REQUIRE(w.light().pending() < pending);
+    drain(w);
+    REQUIRE(block_light(w, 17, 0, 8) == 14);
+    // work spreading out of the other column still goes into it
+    REQUIRE(block_light(w, 14, 0, 8) == 14);
+    REQUIRE(block_light(w, 15, 0, 8) == 15);
+
+    // and nothing is left of columns that go away
+    REQUIRE(w.set_block(20, 0, 8, TORCH));
+    REQUIRE(w.light().pending() > 0);
+    w.unload_column(1, 0);
+    REQUIRE(w.light().pending() == 0);
+}
+
+// Light of every block worked out from scratch over the columns -1 to 0,
+// index ((y * 32 + z) * 32 + x) from the bottom of the section below the
+// world
+static std::vector<uint8_t> expected_light(world::world &w, bool sky) {
+    constexpr int HEIGHT = 64;
+    std::vector<uint8_t> levels(32 * 32 * HEIGHT);
+    std::vector<world::light_properties> properties(levels.size());
+    auto index = [](int x, int y, int z) {
+        return static_cast<size_t>((y * 32 + z) * 32 + x);
+    };
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int z = 0; z < 32; z++) {
+            for (int x = 0; x < 32; x++) {
+                world::light_properties p = w.light().properties(w.block_state_at(x - 16, y + MIN_Y - 16, z - 16));
+                properties[index(x, y, z)] = p;
+                levels[index(x, y, z)] = sky ? (y == HEIGHT - 1 ? 15 : 0) : p.emission;
+            }
+        }
+    }
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (int y = HEIGHT - 1; y >= 0; y--) {
+            for (int z = 0; z < 32; z++) {
+                for (int x = 0; x < 32; x++) {
+                    uint8_t &level = levels[index(x, y, z)];
+                    int opacity = properties[index(x, y, z)].opacity;
+                    const int from[6][3] = {
+                        { x - 1, y, z }, { x + 1, y, z }, { x, y - 1, z }, { x, y + 1, z }, { x, y, z - 1 }, { x, y, z + 1 },
+                    };
+                    for (const int (&f)[3] : from) {
+                        if (f[0] < 0 || f[0] >= 32 || f[1] < 0 || f[1] >= HEIGHT || f[2] < 0 || f[2] >= 32)
+                            continue;
+                        int source = levels[index(f[0], f[1], f[2])];
+                        bool straight_down = sky && source == 15 && f[1] > y && opacity == 0;
+                        int candidate = source - (straight_down ? 0 : std::max(opacity, 1));
+                        if (candidate > level) {
+                            level = static_cast<uint8_t>(candidate);
+                            changed = true;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return levels;
+}
+
+static void require_expected_light(world::world &w) {
+    for (bool sky : { false, true }) {
+        std::vector<uint8_t> expected = expected_light(w, sky);
+        size_t wrong = 0;
+        for (int y = 0; y < 64; y++) {
+            for (int z = 0; z < 32; z++) {
+                for (int x = 0; x < 32; x++) {
+                    int32_t wy = y + MIN_Y - 16;
+                    uint8_t actual = sky ? sky_light(w, x - 16, wy, z - 16) : block_light(w, x - 16, wy, z - 16);
+                    wrong += actual != expected[static_cast<size_t>((y * 32 + z) * 32 + x)];
+                }
+            }
+        }
+        REQUIRE(wrong == 0);
+    }
+}
+
+TEST_CASE("incremental light matches light from scratch", "[world][light]") {
+    world::world w { MIN_Y, 32, {} };
+    set_properties(w);
+    for (int32_t cz = -1; cz <= 0; cz++) {
+        for (int32_t cx = -1; cx <= 0; cx++) {
+            w.chunks().get(cx, cz);
+        }
+    }
+    // start from the sky light the server would have sent
+    std::vector<uint8_t> sky = expected_light(w, true);
+    for (int y = 0; y < 64; y++) {
+        for (int z = 0; z < 32; z++) {
+            for (int x = 0; x < 32; x++) {
+                light_at(w, x - 16, y + MIN_Y - 16, z - 16, true)
+                    .set(static_cast<size_t>(((y & 15) * 16 + (z & 15)) * 16 + (x & 15)), sky[static_cast<size_t>((y * 32 + z) * 32 + x)]);
+            }
+        }
+    }
+
+    std::mt19937 rng { 1234 };
+    std::uniform_int_distribution<int32_t> horizontal { -16, 15 };
+    std::uniform_int_distribution<int32_t> vertical { MIN_Y, MIN_Y + 31 };
+    const world::block_state states[] = {
+        world::AIR, world::AIR, STONE, STONE, STONE, STONE, TORCH, WATER, GLOWSTONE,
+    };
+    std::uniform_int_distribution<size_t> pick { 0, std::size(states) - 1 };
+    for (int round = 0; round < 8; round++) {
+        for (int i = 0; i < 60; i++) {
+            w.set_block(horizontal(rng), vertical(rng), horizontal(rng), states[pick(rng)]);
+            // some work left over from the last edits
+            w.update_light(50);
+        }
+        drain(w);
+        require_expected_light(w);
+    }
+}
@@ -0,0 +1,122 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "world/raycast.hh"
+#include "world/world.hh"
+
+using namespace mccpp;
+
+// Plain voxel by voxel walk to compare against
+static std::optional<world::ray_hit> reference(world::world &w, const world::ray &r) {
+    glm::dvec3 dir = glm::normalize(r.direction);
+    glm::ivec3 voxel { glm::floor(r.origin) };
+    glm::ivec3 step {};
+    glm::dvec3 t_delta { INFINITY };
+    glm::dvec3 t_max { INFINITY };
+    for (int a = 0; a < 3; a++) {
+        if (dir[a] != 0.) {
+            step[a] = dir[a] > 0. ? 1 : -1;
+            t_delta[a] = std::abs(1. / dir[a]);
+            t_max[a] = (dir[a] > 0. ? voxel[a] + 1 - r.origin[a] : r.origin[a] - voxel[a]) * t_delta[a];
+        }
+    }
+    double t = 0.;
+    glm::ivec3 face {};
+    while (t <= r.max_distance) {
+        world::block_state state = w.block_state_at(voxel.x, voxel.y, voxel.z);
+        if (state != world::AIR)
+            return world::ray_hit { voxel, face, t, state };
+        int a = t_max.x < t_max.y ? (t_max.x < t_max.z ? 0 : 2) : (t_max.y < t_max.z ? 1 : 2);
+        t = t_max[a];
+        voxel[a] += step[a];
+        t_max[a] += t_delta[a];
+        face = {};
+        face[a] = -step[a];
+    }
+    return std::nullopt;
+}
+
+static world::world test_world() {
+    world::world w { -32, 64, {} };
+    for (int32_t x = -2; x <= 2; x++) {
+        for (int32_t z = -2; z <= 2; z++) {
+            if (x != 1 || z != 1)
+                w.chunks().get(x, z);
+        }
+    }
+    return w;
+}
+
+TEST_CASE("raycast hits and faces", "[world][raycast]") {
+    world::world w = test_world();
+    REQUIRE(w.set_block(5, 10, 5, 3));
+
+    auto hit = world::raycast(w, { { 5.5, 20.5, 5.5 }, { 0, -1, 0 }, 100 });
+    REQUIRE(hit);
+    REQUIRE(hit->block == glm::ivec3 { 5, 10, 5 });
+    REQUIRE(hit->face == glm::ivec3 { 0, 1, 0 });
+    REQUIRE(std::abs(hit->distance - 9.5) < 1e-9);
+    REQUIRE(hit->state == 3);
+
+    hit = world::raycast(w, { { -20.5, 10.5, 5.5 }, { 1, 0, 0 }, 100 });
+    REQUIRE(hit);
+    REQUIRE(hit->face == glm::ivec3 { -1, 0, 0 });
+    REQUIRE(std::abs(hit->distance - 25.5) < 1e-9);
+
+    // too short, inside the block, leaving the world
+    REQUIRE_FALSE(world::raycast(w, { { 5.5, 20.5, 5.5 }, { 0, -1, 0 }, 9 }));
+    hit = world::raycast(w, { { 5.5, 10.5, 5.5 }, { 1, 1, 1 }, 10 });
+    REQUIRE(hit);
+    REQUIRE(hit->face == glm::ivec3 {});
+    REQUIRE(hit->distance == 0.);
+    REQUIRE_FALSE(world::raycast(w, { { 5.5, 20.5, 5.5 }, { 0, 1, 0 }, 1e6 }));
+    REQUIRE_FALSE(world::raycast(w, { { 5.5, 20.5, 5.5 }, { 0, 0, 0 }, 10 }));
+    REQUIRE_FALSE(world::raycast(w, { { 5.5, 20.5, 5.5 }, { 1, 0, 0 }, INFINITY }));
+}
+
+TEST_CASE("raycast matches a voxel walk", "[world][raycast]") {
+    world::world w = test_world();
+    std::mt19937 random { 7 };
+    std::uniform_int_distribution<int32_t> xz { -40, 47 };
+    std::uniform_int_distribution<int32_t> y { -32, 31 };
+    // sparse blocks so that most sections are empty or nearly so
+    for (int i = 0; i < 3000; i++) {
+        w.set_block(xz(random), y(random), xz(random), 1);
+    }
+    for (int32_t x = -40; x < 40; x++) {
+        w.set_block(x, -32, 3, 2);
+    }
+
+    std::uniform_real_distribution<double> position { -40., 48. };
+    std::uniform_real_distribution<double> height { -40., 40. };
+    std::normal_distribution<double> direction {};
+    std::vector<world::ray> rays {};
+    for (int i = 0; i < 2000; i++) {
+        glm::dvec3 d { direction(random), direction(random), direction(random) };
+        // some rays along the axes and the grid lines
+        if (i % 10 == 0)
+            d[i % 3] = 0.;
+        glm::dvec3 origin { position(random), height(random), position(random) };
+        if (i % 7 == 0)
+            origin = glm::floor(origin);
+        rays.push_back({ origin, d, 120. });
+    }
+
+    std::vector<std::optional<world::ray_hit>> hits(rays.size());
+    world::raycast(w, rays, hits);
+    size_t hit_count = 0;
+    for (size_t i = 0; i < rays.size(); i++) {
+        std::optional<world::ray_hit> expected = reference(w, rays[i]);
+        REQUIRE(hits[i].has_value() == expected.has_value());
+        if (!expected)
+            continue;
+        hit_count++;
+        REQUIRE(hits[i]->block == expected->block);
+        REQUIRE(hits[i]->face == expected->face);
+        REQUIRE(std::abs(hits[i]->distance - expected->distance) < 1e-9);
+    }
+    REQUIRE(hit_count > 100);
+}
@@ -0,0 +1,267 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <span>
+#include <vector>
+
+#include "nbt.hh"
+#include "world/world.hh"
+
+using namespace mccpp;
+
+// A column of stone up to y = 3 in a 32 block high world starting at -16,
+// the first section is a single value container, the second a paletted one
+static std::vector<std::byte> column() {
+    proto::packet_writer w {};
+    w.write_i16(4096);
+    w.write_u8(0);
+    w.write_varint(1);
+    w.write_varint(0);
+    w.write_u8(0);
+    w.write_varint(0);
+    w.write_varint(0);
+
+    w.write_i16(4 * 256);
+    w.write_u8(4);
+    w.write_varint(2);
+    w.write_varint(0);
+    w.write_varint(1);
+    w.write_varint(256);
+    for (size_t i = 0; i < 256; i++) {
+        // 16 entries per long, y is the outermost index so y < 4 are the first 64 longs
+        w.write_u64(i < 64 ? 0x1111111111111111 : 0);
+    }
+    w.write_u8(0);
+    w.write_varint(0);
+    w.write_varint(0);
+    std::span<const std::byte> bytes = w;
+    return { bytes.begin(), bytes.end() };
+}
+
+static world::world loaded_world() {
+    world::world w { -16, 32, {} };
+    std::vector<std::byte> bytes = column();
+    for (int32_t x = 0; x < 2; x++) {
+        proto::packet_reader s { bytes };
+        world::chunk_column &c = w.chunks().get(x, 0);
+        for (world::chunk &chunk : c) {
+            chunk.load(s);
+        }
+        REQUIRE(s.remaining() == 0);
+        w.on_column_loaded(x, 0);
+    }
+    return w;
+}
+
+static bool contains(const std::vector<glm::ivec3> &sections, glm::ivec3 s) {
+    return std::find(sections.begin(), sections.end(), s) != sections.end();
+}
+
+TEST_CASE("world block states", "[world]") {
+    world::world w = loaded_world();
+    REQUIRE(w.dirty_section_count() == 4);
+    w.take_dirty_sections();
+
+    REQUIRE(w.block_state_at(0, -16, 0) == 1);
+    REQUIRE(w.block_state_at(5, 3, 7) == 1);
+    REQUIRE(w.block_state_at(5, 4, 7) == world::AIR);
+    REQUIRE(w.block_state_at(5, 100, 7) == world::AIR);
+    REQUIRE(w.block_state_at(-1, 0, 0) == world::AIR);
+    REQUIRE(w.chunks().get(0, 0)[1].is_air_at(5, 4, 7));
+    REQUIRE_FALSE(w.chunks().get(0, 0)[1].is_air_at(5, 3, 7));
+
+    // setting the same state is no change
+    REQUIRE_FALSE(w.set_block(5, 3, 7, 1));
+    REQUIRE(w.dirty_section_count() == 0);
+    REQUIRE_FALSE(w.set_block(-1, 3, 7, 1));
+
+    // inside a section only that section needs a new mesh
+    REQUIRE(w.set_block(5, 8, 7, 2));
+    REQUIRE(w.block_state_at(5, 8, 7) == 2);
+    REQUIRE(w.highest_block(5, 7) == 8);
+    std::vector<glm::ivec3> dirty = w.take_dirty_sections();
+    REQUIRE(dirty == std::vector<glm::ivec3> { { 0, 0, 0 } });
+
+    // on the border to the next column and the section below
+    REQUIRE(w.set_block(15, 0, 3, world::AIR));
+    dirty = w.take_dirty_sections();
+    REQUIRE(dirty.size() == 3);
+    REQUIRE(contains(dirty, { 0, 0, 0 }));
+    REQUIRE(contains(dirty, { 1, 0, 0 }));
+    REQUIRE(contains(dirty, { 0, -1, 0 }));
+
+    // the neighbour at -z isn't loaded
+    REQUIRE(w.set_block(3, 0, 0, world::AIR));
+    dirty = w.take_dirty_sections();
+    REQUIRE(dirty.size() == 2);
+
+    // removing the top block lowers the heightmap
+    REQUIRE(w.set_block(5, 8, 7, world::AIR));
+    REQUIRE(w.highest_block(5, 7) == 3);
+    REQUIRE_FALSE(w.is_above_surface(0, 0, 0));
+    REQUIRE(w.set_blocks({ 0, 0, 0 }, std::vector<int64_t> { 0 << 12 | 5 << 8 | 7 << 4 | 3 }) == 1);
+    REQUIRE(w.highest_block(5, 7) == 2);
+    w.take_dirty_sections();
+}
+
+TEST_CASE("world loading a column remeshes its neighbours", "[world]") {
+    world::world w = loaded_world();
+    w.chunks().get(5, 5);
+    w.take_dirty_sections();
+
+    // only the neighbour at -z is loaded, the column at 5, 5 is further away
+    w.chunks().get(0, 1);
+    w.on_column_loaded(0, 1);
+    std::vector<glm::ivec3> dirty = w.take_dirty_sections();
+    REQUIRE(dirty.size() == 4);
+    REQUIRE(contains(dirty, { 0, -1, 1 }));
+    REQUIRE(contains(dirty, { 0, 0, 1 }));
+    REQUIRE(contains(dirty, { 0, -1, 0 }));
+    REQUIRE(contains(dirty, { 0, 0, 0 }));
+
+    w.chunks().get(1, 1);
+    w.on_column_loaded(1, 1);
+    // and now the ones at -x and -z
+    dirty = w.take_dirty_sections();
+    REQUIRE(dirty.size() == 6);
+    REQUIRE(contains(dirty, { 0, 0, 1 }));
+    REQUIRE(contains(dirty, { 1, 0, 0 }));
+    REQUIRE_FALSE(contains(dirty, { 0, 0, 0 }));
+}
+
+TEST_CASE("world batched section updates", "[world]") {
+    world::world w = loaded_world();
+    w.take_dirty_sections();
+
+    std::vector<int64_t> entries {};
+    auto entry = [](int64_t state, int x, int y, int z) {
+        return state << 12 | x << 8 | z << 4 | y;
+    };
+    entries.emplace_back(entry(7, 1, 9, 1));
+    entries.emplace_back(entry(7, 2, 9, 1));
+    entries.emplace_back(entry(1, 2, 0, 2));
+    entries.emplace_back(entry(0, 15, 5, 15));
+
+    REQUIRE(w.set_blocks({ 1, 0, 0 }, entries) == 2);
+    REQUIRE(w.block_state_at(17, 9, 1) == 7);
+    REQUIRE(w.block_state_at(18, 9, 1) == 7);
+    std::vector<glm::ivec3> dirty = w.take_dirty_sections();
+    REQUIRE(dirty == std::vector<glm::ivec3> { { 1, 0, 0 } });
+
+    REQUIRE(w.set_blocks({ 5, 0, 0 }, entries) == 0);
+
+    w.unload_column(1, 0);
+    REQUIRE(w.chunks().try_get(1, 0) == nullptr);
+    REQUIRE(w.block_state_at(17, 9, 1) == world::AIR);
+    REQUIRE(w.set_block(15, 5, 5, 3));
+    REQUIRE(w.take_dirty_sections() == std::vector<glm::ivec3> { { 0, 0, 0 } });
+}
+
+TEST_CASE("world block entities go with their block", "[world]") {
+    world::world w = loaded_world();
+    proto::packet_writer compound {};
+    nbt::writer n { compound };
+    n.begin_compound();
+    n.end_compound();
+    std::span<const std::byte> bytes = compound;
+    world::column_block_entities &entities = w.chunks().get(0, 0).block_entities();
+    for (int y : { 2, 3 }) {
+        proto::packet_reader s { bytes };
+        entities.set(5, y, 7, 1, s);
+    }
+
+    // changed to another block it may keep it, vanilla decides by block
+    REQUIRE(w.set_block(5, 3, 7, 2));
+    REQUIRE(entities.size() == 2);
+    REQUIRE(w.set_block(5, 3, 7, world::AIR));
+    REQUIRE(entities.size() == 1);
+    REQUIRE(w.set_blocks({ 0, 0, 0 }, std::vector<int64_t> { 0 << 12 | 5 << 8 | 7 << 4 | 2 }) == 1);
+    REQUIRE(entities.empty());
+}
+
+TEST_CASE("chunk manager grid and overflow", "[world]") {
+    world::chunk_manager chunks { 1, 2 };
+    REQUIRE(chunks.grid_width() == 16);
+
+    // everything in range gets its own slot
+    std::vector<world::chunk_column *> columns {};
+    for (int32_t x = -5; x <= 5; x++) {
+        for (int32_t z = -5; z <= 5; z++) {
+            columns.emplace_back(&chunks.get(x, z));
+        }
+    }
+    REQUIRE(chunks.size() == 121);
+    REQUIRE(chunks.overflow_size() == 0);
+    REQUIRE(chunks.try_get(0, 6) == nullptr);
+
+    // a column far away shares a slot with (0, 0) and (16, 0) with it
+    world::chunk_column *far = &chunks.get(16, 0);
+    REQUIRE(chunks.overflow_size() == 1);
+    REQUIRE(chunks.try_get(16, 0) == far);
+    REQUIRE(chunks.try_get(0, 0) == columns[60]);
+    REQUIRE(chunks.try_get(-16, 0) == nullptr);
+
+    // moving the center swaps the closer one into the slot, pointers stay
+    chunks.set_center(14, 0);
+    REQUIRE(chunks.overflow_size() == 1);
+    REQUIRE(chunks.try_get(16, 0) == far);
+    REQUIRE(chunks.try_get(0, 0) == columns[60]);
+
+    chunks.unload(0, 0);
+    REQUIRE(chunks.try_get(0, 0) == nullptr);
+    REQUIRE(chunks.overflow_size() == 0);
+    chunks.unload(0, 0);
+    REQUIRE(chunks.size() == 121);
+
+    chunks.set_view_distance(10);
+    REQUIRE(chunks.grid_width() == 32);
+    REQUIRE(chunks.size() == 121);
+    REQUIRE(chunks.overflow_size() == 0);
+    REQUIRE(chunks.try_get(16, 0) == far);
+    REQUIRE(chunks.try_get(5, -5) == columns[110]);
+}
+
+TEST_CASE("chunk manager eviction", "[world]") {
+    world::chunk_manager chunks { 1, 2 };
+    size_t column_bytes = chunks.get(0, 0).memory_usage();
+    for (int32_t x = -5; x <= 5; x++) {
+        for (int32_t z = -5; z <= 5; z++) {
+            chunks.get(x, z);
+        }
+    }
+
+    // without a budget only columns past the grid radius go
+    std::vector<glm::ivec2> evicted {};
+    chunks.evict(evicted);
+    REQUIRE(evicted.empty());
+    REQUIRE(chunks.stats().bytes == 121 * column_bytes);
+    chunks.set_center(1, 0);
+    chunks.evict(evicted);
+    REQUIRE(evicted.size() == 11);
+    REQUIRE(evicted.front().x == -5);
+    REQUIRE(chunks.stats().evicted == 11);
+
+    // at the same distance the least recently used go first
+    chunks.get(5, 5);
+    chunks.set_memory_budget(chunks.stats().bytes - column_bytes * 3);
+    REQUIRE(chunks.over_budget());
+    evicted.clear();
+    chunks.evict(evicted);
+    REQUIRE(evicted.size() == 3);
+    for (glm::ivec2 c : evicted) {
+        REQUIRE(std::max(std::abs(c.x - 1), std::abs(c.y)) == 5);
+    }
+    REQUIRE(chunks.try_get(5, 5));
+    REQUIRE(chunks.stats().bytes <= chunks.stats().budget);
+
+    // the center and its neighbours stay no matter what
+    chunks.set_memory_budget(1);
+    chunks.evict(evicted);
+    REQUIRE(chunks.size() == 25);
+    REQUIRE(chunks.try_get(3, 2));
+    REQUIRE(chunks.stats().evicted == 121 - 25);
+
+    chunks.unload(1, 0);
+    REQUIRE(chunks.stats().forgotten == 1);
+}